@@ -0,0 +1,158 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Replays the cache traces recorded with --cache-trace-dir against other
+// cache policies and memory budgets, without a GPU or a data source.
+
+#include <livre/core/cache/CacheSimulator.h>
+#include <livre/core/cache/CacheTrace.h>
+
+#include <lunchbox/types.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h>
+
+namespace po = boost::program_options;
+
+namespace
+{
+std::vector< std::string > split( const std::string& list )
+{
+    std::vector< std::string > values;
+    boost::split( values, list, boost::is_any_of( "," ), boost::token_compress_on );
+    return values;
+}
+
+void printRow( const std::string& policy, const std::string& budget,
+               const size_t accesses, const float hitRatio,
+               const size_t loadedBytes, const std::string& evictions )
+{
+    std::cout << std::setw( 10 ) << policy << std::setw( 12 ) << budget
+              << std::setw( 12 ) << accesses
+              << std::setw( 10 ) << std::fixed << std::setprecision( 1 )
+              << 100.f * hitRatio
+              << std::setw( 14 ) << ( loadedBytes + LB_1MB - 1 ) / LB_1MB
+              << std::setw( 12 ) << evictions << std::endl;
+}
+
+void replay( const std::string& filename,
+             const std::vector< livre::CachePolicyType >& policyTypes,
+             const std::vector< size_t >& budgets )
+{
+    const livre::CacheAccesses accesses = livre::CacheTrace::read( filename );
+
+    // The recorded accesses, for comparison with the replays
+    size_t hits = 0;
+    size_t loadedBytes = 0;
+    for( const livre::CacheAccess& access: accesses )
+    {
+        if( access.hit )
+            ++hits;
+        else
+            loadedBytes += access.size;
+    }
+
+    std::cout << filename << std::endl;
+    std::cout << std::setw( 10 ) << "Policy" << std::setw( 12 ) << "Budget (MB)"
+              << std::setw( 12 ) << "Accesses" << std::setw( 10 ) << "Hits (%)"
+              << std::setw( 14 ) << "Loaded (MB)" << std::setw( 12 ) << "Evictions"
+              << std::endl;
+    printRow( "recorded", "-", accesses.size(),
+              accesses.empty() ? 0.f : float( hits ) / float( accesses.size( )),
+              loadedBytes, "-" );
+
+    for( const livre::CachePolicyType policyType: policyTypes )
+    {
+        for( const size_t budget: budgets )
+        {
+            const livre::CacheSimulation simulation =
+                livre::simulateCache( accesses, policyType, budget * LB_1MB );
+            printRow( livre::getCachePolicyName( policyType ), std::to_string( budget ),
+                      accesses.size(), simulation.getHitRatio(), simulation.loadedBytes,
+                      std::to_string( simulation.evictions ));
+        }
+    }
+    std::cout << std::endl;
+}
+}
+
+int main( const int argc, char** argv )
+{
+    po::options_description options( "Usage: livreCacheReplay [options] trace..." );
+    options.add_options()
+        ( "help", "Show this help" )
+        ( "policies", po::value< std::string >()->default_value( "lru,lfu,2q,visible" ),
+          "Cache policies to replay the traces with" )
+        ( "budgets", po::value< std::string >()->default_value( "1024,4096,8192" ),
+          "Maximum cache memories (MB) to replay the traces with" )
+        ( "traces", po::value< std::vector< std::string >>(),
+          "Cache traces recorded with --cache-trace-dir" );
+
+    po::positional_options_description positional;
+    positional.add( "traces", -1 );
+
+    po::variables_map variables;
+    try
+    {
+        po::store( po::command_line_parser( argc, argv ).options( options )
+                       .positional( positional ).run(), variables );
+        po::notify( variables );
+    }
+    catch( const po::error& error )
+    {
+        std::cerr << error.what() << std::endl << options << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if( variables.count( "help" ) || !variables.count( "traces" ))
+    {
+        std::cout << options << std::endl;
+        return variables.count( "help" ) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::vector< livre::CachePolicyType > policyTypes;
+        for( const std::string& policy: split( variables[ "policies" ].as< std::string >( )))
+            policyTypes.push_back( livre::getCachePolicyType( policy ));
+        std::vector< size_t > budgets;
+        for( const std::string& budget: split( variables[ "budgets" ].as< std::string >( )))
+            budgets.push_back( boost::lexical_cast< size_t >( budget ));
+
+        for( const std::string& filename: variables[ "traces" ].as< std::vector< std::string >>( ))
+            replay( filename, policyTypes, budgets );
+    }
+    catch( const boost::bad_lexical_cast& )
+    {
+        std::cerr << "Invalid budgets: " << variables[ "budgets" ].as< std::string >()
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch( const std::runtime_error& error )
+    {
+        std::cerr << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -123,8 +123,8 @@ struct RawDataSource::Impl
     MemoryUnitPtr getData( const LODNode& node )
     {
         const size_t dataSize = node.getBlockSize().product();
-        MemoryUnitPtr memUnitPtr( new ConstMemoryUnit( (const uint8_t*)_mmapPtr + _headerSize,
-                                                       dataSize ));
+        MemoryUnitPtr memUnitPtr( new MappedMemoryUnit( (const uint8_t*)_mmapPtr + _headerSize,
+                                                        dataSize ));
         return memUnitPtr;
     }
 
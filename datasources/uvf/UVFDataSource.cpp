@@ -268,7 +268,7 @@ public:
                      (const unsigned char*)_tuvokLargeMMapFilePtr->rd(
                                                         offset, length ).get( );
 
-             memUnitPtr.reset( new ConstMemoryUnit( dataPtr, blockInfo.m_iLength ));
+             memUnitPtr.reset( new MappedMemoryUnit( dataPtr, blockInfo.m_iLength ));
         }
         else
         {
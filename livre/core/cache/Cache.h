@@ -23,8 +23,16 @@
 #include <livre/core/api.h>
 #include <livre/core/types.h>
 #include <livre/core/cache/CacheObject.h>
+#include <livre/core/cache/CachePolicy.h>
+#include <livre/core/cache/CacheSnapshot.h>
 #include <livre/core/cache/CacheStatistics.h>
-#include <deque>
+#include <livre/core/cache/CacheTrace.h>
+#include <livre/core/pipeline/FuturePromise.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <unordered_set>
 
 #include <lunchbox/debug.h>
 
@@ -32,8 +40,13 @@ namespace livre
 {
 
 /**
- * The Cache class manages the \see CacheObjects according to LRU Policy, methods
- * are thread safe inserting/querying nodes. The type safety check is done in runtime.
+ * The Cache class manages the \see CacheObjects according to a \see CachePolicy
+ * ( LRU by default ), methods are thread safe inserting/querying nodes. The type
+ * safety check is done in runtime.
+ *
+ * The cache can be split into independently locked shards, so threads loading
+ * different objects do not serialize on a single lock. The maximum memory is
+ * shared by all the shards.
  */
 template< class CacheObjectT >
 class Cache
@@ -44,8 +57,11 @@ public:
      * Constructor
      * @param name is the name of the cache.
      * @param maxMemBytes maximum memory.
+     * @param nShards number of independently locked shards.
+     * @param policyType the eviction policy.
      */
-    LIVRECORE_API Cache( const std::string& name, size_t maxMemBytes );
+    LIVRECORE_API Cache( const std::string& name, size_t maxMemBytes, size_t nShards = 1,
+                         CachePolicyType policyType = CP_LRU );
     LIVRECORE_API ~Cache();
 
     /**
@@ -56,14 +72,34 @@ public:
      */
     LIVRECORE_API std::shared_ptr< const CacheObjectT > get( const CacheId& cacheId ) const;
 
+    /**
+     * Gets the cached object like \see get, without counting a hit or a miss,
+     * i.e. for the lookups of the objects built from the cached ones.
+     * @param cacheId The object cache id to be queried.
+     * @return The cache object from cache, or empty if it is not loaded.
+     */
+    LIVRECORE_API std::shared_ptr< const CacheObjectT > peek( const CacheId& cacheId ) const;
+
     /**
      * Unloads the object from the memory, if there are not any references. The
-     * objects are removed from cache
+     * futures returned by loadAsync() and loadMany() count as references, until
+     * they are released. The objects are removed from cache
      * @param cacheId The object cache id to be unloaded.
-     * @return false if object is not unloaded or cacheId is invalid
+     * @return false if object is not unloaded, is pinned or cacheId is invalid
      */
     LIVRECORE_API bool unload( const CacheId& cacheId );
 
+    /**
+     * Gets a view of the loaded objects for the lookups of a frame, which do
+     * not lock the cache. The snapshot is shared until the cache changes, the
+     * next call after a change builds a new one, so the loads and evictions do
+     * not. While another thread builds it, the previous snapshot is returned.
+     * The shards are collected one at a time, so changes during the collection
+     * may be included.
+     * @return the snapshot of the loaded objects
+     */
+    LIVRECORE_API std::shared_ptr< const CacheSnapshot< CacheObjectT >> getSnapshot() const;
+
     /** @return The number of cache objects managed. */
     LIVRECORE_API size_t getCount() const;
 
@@ -78,6 +114,40 @@ public:
     template< class... Args >
     LIVRECORE_API std::shared_ptr< const CacheObjectT > load( const CacheId& cacheId,
                                                               Args&&... args );
+
+    /**
+     * Loads the object to cache without waiting for concurrent loads of the
+     * same object. The first request for an object constructs it in the
+     * calling thread, the concurrent requests share its result.
+     * @param cacheId the id of the cache object to be loaded
+     * @param args parameters of the cache object constructor. If there is already
+     * a cache object with the same cache id, the args are not considered.
+     * @return the future of the std::shared_ptr< const CacheObjectT >, which is
+     * ready unless the object is being loaded by another thread. The pointer is
+     * empty if cache id is invalid or object cannot be loaded. The filters do
+     * not block their worker on a future which is not ready, they set their
+     * outputs once it is, \see PromiseMap::setWhenReady.
+     */
+    template< class... Args >
+    LIVRECORE_API Future loadAsync( const CacheId& cacheId, Args&&... args );
+
+    /**
+     * Loads a set of objects, i.e. the visible ones of a frame. Every shard
+     * is locked once to look up the objects and once to insert the loaded
+     * ones, and the cache evicts once for the size of the loaded objects,
+     * sparing the requested ones. The missing objects are constructed in the
+     * calling thread, so the loads are parallelized by splitting the set among
+     * the threads. The objects loaded concurrently by other threads are
+     * shared, as with \see loadAsync.
+     * @param cacheIds the ids of the cache objects to be loaded
+     * @param args parameters of the cache object constructor. If there is already
+     * a cache object with the same cache id, the args are not considered.
+     * @return the futures of the std::shared_ptr< const CacheObjectT >, in the
+     * order of the cache ids. The pointers are empty for invalid cache ids and
+     * the objects which cannot be loaded.
+     */
+    template< class... Args >
+    LIVRECORE_API Futures loadMany( const CacheIds& cacheIds, Args&&... args );
     /** @return Statistics. */
     LIVRECORE_API const CacheStatistics& getStatistics() const;
 
@@ -94,6 +164,93 @@ public:
      */
     LIVRECORE_API void purge( const CacheId& cacheId );
 
+    /**
+     * Changes the maximum memory. If the cache uses more memory, the objects
+     * are evicted by the next load or evict().
+     * @param maxMemBytes maximum memory.
+     */
+    LIVRECORE_API void setMaximumMemory( size_t maxMemBytes );
+
+    /**
+     * Sets the memory usage thresholds of the eviction as fractions of the
+     * maximum memory. Both are 1 by default.
+     * @param highWatermark evict() starts evicting above this threshold.
+     * @param lowWatermark the eviction stops below this threshold. This is
+     * also the case for the eviction in load(), which starts at the maximum
+     * memory.
+     * @throw std::runtime_error if not 0 <= lowWatermark <= highWatermark <= 1
+     */
+    LIVRECORE_API void setWatermarks( float highWatermark, float lowWatermark );
+
+    /**
+     * Evicts unreferenced objects if the used memory is above the high
+     * watermark, until it is below the low watermark. Allows to evict in
+     * another thread than the loading ones.
+     */
+    LIVRECORE_API void evict();
+
+    /**
+     * Sets the ids of the currently visible objects, which are evicted last by
+     * the visibility aware policy. Other policies ignore them.
+     * @param cacheIds The ids of the visible objects.
+     */
+    LIVRECORE_API void setVisibles( const CacheIds& cacheIds );
+
+    /**
+     * Registers a function which is called with the objects evicted by the
+     * cache policy, i.e. to keep them in a lower cache tier. It is called
+     * without cache locks held, in the thread which evicts. The objects which
+     * are unloaded or purged explicitly are not notified. Not thread safe, the
+     * function has to be registered before the cache is used.
+     * @param notifyEvictedFunc the function called for every evicted object.
+     */
+    LIVRECORE_API void registerNotifyEvicted(
+        const std::function< void( const std::shared_ptr< const CacheObjectT >& )>& notifyEvictedFunc );
+
+    /**
+     * Records the loads of the cache in a trace, i.e. to replay them with other
+     * policies and memory budgets. A request is traced once its object is
+     * loaded, the requests waiting for a concurrent load of the object are not
+     * traced. Not thread safe, the trace has to be set before the cache is
+     * used.
+     * @param trace the trace, which has to outlive the cache, or nullptr to
+     * disable the tracing.
+     */
+    LIVRECORE_API void setTrace( CacheTrace* trace );
+
+    /**
+     * Pins a loaded object, so it is not evicted or unloaded until it is
+     * unpinned or purged. The memory of the pinned objects is accounted
+     * separately from the maximum memory, \see setMaximumPinnedMemory.
+     * @param cacheId The object cache id to be pinned.
+     * @return false if the object is not loaded, the pinned memory is
+     * exhausted or cacheId is invalid
+     */
+    LIVRECORE_API bool pin( const CacheId& cacheId );
+
+    /**
+     * Pins the loaded and the later loaded objects for which the function
+     * returns true, i.e. the coarse levels of detail, while the pinned memory
+     * allows. The loaded objects are pinned in increasing cache id order.
+     * @param isPinnedFunc the function deciding if an object is pinned.
+     */
+    LIVRECORE_API void pinIf( const std::function< bool( const CacheId& )>& isPinnedFunc );
+
+    /**
+     * Unpins an object, which is then evicted by the cache policy again. The
+     * objects pinned by the \see pinIf function are pinned again when loaded.
+     * @param cacheId The object cache id to be unpinned.
+     * @return false if the object is not pinned
+     */
+    LIVRECORE_API bool unpin( const CacheId& cacheId );
+
+    /**
+     * Changes the maximum memory of the pinned objects, 0 by default. Objects
+     * pinned already stay pinned when it is decreased.
+     * @param maxMemBytes maximum pinned memory.
+     */
+    LIVRECORE_API void setMaximumPinnedMemory( size_t maxMemBytes );
+
 private:
 
     struct Impl;
@@ -24,245 +24,730 @@ class Cache< CacheObjectT >::Impl final
 {
     friend class Cache< CacheObjectT >;
 
-    struct LRUCachePolicy
+    typedef std::shared_ptr< const CacheObjectT > ConstObjectPtr;
+    typedef std::vector< ConstObjectPtr > ConstObjectPtrs;
+    typedef CacheSnapshot< CacheObjectT > Snapshot;
+    typedef std::shared_ptr< const Snapshot > ConstSnapshotPtr;
+
+    /**
+     * Holds the object or the future of the object while it is loaded. The
+     * first caller claims the load, concurrent callers share its future.
+     */
+    struct InternalCacheObject
     {
-        typedef std::deque< CacheId > LRUQueue;
-
-        LRUCachePolicy( const size_t maxMemBytes )
-            : _maxMemBytes( maxMemBytes )
-            , _cleanUpRatio( 1.0f )
+        InternalCacheObject()
+            : _promise( DataInfo( "CacheObject", getType< ConstObjectPtr >( )))
+            , _future( _promise.getFuture( ))
+            , _isClaimed( false )
         {}
 
-        bool isFull( const Cache< CacheObjectT >& cache ) const
+        /** @return true if the caller has to construct the object */
+        bool claim()
         {
-            const size_t usedMemBytes = cache.getStatistics().getUsedMemory();
-            return usedMemBytes >= _maxMemBytes;
+            return !_isClaimed.exchange( true );
         }
 
-        bool hasSpace( const Cache< CacheObjectT >& cache ) const
+        /**
+         * Constructs the object and sets the future. Only called by the
+         * claiming caller.
+         * @return the object, or an empty pointer if it cannot be loaded
+         */
+        template< class... Args >
+        ConstObjectPtr construct( const CacheId& cacheId, Args&&... args )
         {
-            const size_t usedMemBytes = cache.getStatistics().getUsedMemory();
-            return usedMemBytes < _cleanUpRatio * _maxMemBytes;
+            ConstObjectPtr obj;
+            try
+            {
+                // This can throw exception
+                obj.reset( new CacheObjectT( cacheId, args... ));
+            }
+            catch( const CacheLoadException& )
+            {}
+            catch( ... )
+            {
+                _promise.set( ConstObjectPtr( )); // Release the waiters
+                throw;
+            }
+            _promise.set( obj );
+            return obj;
         }
 
-        void insert( const CacheId& cacheId )
+        /**
+         * @return true if a future of the object is held out of the cache,
+         * i.e. by a request which did not collect the object yet
+         */
+        bool isRequested() const
         {
-            remove( cacheId );
-            _lruQueue.push_back( cacheId );
+            // The promise and the future of the entry share the state
+            return _future.getUseCount() > 2;
         }
 
-        void remove( const CacheId& cacheId )
+        /** @return the object, or an empty pointer while it is being loaded */
+        ConstObjectPtr get() const
+        {
+            if( !_future.isReady( ))
+                return ConstObjectPtr();
+            return _future.get< ConstObjectPtr >();
+        }
+
+        Promise _promise;
+        const Future _future;
+        std::atomic< bool > _isClaimed;
+    };
+
+    typedef std::shared_ptr< InternalCacheObject > InternalCacheObjectPtr;
+    typedef std::unordered_map< CacheId, InternalCacheObjectPtr > CacheMap;
+
+    /**
+     * Independently locked part of the cache. The cache ids are distributed
+     * to the shards by their hash, the memory budget is shared by all shards.
+     */
+    struct Shard
+    {
+        explicit Shard( const CachePolicyType policyType )
+            : _policy( CachePolicy::create( policyType ))
+            , _cacheMap( 128 )
+        {}
+
+        std::unique_ptr< CachePolicy > _policy; // Thread safe, also used with the read lock
+        CacheMap _cacheMap;
+        std::unordered_set< CacheId > _pinned; // Not in the policy
+        mutable ReadWriteMutex _mutex;
+    };
+
+    typedef std::vector< std::unique_ptr< Shard >> Shards;
+
+    Impl( const std::string& name,
+          const size_t maxMemBytes,
+          const size_t nShards,
+          const CachePolicyType policyType )
+        : _highWatermark( 1.0f )
+        , _lowWatermark( 1.0f )
+        , _statistics( name, maxMemBytes )
+        , _nextShard( 0 )
+        , _version( 0 )
+        , _snapshot( std::make_shared< const Snapshot >( typename Snapshot::Objects(), 0 ))
+        , _trace( nullptr )
+    {
+        for( size_t i = 0; i < std::max( nShards, size_t( 1 )); ++i )
+            _shards.emplace_back( new Shard( policyType ));
+    }
+
+    size_t getMaximumMemory() const
+    {
+        return _statistics.getMaximumMemory();
+    }
+
+    void trace( const CacheId& cacheId, const CacheObjectT& obj, const bool hit ) const
+    {
+        if( _trace )
+            _trace->notifyAccess( cacheId, obj.getSize(), hit );
+    }
+
+    size_t getHighWatermark() const
+    {
+        return size_t( _highWatermark * getMaximumMemory( ));
+    }
+
+    // Eviction stops below the low watermark, including the reserved memory
+    bool hasSpace( const size_t reservedBytes = 0 ) const
+    {
+        return _statistics.getUsedMemory() + reservedBytes < _lowWatermark * getMaximumMemory();
+    }
+
+    size_t getShardIndex( const CacheId& cacheId ) const
+    {
+        if( _shards.size() == 1 )
+            return 0;
+
+        // Node ids are bit fields, mix them before selecting the shard
+        const uint64_t hash = uint64_t( cacheId ) * 0x9E3779B97F4A7C15ull;
+        return ( hash >> 32 ) % _shards.size();
+    }
+
+    Shard& getShard( const CacheId& cacheId ) const
+    {
+        return *_shards[ getShardIndex( cacheId )];
+    }
+
+    // The shard has to be write locked. Eviction starts if the used memory
+    // and the memory reserved for objects being loaded reach maxBytes. The
+    // evicted objects are collected if there is an eviction listener, which
+    // is notified after the shard is unlocked.
+    void applyPolicy( Shard& shard, const size_t maxBytes, ConstObjectPtrs& evicted,
+                      const size_t reservedBytes = 0 )
+    {
+        if( shard._cacheMap.empty() || _statistics.getUsedMemory() + reservedBytes < maxBytes )
+            return;
+
+        // Objects are returned in delete order. Every id is visited at most
+        // once, the ones which are still referenced are rotated to the back.
+        for( size_t i = shard._policy->getCount(); i > 0; --i )
         {
-            typename LRUQueue::iterator it = _lruQueue.begin();
-            while( it != _lruQueue.end( ))
+            ConstObjectPtr obj;
+            if( unload( shard, shard._policy->next(), &obj ))
             {
-                if( *it == cacheId )
-                {
-                    _lruQueue.erase( it );
-                    return;
-                }
-                else
-                    ++it;
+                _statistics.notifyEviction();
+                if( _notifyEvictedFunc )
+                    evicted.push_back( obj );
             }
+            if( hasSpace( reservedBytes ))
+                return;
+        }
+    }
+
+    // No shard lock has to be held, the shards are locked one at a time
+    void applyPolicy( const size_t maxBytes, const size_t reservedBytes = 0 )
+    {
+        if( _statistics.getUsedMemory() + reservedBytes < maxBytes )
+            return;
+
+        ConstObjectPtrs evicted;
+        const size_t start = _nextShard++;
+        for( size_t i = 0; i < _shards.size() && !hasSpace( reservedBytes ); ++i )
+        {
+            Shard& shard = *_shards[ ( start + i ) % _shards.size( )];
+            WriteLock lock( shard._mutex );
+            applyPolicy( shard, maxBytes, evicted, reservedBytes );
         }
+        notifyEvicted( evicted );
+    }
+
+    void notifyEvicted( const ConstObjectPtrs& evicted ) const
+    {
+        for( const ConstObjectPtr& obj: evicted )
+            _notifyEvictedFunc( obj );
+    }
+
+    bool isPinned( const CacheId& cacheId ) const
+    {
+        ReadLock lock( _pinMutex );
+        return _isPinnedFunc && _isPinnedFunc( cacheId );
+    }
+
+    // The shard has to be write locked. The pinned objects are removed from
+    // the policy, so the eviction does not visit them.
+    bool pin( Shard& shard, const CacheId& cacheId, const CacheObjectT& obj )
+    {
+        if( shard._pinned.count( cacheId ))
+            return true;
+
+        if( !_statistics.notifyPinned( obj ))
+            return false;
+
+        shard._policy->remove( cacheId );
+        shard._pinned.insert( cacheId );
+        return true;
+    }
 
-        CacheIds getObjects() const
+    bool pinSafe( const CacheId& cacheId )
+    {
+        Shard& shard = getShard( cacheId );
+        WriteLock lock( shard._mutex );
+        typename CacheMap::const_iterator it = shard._cacheMap.find( cacheId );
+        if( it == shard._cacheMap.end( ))
+            return false;
+
+        const ConstObjectPtr obj = it->second->get();
+        return obj && pin( shard, cacheId, *obj );
+    }
+
+    void pinIf( const std::function< bool( const CacheId& )>& isPinnedFunc )
+    {
         {
-            CacheIds ids;
-            ids.reserve( _lruQueue.size( ));
-            ids.insert( ids.begin(), _lruQueue.begin(), _lruQueue.end());
-            return ids;
+            WriteLock lock( _pinMutex );
+            _isPinnedFunc = isPinnedFunc;
         }
 
-        void clear()
+        CacheIds cacheIds;
+        for( const auto& shard: _shards )
         {
-            _lruQueue.clear();
+            ReadLock lock( shard->_mutex );
+            for( const auto& entry: shard->_cacheMap )
+            {
+                if( isPinnedFunc( entry.first ))
+                    cacheIds.push_back( entry.first );
+            }
         }
 
-        const size_t _maxMemBytes;
-        const float _cleanUpRatio;
-        LRUQueue _lruQueue;
-    };
+        // Node ids sort coarse levels first
+        std::sort( cacheIds.begin(), cacheIds.end( ));
+        for( const CacheId& cacheId: cacheIds )
+            pinSafe( cacheId );
+    }
 
-    struct InternalCacheObject
+    bool unpin( const CacheId& cacheId )
     {
-        InternalCacheObject()
-            : _mutex( new ReadWriteMutex( ))
-        {}
+        Shard& shard = getShard( cacheId );
+        WriteLock lock( shard._mutex );
+        if( !shard._pinned.erase( cacheId ))
+            return false;
 
-        InternalCacheObject( InternalCacheObject&& obj )
-            : _mutex( std::move( obj._mutex ))
-            , _obj( std::move( obj._obj ))
-        {}
+        const ConstObjectPtr obj = shard._cacheMap[ cacheId ]->get();
+        _statistics.notifyUnpinned( *obj );
+        shard._policy->insert( cacheId );
+        return true;
+    }
 
-        template< class... Args >
-        std::shared_ptr< const CacheObjectT > load( const CacheId& cacheId, Args&&... args )
+    void evict()
+    {
+        applyPolicy( getHighWatermark( ));
+    }
+
+    void setMaximumMemory( const size_t maxMemBytes )
+    {
+        _statistics.setMaximumMemory( maxMemBytes );
+    }
+
+    void setWatermarks( const float highWatermark, const float lowWatermark )
+    {
+        if( lowWatermark > highWatermark || highWatermark > 1.0f || lowWatermark < 0.0f )
+            LBTHROW( std::runtime_error( "Invalid cache watermarks" ));
+
+        _highWatermark = highWatermark;
+        _lowWatermark = lowWatermark;
+    }
+
+    // Creates the internal representation if the object is not in the cache
+    // and postpones the construction, so the readers are not blocked with the
+    // write lock ( i.e. concurrent load, get method works )
+    InternalCacheObjectPtr getInternalObject( Shard& shard, const CacheId& cacheId )
+    {
+        WriteLock writeLock( shard._mutex );
+        InternalCacheObjectPtr& entry = shard._cacheMap[ cacheId ];
+        if( !entry )
+            entry.reset( new InternalCacheObject( ));
+        const InternalCacheObjectPtr internalObj = entry;
+        ConstObjectPtrs evicted;
+        applyPolicy( shard, getMaximumMemory(), evicted );
+        writeLock.unlock();
+
+        notifyEvicted( evicted );
+        return internalObj;
+    }
+
+    template< class... Args >
+    ConstObjectPtr construct( Shard& shard,
+                              const CacheId& cacheId,
+                              const InternalCacheObjectPtr& internalObj,
+                              Args&&... args )
+    {
+        ConstObjectPtr obj;
+        const auto startTime = std::chrono::steady_clock::now();
+        try
         {
-           WriteLock lock( *_mutex );
-           if( _obj )
-               return _obj;
-           try
-           {
-               // This can throw exception
-               // Unlock read lock so nobody is blocked
-               _obj.reset( new CacheObjectT( cacheId, args... ));
-           }
-           catch( const CacheLoadException& )
-           {
-               return std::shared_ptr< const CacheObjectT >();
-           }
-           return _obj;
+            obj = internalObj->construct( cacheId, args... );
+        }
+        catch( ... )
+        {
+            erase( shard, cacheId, internalObj );
+            throw;
         }
 
-        mutable std::shared_ptr< ReadWriteMutex > _mutex;
-        std::shared_ptr< const CacheObjectT > _obj;
-    };
+        if( !obj )
+        {
+            erase( shard, cacheId, internalObj );
+            return obj;
+        }
 
-    typedef std::unordered_map< CacheId, InternalCacheObject > CacheMap;
+        _statistics.notifyLoadTime( *obj, std::chrono::steady_clock::now() - startTime );
+        trace( cacheId, *obj, false );
 
-   Impl( Cache< CacheObjectT >& cache,
-         const std::string& name,
-         const size_t maxMemBytes )
-    : _policy( maxMemBytes )
-    , _cache( cache )
-    , _statistics( name, maxMemBytes )
-    , _cacheMap( 128 )
-    {}
+        ConstObjectPtrs evicted;
+        WriteLock writeLock( shard._mutex );
+        if( insert( shard, cacheId, internalObj, obj ))
+            applyPolicy( shard, getMaximumMemory(), evicted );
+        writeLock.unlock();
+
+        notifyEvicted( evicted );
+
+        if( _shards.size() > 1 )
+            applyPolicy( getMaximumMemory( ));
+        return obj;
+    }
 
-    void applyPolicy()
+    // The shard has to be write locked. Accounts a constructed object, or
+    // removes the entry of an object which could not be loaded.
+    // @return false if the object is not inserted
+    bool insert( Shard& shard,
+                 const CacheId& cacheId,
+                 const InternalCacheObjectPtr& internalObj,
+                 const ConstObjectPtr& obj )
     {
-        if( _cacheMap.empty() || !_policy.isFull( _cache ))
-            return;
+        typename CacheMap::iterator it = shard._cacheMap.find( cacheId );
+        // The object may have been purged while loading
+        if( it == shard._cacheMap.end() || it->second != internalObj )
+            return false;
 
-        // Objects are returned in delete order
-        for( const CacheId& cacheId: _policy.getObjects( ))
+        if( !obj )
         {
-            unload( cacheId );
-            if( _policy.hasSpace( _cache ))
-                return;
+            shard._cacheMap.erase( it );
+            return false;
+        }
+
+        _statistics.notifyLoaded( *obj );
+        shard._policy->insert( cacheId );
+        if( isPinned( cacheId ))
+            pin( shard, cacheId, *obj );
+        ++_version;
+        return true;
+    }
+
+    // Removes the entry of an object which could not be loaded
+    void erase( Shard& shard, const CacheId& cacheId, const InternalCacheObjectPtr& internalObj )
+    {
+        WriteLock writeLock( shard._mutex );
+        typename CacheMap::iterator it = shard._cacheMap.find( cacheId );
+        if( it != shard._cacheMap.end() && it->second == internalObj )
+            shard._cacheMap.erase( it );
+    }
+
+    template< class... Args >
+    ConstObjectPtr load( const CacheId& cacheId, Args&&... args )
+    {
+        Shard& shard = getShard( cacheId );
+        {   // If object is in cache, return it and mark it as recently used
+            ReadLock readLock( shard._mutex );
+            typename CacheMap::const_iterator it = shard._cacheMap.find( cacheId );
+            if( it != shard._cacheMap.end( ))
+            {
+                const ConstObjectPtr obj = it->second->get();
+                if( obj )
+                {
+                    shard._policy->touch( cacheId );
+                    _statistics.notifyHit();
+                    trace( cacheId, *obj, true );
+                    return obj;
+                }
+            }
         }
+
+        // Requests waiting for a concurrent load are misses too, but only the
+        // loading one accounts for the load time and the loaded bytes, and is
+        // traced
+        const InternalCacheObjectPtr internalObj = getInternalObject( shard, cacheId );
+        _statistics.notifyMiss();
+        if( internalObj->claim( ))
+            return construct( shard, cacheId, internalObj, args... );
+
+        return internalObj->_future.template get< ConstObjectPtr >(); // Blocks until loaded
     }
 
     template< class... Args >
-    std::shared_ptr< const CacheObjectT > load( const CacheId& cacheId, Args&&... args )
-    {
-        {   // If object is in cache, wait it is loading
-            ReadLock readLock( _mutex );
-            typename CacheMap::iterator it = _cacheMap.find( cacheId );
-            readLock.unlock();
-            if( it != _cacheMap.end() && it->second._obj )
-                return it->second.load( cacheId, args... );
+    Future loadAsync( const CacheId& cacheId, Args&&... args )
+    {
+        Shard& shard = getShard( cacheId );
+        {
+            ReadLock readLock( shard._mutex );
+            typename CacheMap::const_iterator it = shard._cacheMap.find( cacheId );
+            if( it != shard._cacheMap.end( ))
+            {
+                const InternalCacheObject& internalObj = *it->second;
+                const ConstObjectPtr obj = internalObj.get();
+                if( obj )
+                {
+                    shard._policy->touch( cacheId );
+                    _statistics.notifyHit();
+                    trace( cacheId, *obj, true );
+                }
+                else // Being loaded by another caller
+                    _statistics.notifyMiss();
+                return internalObj._future;
+            }
         }
 
+        const InternalCacheObjectPtr internalObj = getInternalObject( shard, cacheId );
+        _statistics.notifyMiss();
+        if( internalObj->claim( ))
+            construct( shard, cacheId, internalObj, args... );
+        return internalObj->_future;
+    }
+
+    template< class... Args >
+    Futures loadMany( const CacheIds& cacheIds, Args&&... args )
+    {
+        // The ids are grouped by shard, so every shard is locked once to
+        // find the loaded objects and once to insert the constructed ones
+        std::vector< std::vector< size_t >> shardIndices( _shards.size( ));
+        std::vector< InternalCacheObjectPtr > internalObjs( cacheIds.size( ));
+        for( size_t i = 0; i < cacheIds.size(); ++i )
         {
-            WriteLock writeLock( _mutex );
-            // If object is not in the cache, add do the cache and postpone loading to
-            // get method
-            typename CacheMap::const_iterator it = _cacheMap.find( cacheId );
-            if( it == _cacheMap.end( ))
+            if( cacheIds[ i ] != INVALID_CACHE_ID )
             {
-                // If object is not cache, create the internal representation and
-                // postpone the construction.
-                // So the readers are not blocked with write lock ( i.e. concurrent
-                // load, get method works )
-                _cacheMap.emplace( std::piecewise_construct,
-                                   std::forward_as_tuple( cacheId ),
-                                   std::forward_as_tuple( InternalCacheObject()));
+                shardIndices[ getShardIndex( cacheIds[ i ])].push_back( i );
+                continue;
             }
-            applyPolicy();
+
+            internalObjs[ i ].reset( new InternalCacheObject( ));
+            internalObjs[ i ]->_promise.set( ConstObjectPtr( ));
         }
 
-        // If object is in cache, wait it is loading
+        std::vector< size_t > claimed; // Ordered by shard
+        ConstObjectPtrs hits; // Not evicted to make room for the claimed ones
+        for( size_t s = 0; s < _shards.size(); ++s )
         {
-            ReadLock readLock( _mutex );
-            typename CacheMap::iterator it = _cacheMap.find( cacheId );
-            readLock.unlock();
-
-            std::shared_ptr< const CacheObjectT > obj;
-            obj = it->second.load( cacheId, args... );
-            WriteLock writeLock( _mutex );
-            if( obj )
+            if( shardIndices[ s ].empty( ))
+                continue;
+
+            Shard& shard = *_shards[ s ];
+            WriteLock writeLock( shard._mutex );
+            for( const size_t i: shardIndices[ s ])
             {
-                _statistics.notifyMiss();
-                _statistics.notifyLoaded( *obj );
-                _policy.insert( cacheId );
-                applyPolicy();
+                InternalCacheObjectPtr& entry = shard._cacheMap[ cacheIds[ i ]];
+                const ConstObjectPtr obj = entry ? entry->get() : ConstObjectPtr();
+                if( obj )
+                {
+                    shard._policy->touch( cacheIds[ i ]);
+                    _statistics.notifyHit();
+                    trace( cacheIds[ i ], *obj, true );
+                    hits.push_back( obj );
+                }
+                else
+                {
+                    if( !entry )
+                        entry.reset( new InternalCacheObject( ));
+                    _statistics.notifyMiss();
+                    if( entry->claim( ))
+                        claimed.push_back( i );
+                }
+                internalObjs[ i ] = entry;
             }
-            else
-                _cacheMap.erase( cacheId );
-            return obj; // Blocks until loaded
         }
+
+        if( !claimed.empty( ))
+            loadClaimed( cacheIds, internalObjs, claimed, args... );
+
+        Futures futures;
+        for( const InternalCacheObjectPtr& internalObj: internalObjs )
+            futures.push_back( internalObj->_future );
+        return futures;
     }
 
-    std::shared_ptr< const CacheObjectT > get( const CacheId& cacheId ) const
+    template< class... Args >
+    void loadClaimed( const CacheIds& cacheIds,
+                      const std::vector< InternalCacheObjectPtr >& internalObjs,
+                      const std::vector< size_t >& claimed,
+                      Args&&... args )
     {
-        ReadLock readLock( _mutex );
-        typename CacheMap::const_iterator it = _cacheMap.find( cacheId );
-        if( it == _cacheMap.end( ))
-           return std::shared_ptr< const CacheObjectT >();
+        ConstObjectPtrs objs( claimed.size( ));
+        size_t loadedBytes = 0;
+        for( size_t j = 0; j < claimed.size(); ++j )
+        {
+            const size_t i = claimed[ j ];
+            const auto startTime = std::chrono::steady_clock::now();
+            try
+            {
+                objs[ j ] = internalObjs[ i ]->construct( cacheIds[ i ], args... );
+            }
+            catch( ... )
+            {
+                // Releases the waiters of the objects which are not constructed
+                for( size_t k = j + 1; k < claimed.size(); ++k )
+                    internalObjs[ claimed[ k ]]->_promise.set( ConstObjectPtr( ));
+                for( const size_t k: claimed )
+                    erase( getShard( cacheIds[ k ]), cacheIds[ k ], internalObjs[ k ]);
+                throw;
+            }
 
-        return it->second._obj; // Object may still be loaded
+            if( objs[ j ] )
+            {
+                _statistics.notifyLoadTime( *objs[ j ],
+                                            std::chrono::steady_clock::now() - startTime );
+                trace( cacheIds[ i ], *objs[ j ], false );
+                loadedBytes += objs[ j ]->getSize();
+            }
+        }
+
+        // Evicts once for the loaded objects, while the caller holds the
+        // objects found in the cache
+        applyPolicy( getMaximumMemory(), loadedBytes );
+
+        ConstObjectPtrs evicted;
+        for( size_t j = 0; j < claimed.size(); )
+        {
+            const size_t shardIndex = getShardIndex( cacheIds[ claimed[ j ]]);
+            Shard& shard = *_shards[ shardIndex ];
+            WriteLock writeLock( shard._mutex );
+            for( ; j < claimed.size() && getShardIndex( cacheIds[ claimed[ j ]]) == shardIndex; ++j )
+            {
+                const size_t i = claimed[ j ];
+                insert( shard, cacheIds[ i ], internalObjs[ i ], objs[ j ]);
+            }
+            applyPolicy( shard, getMaximumMemory(), evicted );
+        }
+        notifyEvicted( evicted );
+
+        if( _shards.size() > 1 )
+            applyPolicy( getMaximumMemory( ));
     }
 
-    void unload( const CacheId& cacheId )
+    ConstObjectPtr peek( const CacheId& cacheId ) const
     {
-        typename CacheMap::const_iterator it = _cacheMap.find( cacheId );
-        if( it == _cacheMap.end( ))
-            return;
+        const Shard& shard = getShard( cacheId );
+        ReadLock readLock( shard._mutex );
+        typename CacheMap::const_iterator it = shard._cacheMap.find( cacheId );
+        return it == shard._cacheMap.end() ? ConstObjectPtr()
+                                           : it->second->get(); // Object may still be loaded
+    }
 
-        const ConstCacheObjectPtr& obj = it->second._obj; // +1 ref
-        if( !obj || obj.use_count() > 2 ) // Object is still being loaded or referenced
-            return;
+    ConstObjectPtr get( const CacheId& cacheId ) const
+    {
+        const ConstObjectPtr obj = peek( cacheId );
+        if( obj )
+            _statistics.notifyHit();
+        else
+            _statistics.notifyMiss();
+        return obj;
+    }
 
-        _policy.remove( cacheId );
-        _statistics.notifyUnloaded( *obj );
-        _cacheMap.erase( cacheId );
+    // Builds a new snapshot when the loaded objects changed, at most once per
+    // frame of the readers. The writers only change the version, so a miss
+    // does not collect the whole cache.
+    ConstSnapshotPtr getSnapshot() const
+    {
+        const ConstSnapshotPtr current = std::atomic_load( &_snapshot );
+        if( current->getVersion() == _version )
+            return current;
+
+        // A single reader builds it, the others keep the previous snapshot
+        // meanwhile
+        boost::unique_lock< boost::mutex > lock( _publishMutex, boost::try_to_lock );
+        if( !lock.owns_lock( ))
+            return current;
+
+        // The version is read first, a change while collecting the objects
+        // is published by the next call
+        const uint64_t version = _version;
+        ConstSnapshotPtr snapshot = std::atomic_load( &_snapshot );
+        if( snapshot->getVersion() == version )
+            return snapshot;
+
+        typename Snapshot::Objects objects;
+        for( const auto& shard: _shards )
+        {
+            ReadLock lock( shard->_mutex );
+            for( const auto& entry: shard->_cacheMap )
+            {
+                const ConstObjectPtr obj = entry.second->get();
+                if( obj )
+                    objects.emplace_back( entry.first, obj );
+            }
+        }
+
+        snapshot = std::make_shared< const Snapshot >( objects, version );
+        std::atomic_store( &_snapshot, snapshot );
+        return snapshot;
     }
 
-    bool unloadSafe( const CacheId& cacheId )
+    // The shard has to be write locked
+    bool unload( Shard& shard, const CacheId& cacheId, ConstObjectPtr* unloaded = nullptr )
     {
-        ReadLock readLock( _mutex );
-        typename CacheMap::iterator it = _cacheMap.find( cacheId );
-        if( it == _cacheMap.end( ))
+        if( shard._pinned.count( cacheId ))
             return false;
 
-        const ConstCacheObjectPtr& obj = it->second._obj; // +1 ref
-        if( !obj || obj.use_count() > 2 ) // Object is still being loaded or referenced
+        typename CacheMap::iterator it = shard._cacheMap.find( cacheId );
+        if( it == shard._cacheMap.end( ))
             return false;
-        readLock.unlock();
 
-        WriteLock lock( _mutex );
-        _policy.remove( cacheId );
+        // The object is still being loaded, referenced, or requested
+        const InternalCacheObject& internalObj = *it->second;
+        const ConstObjectPtr obj = internalObj.get(); // +1 ref
+        if( !obj || obj.use_count() > 2 || internalObj.isRequested( ))
+            return false;
+
+        shard._policy->remove( cacheId );
         _statistics.notifyUnloaded( *obj );
-        _cacheMap.erase( cacheId );
+        shard._cacheMap.erase( it );
+        ++_version;
+        if( unloaded )
+            *unloaded = obj;
         return true;
     }
 
+    bool unloadSafe( const CacheId& cacheId )
+    {
+        Shard& shard = getShard( cacheId );
+        WriteLock lock( shard._mutex );
+        return unload( shard, cacheId );
+    }
+
     size_t getCount() const
     {
-        ReadLock lock( _mutex );
-        return _cacheMap.size();
+        size_t count = 0;
+        for( const auto& shard: _shards )
+        {
+            ReadLock lock( shard->_mutex );
+            count += shard->_cacheMap.size();
+        }
+        return count;
     }
 
     void purge()
     {
-        WriteLock lock( _mutex );
+        // Shards are always locked in the same order
+        std::vector< WriteLock > locks;
+        locks.reserve( _shards.size( ));
+        for( const auto& shard: _shards )
+            locks.emplace_back( shard->_mutex );
+
         _statistics.clear();
-        _policy.clear();
-        _cacheMap.clear();
+        for( const auto& shard: _shards )
+        {
+            shard->_policy->clear();
+            shard->_cacheMap.clear();
+            shard->_pinned.clear();
+        }
+        ++_version;
     }
 
     void purge( const CacheId& cacheId )
     {
-        WriteLock lock( _mutex );
-        _cacheMap.erase( cacheId );
+        Shard& shard = getShard( cacheId );
+        WriteLock lock( shard._mutex );
+        typename CacheMap::iterator it = shard._cacheMap.find( cacheId );
+        if( it == shard._cacheMap.end( ))
+            return;
+
+        const ConstObjectPtr obj = it->second->get();
+        if( obj )
+        {
+            if( shard._pinned.erase( cacheId ))
+                _statistics.notifyUnpinned( *obj );
+            shard._policy->remove( cacheId );
+            _statistics.notifyUnloaded( *obj );
+            ++_version;
+        }
+        shard._cacheMap.erase( it );
     }
 
-    mutable LRUCachePolicy _policy;
-    Cache< CacheObjectT >& _cache;
+    void setVisibles( const CacheIds& cacheIds )
+    {
+        if( _shards.size() == 1 )
+        {
+            _shards.front()->_policy->setVisibles( cacheIds );
+            return;
+        }
+
+        std::unordered_map< const Shard*, CacheIds > shardIds;
+        for( const CacheId& cacheId: cacheIds )
+            shardIds[ &getShard( cacheId ) ].push_back( cacheId );
+
+        for( const auto& shard: _shards )
+            shard->_policy->setVisibles( shardIds[ shard.get() ]);
+    }
+
+    std::atomic< float > _highWatermark;
+    std::atomic< float > _lowWatermark;
     mutable CacheStatistics _statistics;
-    CacheMap _cacheMap;
-    mutable ReadWriteMutex _mutex;
+    Shards _shards;
+    std::atomic< size_t > _nextShard;
+    std::atomic< uint64_t > _version; // Changed with the set of loaded objects
+    mutable ConstSnapshotPtr _snapshot; // Atomically replaced by the readers
+    mutable boost::mutex _publishMutex; // Held by the reader building the snapshot
+    std::function< void( const ConstObjectPtr& )> _notifyEvictedFunc;
+    std::function< bool( const CacheId& )> _isPinnedFunc;
+    CacheTrace* _trace;
+    mutable ReadWriteMutex _pinMutex;
 
 public:
     ~Impl()
@@ -270,8 +755,11 @@ public:
 };
 
 template< class CacheObjectT >
-Cache< CacheObjectT >::Cache( const std::string& name, size_t maxMemBytes )
-    : _impl( new Cache< CacheObjectT >::Impl( *this, name, maxMemBytes ))
+Cache< CacheObjectT >::Cache( const std::string& name,
+                              const size_t maxMemBytes,
+                              const size_t nShards,
+                              const CachePolicyType policyType )
+    : _impl( new Cache< CacheObjectT >::Impl( name, maxMemBytes, nShards, policyType ))
 {}
 
 template< class CacheObjectT >
@@ -289,6 +777,27 @@ Cache< CacheObjectT >::load( const CacheId& cacheId, Args&&... args )
     return _impl->load( cacheId, args... );
 }
 
+template< class CacheObjectT >
+template< class... Args >
+Future Cache< CacheObjectT >::loadAsync( const CacheId& cacheId, Args&&... args )
+{
+    if( cacheId == INVALID_CACHE_ID )
+    {
+        Promise promise( DataInfo( "CacheObject", getType< std::shared_ptr< const CacheObjectT >>( )));
+        promise.set( std::shared_ptr< const CacheObjectT >( ));
+        return promise.getFuture();
+    }
+
+    return _impl->loadAsync( cacheId, args... );
+}
+
+template< class CacheObjectT >
+template< class... Args >
+Futures Cache< CacheObjectT >::loadMany( const CacheIds& cacheIds, Args&&... args )
+{
+    return _impl->loadMany( cacheIds, args... );
+}
+
 template< class CacheObjectT >
 bool Cache< CacheObjectT >::unload( const CacheId& cacheId )
 {
@@ -302,7 +811,7 @@ template< class CacheObjectT >
 std::shared_ptr< const CacheObjectT > Cache< CacheObjectT >::get( const CacheId& cacheId ) const
 {
     if( cacheId == INVALID_CACHE_ID )
-        return false;
+        return std::shared_ptr< const CacheObjectT >();
 
     std::shared_ptr< const CacheObjectT > obj = _impl->get( cacheId );
     if( !obj )
@@ -311,6 +820,21 @@ std::shared_ptr< const CacheObjectT > Cache< CacheObjectT >::get( const CacheId&
     return obj;
 }
 
+template< class CacheObjectT >
+std::shared_ptr< const CacheObjectT > Cache< CacheObjectT >::peek( const CacheId& cacheId ) const
+{
+    if( cacheId == INVALID_CACHE_ID )
+        return std::shared_ptr< const CacheObjectT >();
+
+    return _impl->peek( cacheId );
+}
+
+template< class CacheObjectT >
+std::shared_ptr< const CacheSnapshot< CacheObjectT >> Cache< CacheObjectT >::getSnapshot() const
+{
+    return _impl->getSnapshot();
+}
+
 template< class CacheObjectT >
 size_t Cache< CacheObjectT >::getCount() const
 {
@@ -335,3 +859,68 @@ void Cache< CacheObjectT >::purge( const CacheId& cacheId )
     _impl->purge( cacheId );
 }
 
+template< class CacheObjectT >
+void Cache< CacheObjectT >::setMaximumMemory( const size_t maxMemBytes )
+{
+    _impl->setMaximumMemory( maxMemBytes );
+}
+
+template< class CacheObjectT >
+void Cache< CacheObjectT >::setWatermarks( const float highWatermark,
+                                           const float lowWatermark )
+{
+    _impl->setWatermarks( highWatermark, lowWatermark );
+}
+
+template< class CacheObjectT >
+void Cache< CacheObjectT >::evict()
+{
+    _impl->evict();
+}
+
+template< class CacheObjectT >
+void Cache< CacheObjectT >::registerNotifyEvicted(
+    const std::function< void( const std::shared_ptr< const CacheObjectT >& )>& notifyEvictedFunc )
+{
+    _impl->_notifyEvictedFunc = notifyEvictedFunc;
+}
+
+template< class CacheObjectT >
+void Cache< CacheObjectT >::setTrace( CacheTrace* trace )
+{
+    _impl->_trace = trace;
+}
+
+template< class CacheObjectT >
+void Cache< CacheObjectT >::setVisibles( const CacheIds& cacheIds )
+{
+    _impl->setVisibles( cacheIds );
+}
+
+
+template< class CacheObjectT >
+bool Cache< CacheObjectT >::pin( const CacheId& cacheId )
+{
+    if( cacheId == INVALID_CACHE_ID )
+        return false;
+
+    return _impl->pinSafe( cacheId );
+}
+
+template< class CacheObjectT >
+void Cache< CacheObjectT >::pinIf( const std::function< bool( const CacheId& )>& isPinnedFunc )
+{
+    _impl->pinIf( isPinnedFunc );
+}
+
+template< class CacheObjectT >
+bool Cache< CacheObjectT >::unpin( const CacheId& cacheId )
+{
+    return _impl->unpin( cacheId );
+}
+
+template< class CacheObjectT >
+void Cache< CacheObjectT >::setMaximumPinnedMemory( const size_t maxMemBytes )
+{
+    _impl->_statistics.setMaximumPinnedMemory( maxMemBytes );
+}
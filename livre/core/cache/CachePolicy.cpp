@@ -0,0 +1,510 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/CachePolicy.h>
+
+#include <lunchbox/debug.h>
+
+#include <unordered_set>
+
+namespace livre
+{
+namespace
+{
+
+typedef std::list< CacheId > IdList;
+
+/**
+ * Keeps the cache ids in least recently used order. The list holds the
+ * order and the index maps the ids to their list positions, so touching,
+ * inserting and removing are constant time.
+ */
+class LRUCachePolicy : public CachePolicy
+{
+public:
+
+    void insert( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        if( it != _index.end( ))
+        {
+            _lruList.splice( _lruList.end(), _lruList, it->second );
+            return;
+        }
+        _index[ cacheId ] = _lruList.insert( _lruList.end(), cacheId );
+    }
+
+    void touch( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        if( it != _index.end( ))
+            _lruList.splice( _lruList.end(), _lruList, it->second );
+    }
+
+    void remove( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        if( it == _index.end( ))
+            return;
+
+        _lruList.erase( it->second );
+        _index.erase( it );
+    }
+
+    CacheId next() final
+    {
+        ScopedLock lock( _mutex );
+        if( _lruList.empty( ))
+            return INVALID_CACHE_ID;
+
+        const CacheId cacheId = _lruList.front();
+        _lruList.splice( _lruList.end(), _lruList, _lruList.begin( ));
+        return cacheId;
+    }
+
+    size_t getCount() const final
+    {
+        ScopedLock lock( _mutex );
+        return _lruList.size();
+    }
+
+    void clear() final
+    {
+        ScopedLock lock( _mutex );
+        _lruList.clear();
+        _index.clear();
+    }
+
+private:
+
+    IdList _lruList;
+    std::unordered_map< CacheId, IdList::iterator > _index;
+    mutable boost::mutex _mutex;
+};
+
+/**
+ * Evicts the least frequently used ids first, and the least recently used
+ * ones among the ids with the same frequency. The ids are kept in per
+ * frequency lists, so only finding the lowest frequency is logarithmic in the
+ * number of distinct frequencies.
+ */
+class LFUCachePolicy : public CachePolicy
+{
+public:
+
+    void insert( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        if( it != _index.end( ))
+        {
+            _setFrequency( it->second, it->second.frequency + 1 );
+            return;
+        }
+
+        IdList& ids = _frequencies[ 1 ];
+        _index[ cacheId ] = { 1, ids.insert( ids.end(), cacheId ) };
+    }
+
+    void touch( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        if( it != _index.end( ))
+            _setFrequency( it->second, it->second.frequency + 1 );
+    }
+
+    void remove( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        if( it == _index.end( ))
+            return;
+
+        const auto frequency = _frequencies.find( it->second.frequency );
+        frequency->second.erase( it->second.position );
+        if( frequency->second.empty( ))
+            _frequencies.erase( frequency );
+        _index.erase( it );
+    }
+
+    CacheId next() final
+    {
+        ScopedLock lock( _mutex );
+        if( _frequencies.empty( ))
+            return INVALID_CACHE_ID;
+
+        // A candidate which is not evicted is in use, so it counts as an access
+        const CacheId cacheId = _frequencies.begin()->second.front();
+        Entry& entry = _index[ cacheId ];
+        _setFrequency( entry, entry.frequency + 1 );
+        return cacheId;
+    }
+
+    size_t getCount() const final
+    {
+        ScopedLock lock( _mutex );
+        return _index.size();
+    }
+
+    void clear() final
+    {
+        ScopedLock lock( _mutex );
+        _frequencies.clear();
+        _index.clear();
+    }
+
+private:
+
+    struct Entry
+    {
+        size_t frequency;
+        IdList::iterator position;
+    };
+
+    void _setFrequency( Entry& entry, const size_t frequency )
+    {
+        const auto from = _frequencies.find( entry.frequency );
+        IdList& to = _frequencies[ frequency ];
+        to.splice( to.end(), from->second, entry.position );
+        if( from->second.empty( ))
+            _frequencies.erase( from );
+        entry.frequency = frequency;
+    }
+
+    std::map< size_t, IdList > _frequencies;
+    std::unordered_map< CacheId, Entry > _index;
+    mutable boost::mutex _mutex;
+};
+
+/**
+ * Simplified 2Q policy ( Johnson and Shasha, VLDB 1994 ). New ids enter a
+ * FIFO queue and are only promoted to the main LRU queue if they are loaded
+ * again shortly after being evicted, which is tracked with a queue of
+ * evicted ids. A scan through many objects only flushes the FIFO queue, and
+ * the objects which are used on every frame stay in the main queue.
+ */
+class TwoQueueCachePolicy : public CachePolicy
+{
+public:
+
+    TwoQueueCachePolicy()
+        : _mainRotations( 0 )
+    {}
+
+    void insert( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        _mainRotations = 0;
+        const auto it = _index.find( cacheId );
+        if( it == _index.end( ))
+        {
+            _index[ cacheId ] = { QUEUE_IN, _in.insert( _in.end(), cacheId ) };
+            return;
+        }
+
+        Entry& entry = it->second;
+        if( entry.queue == QUEUE_OUT ) // Reloaded soon after eviction
+        {
+            _main.splice( _main.end(), _out, entry.position );
+            entry.queue = QUEUE_MAIN;
+        }
+        else if( entry.queue == QUEUE_MAIN )
+            _main.splice( _main.end(), _main, entry.position );
+    }
+
+    void touch( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        // Accesses to the ids in the FIFO queue are correlated ( i.e. in the
+        // same frame ) and do not promote them.
+        if( it != _index.end() && it->second.queue == QUEUE_MAIN )
+            _main.splice( _main.end(), _main, it->second.position );
+    }
+
+    void remove( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        if( it == _index.end( ))
+            return;
+
+        Entry& entry = it->second;
+        switch( entry.queue )
+        {
+        case QUEUE_IN:
+            _out.splice( _out.end(), _in, entry.position );
+            entry.queue = QUEUE_OUT;
+            _trimOut();
+            break;
+        case QUEUE_MAIN:
+            _main.erase( entry.position );
+            _index.erase( it );
+            break;
+        case QUEUE_OUT:
+            break;
+        }
+    }
+
+    CacheId next() final
+    {
+        ScopedLock lock( _mutex );
+        const size_t count = _in.size() + _main.size();
+        if( count == 0 )
+            return INVALID_CACHE_ID;
+
+        // The FIFO queue is evicted first when it exceeds its share, or when
+        // all the ids in the main queue were already returned without being
+        // evicted since the last insertion.
+        const size_t inLimit = std::max( count / 4, size_t( 1 ));
+        const bool fromIn = !_in.empty() && ( _in.size() > inLimit ||
+                                              _mainRotations >= _main.size( ));
+        IdList& queue = fromIn ? _in : _main;
+        if( !fromIn )
+            ++_mainRotations;
+
+        const CacheId cacheId = queue.front();
+        queue.splice( queue.end(), queue, queue.begin( ));
+        return cacheId;
+    }
+
+    size_t getCount() const final
+    {
+        ScopedLock lock( _mutex );
+        return _in.size() + _main.size();
+    }
+
+    void clear() final
+    {
+        ScopedLock lock( _mutex );
+        _in.clear();
+        _main.clear();
+        _out.clear();
+        _index.clear();
+        _mainRotations = 0;
+    }
+
+private:
+
+    enum Queue
+    {
+        QUEUE_IN,
+        QUEUE_MAIN,
+        QUEUE_OUT
+    };
+
+    struct Entry
+    {
+        Queue queue;
+        IdList::iterator position;
+    };
+
+    void _trimOut()
+    {
+        // Remember evicted ids for half of the number of cached objects
+        const size_t maxOut = std::max(( _in.size() + _main.size( )) / 2, size_t( 1 ));
+        while( _out.size() > maxOut )
+        {
+            _index.erase( _out.front( ));
+            _out.pop_front();
+        }
+    }
+
+    IdList _in;
+    IdList _main;
+    IdList _out;
+    std::unordered_map< CacheId, Entry > _index;
+    size_t _mainRotations;
+    mutable boost::mutex _mutex;
+};
+
+/**
+ * Least recently used policy which keeps the currently visible ids in a
+ * separate list. The visible ids are only evicted if none of the other ids
+ * can be evicted.
+ */
+class VisibleCachePolicy : public CachePolicy
+{
+public:
+
+    VisibleCachePolicy()
+        : _otherRotations( 0 )
+    {}
+
+    void insert( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        _otherRotations = 0;
+        const auto it = _index.find( cacheId );
+        if( it != _index.end( ))
+        {
+            _touch( it->second );
+            return;
+        }
+
+        const bool isVisible = _visibleSet.count( cacheId ) > 0;
+        IdList& ids = isVisible ? _visibles : _others;
+        _index[ cacheId ] = { isVisible, ids.insert( ids.end(), cacheId ) };
+    }
+
+    void touch( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        if( it != _index.end( ))
+            _touch( it->second );
+    }
+
+    void remove( const CacheId& cacheId ) final
+    {
+        ScopedLock lock( _mutex );
+        const auto it = _index.find( cacheId );
+        if( it == _index.end( ))
+            return;
+
+        ( it->second.isVisible ? _visibles : _others ).erase( it->second.position );
+        _index.erase( it );
+    }
+
+    CacheId next() final
+    {
+        ScopedLock lock( _mutex );
+        const bool fromOthers = !_others.empty() &&
+                                ( _otherRotations < _others.size() || _visibles.empty( ));
+        IdList& ids = fromOthers ? _others : _visibles;
+        if( ids.empty( ))
+            return INVALID_CACHE_ID;
+
+        if( fromOthers )
+            ++_otherRotations;
+
+        const CacheId cacheId = ids.front();
+        ids.splice( ids.end(), ids, ids.begin( ));
+        return cacheId;
+    }
+
+    size_t getCount() const final
+    {
+        ScopedLock lock( _mutex );
+        return _index.size();
+    }
+
+    void clear() final
+    {
+        ScopedLock lock( _mutex );
+        _visibles.clear();
+        _others.clear();
+        _index.clear();
+        _otherRotations = 0;
+    }
+
+    void setVisibles( const CacheIds& cacheIds ) final
+    {
+        ScopedLock lock( _mutex );
+
+        // The previously visible ids become the most recently used others
+        for( const CacheId& cacheId: _visibles )
+            _index[ cacheId ].isVisible = false;
+        _others.splice( _others.end(), _visibles );
+
+        _visibleSet.clear();
+        _visibleSet.insert( cacheIds.begin(), cacheIds.end( ));
+        for( const CacheId& cacheId: cacheIds )
+        {
+            const auto it = _index.find( cacheId );
+            if( it == _index.end() || it->second.isVisible )
+                continue;
+
+            _visibles.splice( _visibles.end(), _others, it->second.position );
+            it->second.isVisible = true;
+        }
+        _otherRotations = 0;
+    }
+
+private:
+
+    struct Entry
+    {
+        bool isVisible;
+        IdList::iterator position;
+    };
+
+    void _touch( const Entry& entry )
+    {
+        IdList& ids = entry.isVisible ? _visibles : _others;
+        ids.splice( ids.end(), ids, entry.position );
+    }
+
+    IdList _visibles;
+    IdList _others;
+    std::unordered_map< CacheId, Entry > _index;
+    std::unordered_set< CacheId > _visibleSet;
+    size_t _otherRotations;
+    mutable boost::mutex _mutex;
+};
+
+const std::map< std::string, CachePolicyType > policyNames =
+{
+    { "lru", CP_LRU },
+    { "lfu", CP_LFU },
+    { "2q", CP_2Q },
+    { "visible", CP_VISIBLE }
+};
+
+}
+
+std::unique_ptr< CachePolicy > CachePolicy::create( const CachePolicyType type )
+{
+    switch( type )
+    {
+    case CP_LFU:
+        return std::unique_ptr< CachePolicy >( new LFUCachePolicy( ));
+    case CP_2Q:
+        return std::unique_ptr< CachePolicy >( new TwoQueueCachePolicy( ));
+    case CP_VISIBLE:
+        return std::unique_ptr< CachePolicy >( new VisibleCachePolicy( ));
+    case CP_LRU:
+    default:
+        return std::unique_ptr< CachePolicy >( new LRUCachePolicy( ));
+    }
+}
+
+CachePolicyType getCachePolicyType( const std::string& name )
+{
+    const auto it = policyNames.find( name );
+    if( it == policyNames.end( ))
+        LBTHROW( std::runtime_error( "Unknown cache policy: " + name ));
+
+    return it->second;
+}
+
+std::string getCachePolicyName( const CachePolicyType type )
+{
+    for( const auto& namePolicy: policyNames )
+        if( namePolicy.second == type )
+            return namePolicy.first;
+
+    return "lru";
+}
+
+}
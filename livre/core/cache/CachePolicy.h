@@ -0,0 +1,111 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CachePolicy_h_
+#define _CachePolicy_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+
+/** The eviction policies of the \see Cache */
+enum CachePolicyType
+{
+    CP_LRU = 0u, //!< Least recently used
+    CP_LFU = 1u, //!< Least frequently used
+    CP_2Q = 2u, //!< Scan resistant two queue LRU
+    CP_VISIBLE = 3u //!< Least recently used, visible objects are evicted last
+};
+
+/**
+ * The CachePolicy class decides the order in which objects are evicted from
+ * the \see Cache. The cache notifies the policy about loaded, accessed and
+ * removed objects and asks it for eviction candidates. The methods are thread
+ * safe.
+ */
+class CachePolicy
+{
+public:
+
+    LIVRECORE_API virtual ~CachePolicy() {}
+
+    /**
+     * Notifies the policy about a loaded object.
+     * @param cacheId the id of the object.
+     */
+    virtual void insert( const CacheId& cacheId ) = 0;
+
+    /**
+     * Notifies the policy about an access to a cached object.
+     * @param cacheId the id of the object.
+     */
+    virtual void touch( const CacheId& cacheId ) = 0;
+
+    /**
+     * Notifies the policy about a removed object.
+     * @param cacheId the id of the object.
+     */
+    virtual void remove( const CacheId& cacheId ) = 0;
+
+    /**
+     * @return the next eviction candidate or INVALID_CACHE_ID if there are no
+     * objects. If the cache can not evict the candidate ( i.e. it is still
+     * referenced ), it stays in the policy and is not returned again before the
+     * other candidates.
+     */
+    virtual CacheId next() = 0;
+
+    /** @return the number of objects known to the policy */
+    virtual size_t getCount() const = 0;
+
+    /** Removes all objects from the policy */
+    virtual void clear() = 0;
+
+    /**
+     * Sets the ids of the currently visible objects. Policies that do not take
+     * visibility into account ignore them.
+     * @param cacheIds the ids of the visible objects.
+     */
+    virtual void setVisibles( const CacheIds& ) {}
+
+    /**
+     * @param type of the policy
+     * @return a new policy
+     */
+    LIVRECORE_API static std::unique_ptr< CachePolicy > create( CachePolicyType type );
+};
+
+/**
+ * @param name of the policy ( "lru", "lfu", "2q" or "visible" )
+ * @return the policy type
+ * @throw std::runtime_error if there is no policy with the given name
+ */
+LIVRECORE_API CachePolicyType getCachePolicyType( const std::string& name );
+
+/**
+ * @param type of the policy
+ * @return the name of the policy
+ */
+LIVRECORE_API std::string getCachePolicyName( CachePolicyType type );
+
+}
+
+#endif // _CachePolicy_h_
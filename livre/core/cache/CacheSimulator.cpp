@@ -0,0 +1,94 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/CacheSimulator.h>
+
+#include <unordered_map>
+
+namespace livre
+{
+
+CacheSimulation::CacheSimulation()
+    : hits( 0 )
+    , misses( 0 )
+    , evictions( 0 )
+    , loadedBytes( 0 )
+{}
+
+float CacheSimulation::getHitRatio() const
+{
+    const size_t accesses = hits + misses;
+    return accesses > 0 ? float( hits ) / float( accesses ) : 0.f;
+}
+
+CacheSimulation simulateCache( const CacheAccesses& accesses,
+                               const CachePolicyType policyType,
+                               const size_t maxMemBytes )
+{
+    CacheSimulation simulation;
+    std::unique_ptr< CachePolicy > policy = CachePolicy::create( policyType );
+    std::unordered_map< CacheId, size_t > objectSizes;
+    size_t usedMemBytes = 0;
+
+    for( size_t i = 0; i < accesses.size(); ++i )
+    {
+        const CacheAccess& access = accesses[ i ];
+
+        // The objects of a frame are known when it starts
+        if( i == 0 || access.frame != accesses[ i - 1 ].frame )
+        {
+            CacheIds visibles;
+            for( size_t j = i; j < accesses.size() && accesses[ j ].frame == access.frame; ++j )
+                visibles.push_back( accesses[ j ].cacheId );
+            policy->setVisibles( visibles );
+        }
+
+        if( objectSizes.count( access.cacheId ))
+        {
+            policy->touch( access.cacheId );
+            ++simulation.hits;
+            continue;
+        }
+
+        objectSizes[ access.cacheId ] = access.size;
+        policy->insert( access.cacheId );
+        usedMemBytes += access.size;
+        simulation.loadedBytes += access.size;
+        ++simulation.misses;
+
+        // The accessed object is in use, every other one is visited at most
+        // once, as in the eviction of the cache
+        for( size_t j = policy->getCount(); j > 0 && usedMemBytes >= maxMemBytes; --j )
+        {
+            const CacheId cacheId = policy->next();
+            if( cacheId == INVALID_CACHE_ID )
+                break;
+            if( cacheId == access.cacheId )
+                continue;
+
+            usedMemBytes -= objectSizes[ cacheId ];
+            objectSizes.erase( cacheId );
+            policy->remove( cacheId );
+            ++simulation.evictions;
+        }
+    }
+    return simulation;
+}
+
+}
@@ -0,0 +1,62 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CacheSimulator_h_
+#define _CacheSimulator_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+#include <livre/core/cache/CachePolicy.h>
+#include <livre/core/cache/CacheTrace.h>
+
+namespace livre
+{
+
+/** The outcome of the replay of a cache trace, \see simulateCache */
+struct CacheSimulation
+{
+    LIVRECORE_API CacheSimulation();
+
+    /** @return the ratio of hits to all accesses, in [0,1] */
+    LIVRECORE_API float getHitRatio() const;
+
+    size_t hits; //!< Accesses served from the cache
+    size_t misses; //!< Accesses which loaded the object
+    size_t evictions; //!< Objects evicted by the cache policy
+    size_t loadedBytes; //!< Bytes of the loaded objects
+};
+
+/**
+ * Replays the accesses of a trace against a cache with another policy and
+ * maximum memory. The objects are loaded with the size they were recorded
+ * with, and are evicted as soon as the cache is full, like the unreferenced
+ * objects of a \see Cache. The visible objects of the visibility aware policy
+ * are the ones accessed in the current frame.
+ * @param accesses the recorded accesses, \see CacheTrace::read.
+ * @param policyType the eviction policy.
+ * @param maxMemBytes the maximum memory of the cache.
+ * @return the hits, misses, evictions and loaded bytes of the replay
+ */
+LIVRECORE_API CacheSimulation simulateCache( const CacheAccesses& accesses,
+                                             CachePolicyType policyType,
+                                             size_t maxMemBytes );
+
+}
+
+#endif // _CacheSimulator_h_
@@ -0,0 +1,113 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CacheSnapshot_h_
+#define _CacheSnapshot_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+
+/**
+ * Immutable view of the objects loaded in a \see Cache at a given version of
+ * the cache. The lookups do not lock and probe a flat hash table. The objects
+ * are not referenced by the snapshot, so they can still be evicted; they are
+ * then not found anymore, as with a cache miss.
+ */
+template< class CacheObjectT >
+class CacheSnapshot
+{
+public:
+
+    typedef std::shared_ptr< const CacheObjectT > ConstObjectPtr;
+    typedef std::vector< std::pair< CacheId, ConstObjectPtr >> Objects;
+
+    /**
+     * @param objects the loaded objects.
+     * @param version the version of the cache when the objects were collected.
+     */
+    CacheSnapshot( const Objects& objects, const uint64_t version )
+        : _version( version )
+        , _count( objects.size( ))
+    {
+        // Power of two capacity with a load factor below 0.5
+        size_t capacity = 16;
+        while( capacity < 2 * objects.size( ))
+            capacity <<= 1;
+        _mask = capacity - 1;
+        _entries.resize( capacity, Entry( INVALID_CACHE_ID, std::weak_ptr< const CacheObjectT >( )));
+
+        for( const auto& object: objects )
+        {
+            size_t index = getIndex( object.first );
+            while( _entries[ index ].first != INVALID_CACHE_ID )
+                index = ( index + 1 ) & _mask;
+            _entries[ index ].first = object.first;
+            _entries[ index ].second = object.second;
+        }
+    }
+
+    /**
+     * @param cacheId the id of the object.
+     * @return the object, or an empty pointer if it was not loaded at the
+     * version of the snapshot or has been evicted since.
+     */
+    ConstObjectPtr get( const CacheId& cacheId ) const
+    {
+        if( cacheId == INVALID_CACHE_ID )
+            return ConstObjectPtr();
+
+        for( size_t index = getIndex( cacheId ); ; index = ( index + 1 ) & _mask )
+        {
+            const Entry& entry = _entries[ index ];
+            if( entry.first == cacheId )
+                return entry.second.lock();
+            if( entry.first == INVALID_CACHE_ID )
+                return ConstObjectPtr();
+        }
+    }
+
+    /** @return the number of objects loaded at the version of the snapshot */
+    size_t getCount() const { return _count; }
+
+    /** @return the version of the cache when the snapshot was taken */
+    uint64_t getVersion() const { return _version; }
+
+private:
+
+    typedef std::pair< CacheId, std::weak_ptr< const CacheObjectT >> Entry;
+
+    size_t getIndex( const CacheId& cacheId ) const
+    {
+        // Node ids are bit fields, mix them before selecting the slot
+        const uint64_t hash = uint64_t( cacheId ) * 0x9E3779B97F4A7C15ull;
+        return size_t( hash >> 32 ) & _mask;
+    }
+
+    const uint64_t _version;
+    const size_t _count;
+    size_t _mask;
+    std::vector< Entry > _entries;
+};
+
+}
+
+#endif // _CacheSnapshot_h_
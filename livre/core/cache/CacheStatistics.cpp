@@ -23,17 +23,109 @@
 
 #include <lunchbox/types.h>
 
+#include <cmath>
+
 namespace livre
 {
+namespace
+{
+size_t getDelta( const size_t current, const size_t previous )
+{
+    // The counters restart from zero when the statistics are cleared
+    return current >= previous ? current - previous : current;
+}
+
+size_t getLoadTimeBucket( const std::chrono::nanoseconds loadTime )
+{
+    const double us = double( loadTime.count( )) / 1000.0;
+    if( us <= 1.0 )
+        return 0;
+    const size_t bucket = size_t( 4.0 * std::log2( us ));
+    return std::min( bucket, LOAD_TIME_BUCKETS - 1 );
+}
+}
+
+CacheStatisticsSnapshot::CacheStatisticsSnapshot()
+    : time( 0.0 )
+    , usedMemBytes( 0 )
+    , maxMemBytes( 0 )
+    , pinnedMemBytes( 0 )
+    , blockCount( 0 )
+    , hits( 0 )
+    , misses( 0 )
+    , evictions( 0 )
+    , loadedBytes( 0 )
+{
+    loadTimes.fill( 0 );
+}
+
+CacheStatisticsSnapshot
+CacheStatisticsSnapshot::operator-( const CacheStatisticsSnapshot& previous ) const
+{
+    CacheStatisticsSnapshot delta( *this );
+    delta.time = time - previous.time;
+    delta.hits = getDelta( hits, previous.hits );
+    delta.misses = getDelta( misses, previous.misses );
+    delta.evictions = getDelta( evictions, previous.evictions );
+    delta.loadedBytes = getDelta( loadedBytes, previous.loadedBytes );
+    for( size_t i = 0; i < LOAD_TIME_BUCKETS; ++i )
+        delta.loadTimes[ i ] = getDelta( loadTimes[ i ], previous.loadTimes[ i ]);
+    return delta;
+}
+
+float CacheStatisticsSnapshot::getHitRatio() const
+{
+    const size_t requests = hits + misses;
+    return requests > 0 ? float( hits ) / float( requests ) : 0.f;
+}
+
+double CacheStatisticsSnapshot::getLoadedBytesPerSecond() const
+{
+    return time > 0.0 ? double( loadedBytes ) / time : 0.0;
+}
+
+size_t CacheStatisticsSnapshot::getLoadCount() const
+{
+    size_t count = 0;
+    for( const size_t bucketCount: loadTimes )
+        count += bucketCount;
+    return count;
+}
+
+double CacheStatisticsSnapshot::getLoadTimePercentile( const float percentile ) const
+{
+    const size_t count = getLoadCount();
+    if( count == 0 )
+        return 0.0;
+
+    const double rank = std::max( 1.0, std::ceil( double( percentile ) / 100.0 * count ));
+    size_t sum = 0;
+    size_t bucket = 0;
+    for( ; bucket < LOAD_TIME_BUCKETS - 1; ++bucket )
+    {
+        sum += loadTimes[ bucket ];
+        if( double( sum ) >= rank )
+            break;
+    }
+    return std::pow( 2.0, double( bucket + 1 ) / 4.0 ) / 1000.0; // us to ms
+}
 
 CacheStatistics::CacheStatistics( const std::string& name, const size_t maxMemBytes )
     : _name( name )
     , _usedMemBytes( 0 )
     , _maxMemBytes( maxMemBytes )
+    , _pinnedMemBytes( 0 )
+    , _maxPinnedMemBytes( 0 )
     , _objCount( 0 )
     , _cacheHit( 0 )
     , _cacheMiss( 0 )
+    , _evictions( 0 )
+    , _loadedBytes( 0 )
+    , _loadTimeNs( 0 )
+    , _startTime( std::chrono::steady_clock::now( ))
 {
+    for( auto& bucketCount: _loadTimes )
+        bucketCount = 0;
 }
 
 void CacheStatistics::notifyLoaded( const CacheObject& cacheObject )
@@ -48,30 +140,96 @@ void CacheStatistics::notifyUnloaded( const CacheObject& cacheObject )
     _usedMemBytes -= cacheObject.getSize();
 }
 
+bool CacheStatistics::notifyPinned( const CacheObject& cacheObject )
+{
+    // The shards pin concurrently, the maximum is never exceeded
+    const size_t size = cacheObject.getSize();
+    size_t pinned = _pinnedMemBytes;
+    do
+    {
+        if( pinned + size > _maxPinnedMemBytes )
+            return false;
+    }
+    while( !_pinnedMemBytes.compare_exchange_weak( pinned, pinned + size ));
+
+    _usedMemBytes -= size;
+    return true;
+}
+
+void CacheStatistics::notifyUnpinned( const CacheObject& cacheObject )
+{
+    _pinnedMemBytes -= cacheObject.getSize();
+    _usedMemBytes += cacheObject.getSize();
+}
+
+void CacheStatistics::notifyLoadTime( const CacheObject& cacheObject,
+                                      const std::chrono::nanoseconds loadTime )
+{
+    _loadedBytes += cacheObject.getSize();
+    _loadTimeNs += loadTime.count();
+    ++_loadTimes[ getLoadTimeBucket( loadTime )];
+}
+
+CacheStatisticsSnapshot CacheStatistics::getSnapshot() const
+{
+    CacheStatisticsSnapshot snapshot;
+    snapshot.name = _name;
+    snapshot.time = std::chrono::duration< double >(
+                        std::chrono::steady_clock::now() - _startTime ).count();
+    snapshot.usedMemBytes = _usedMemBytes;
+    snapshot.maxMemBytes = _maxMemBytes;
+    snapshot.pinnedMemBytes = _pinnedMemBytes;
+    snapshot.blockCount = _objCount;
+    snapshot.hits = _cacheHit;
+    snapshot.misses = _cacheMiss;
+    snapshot.evictions = _evictions;
+    snapshot.loadedBytes = _loadedBytes;
+    for( size_t i = 0; i < LOAD_TIME_BUCKETS; ++i )
+        snapshot.loadTimes[ i ] = _loadTimes[ i ];
+    return snapshot;
+}
+
 void CacheStatistics::clear()
 {
     _usedMemBytes = 0;
+    _pinnedMemBytes = 0;
     _objCount = 0;
     _cacheHit = 0;
     _cacheMiss = 0;
+    _evictions = 0;
+    _loadedBytes = 0;
+    _loadTimeNs = 0;
+    for( auto& bucketCount: _loadTimes )
+        bucketCount = 0;
 }
 
 std::ostream& operator<<( std::ostream& stream, const CacheStatistics& statistics )
 {
-    const int hits = int(
-        100.f * float( statistics._cacheHit ) /
-        float( statistics._cacheHit + statistics._cacheMiss ));
+    const CacheStatisticsSnapshot snapshot = statistics.getSnapshot();
+    const int hits = int( 100.f * snapshot.getHitRatio( ));
     stream << statistics._name << std::endl;
     stream << "  Used Memory: "
            << (statistics._usedMemBytes + LB_1MB - 1) / LB_1MB << "/"
            << (statistics._maxMemBytes + LB_1MB - 1) / LB_1MB << "MB"
            << std::endl;
+    stream << "  Pinned Memory: "
+           << (statistics._pinnedMemBytes + LB_1MB - 1) / LB_1MB << "/"
+           << (statistics._maxPinnedMemBytes + LB_1MB - 1) / LB_1MB << "MB"
+           << std::endl;
     stream << "  Block Count: "
            << statistics._objCount << std::endl;
     stream << "  Cache hits: "
            << statistics._cacheHit << " (" << hits << "%)" << std::endl;
     stream << "  Cache misses: "
            << statistics._cacheMiss << std::endl;
+    stream << "  Evictions: "
+           << statistics._evictions << std::endl;
+    stream << "  Loaded: "
+           << snapshot.getLoadedBytesPerSecond() / LB_1MB << "MB/s" << std::endl;
+    stream << "  Load time p50/p95/p99: "
+           << snapshot.getLoadTimePercentile( 50.f ) << "/"
+           << snapshot.getLoadTimePercentile( 95.f ) << "/"
+           << snapshot.getLoadTimePercentile( 99.f ) << "ms" << std::endl;
 
     return stream;
 }
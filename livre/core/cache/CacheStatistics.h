@@ -24,12 +24,65 @@
 #include <livre/core/api.h>
 #include <livre/core/types.h>
 
-#define CACHE_LOG_SIZE 1000000
+#include <array>
+#include <atomic>
+#include <chrono>
 
 namespace livre
 {
+
+/** Number of logarithmic buckets of the load time histogram, 4 per octave */
+const size_t LOAD_TIME_BUCKETS = 112; // Up to 2^28 us ( ~4.5 minutes )
+
 /**
- * The CacheStatistics struct keeps the statistics of the \see Cache.
+ * The counters of a \see CacheStatistics at a given time. The difference of
+ * two snapshots gives the activity of the cache in between, i.e. during a
+ * frame.
+ */
+struct CacheStatisticsSnapshot
+{
+    LIVRECORE_API CacheStatisticsSnapshot();
+
+    /**
+     * @param previous snapshot of the same statistics, taken earlier.
+     * @return the counters since the previous snapshot. The memory usage
+     * and the block count are the current ones.
+     */
+    LIVRECORE_API CacheStatisticsSnapshot
+    operator-( const CacheStatisticsSnapshot& previous ) const;
+
+    /** @return the ratio of hits to all requests, in [0,1] */
+    LIVRECORE_API float getHitRatio() const;
+
+    /** @return the loaded bytes per second of wall time */
+    LIVRECORE_API double getLoadedBytesPerSecond() const;
+
+    /** @return the number of objects loaded */
+    LIVRECORE_API size_t getLoadCount() const;
+
+    /**
+     * @param percentile in [0,100].
+     * @return the upper bound of the load time percentile in milliseconds,
+     * or 0 if there were no loads.
+     */
+    LIVRECORE_API double getLoadTimePercentile( float percentile ) const;
+
+    std::string name; //!< Name of the cache statistics
+    double time; //!< Seconds since the statistics were created
+    size_t usedMemBytes; //!< Used memory
+    size_t maxMemBytes; //!< Maximum memory
+    size_t pinnedMemBytes; //!< Memory of the pinned objects
+    size_t blockCount; //!< Number of cached objects
+    size_t hits; //!< Requests served from the cache
+    size_t misses; //!< Requests which needed to load the object
+    size_t evictions; //!< Objects evicted by the cache policy
+    size_t loadedBytes; //!< Bytes of the loaded objects
+    std::array< size_t, LOAD_TIME_BUCKETS > loadTimes; //!< Load time histogram
+};
+
+/**
+ * The CacheStatistics struct keeps the statistics of the \see Cache. The
+ * counters are atomic, so the shards of a cache can update them concurrently.
  */
 class CacheStatistics
 {
@@ -59,11 +112,50 @@ public:
      */
     LIVRECORE_API size_t getMaximumMemory() const { return _maxMemBytes; }
 
+    /**
+     * @return Memory in bytes of the pinned objects, which is not part of the
+     * used memory.
+     */
+    LIVRECORE_API size_t getPinnedMemory() const { return _pinnedMemBytes; }
+
+    /**
+     * @return Max memory in bytes of the pinned objects.
+     */
+    LIVRECORE_API size_t getMaximumPinnedMemory() const { return _maxPinnedMemBytes; }
+
     /**
      * @return the name of the statistics
      */
     LIVRECORE_API std::string getName() const { return _name; }
 
+    /** @return Number of requests served from the cache */
+    LIVRECORE_API size_t getHits() const { return _cacheHit; }
+
+    /** @return Number of requests which needed to load the object */
+    LIVRECORE_API size_t getMisses() const { return _cacheMiss; }
+
+    /** @return Number of objects evicted by the cache policy */
+    LIVRECORE_API size_t getEvictions() const { return _evictions; }
+
+    /** @return the total construction time of the loaded objects */
+    LIVRECORE_API std::chrono::nanoseconds getLoadTime() const
+        { return std::chrono::nanoseconds( _loadTimeNs ); }
+
+    /** @return the current values of the counters */
+    LIVRECORE_API CacheStatisticsSnapshot getSnapshot() const;
+
+    /**
+     * Sets the maximum memory
+     * @param maxMemBytes maximum memory.
+     */
+    void setMaximumMemory( const size_t maxMemBytes ) { _maxMemBytes = maxMemBytes; }
+
+    /**
+     * Sets the maximum memory of the pinned objects
+     * @param maxMemBytes maximum pinned memory.
+     */
+    void setMaximumPinnedMemory( const size_t maxMemBytes ) { _maxPinnedMemBytes = maxMemBytes; }
+
     /**
      * Notifies the statistics for cache misses
      */
@@ -74,6 +166,19 @@ public:
      */
     void notifyHit() { ++_cacheHit; }
 
+    /**
+     * Notifies the statistics for objects evicted by the cache policy
+     */
+    void notifyEviction() { ++_evictions; }
+
+    /**
+     * Notifies statistics when an object is constructed.
+     * @param cacheObject is the cache object.
+     * @param loadTime is the construction time.
+     */
+    LIVRECORE_API void notifyLoadTime( const CacheObject& cacheObject,
+                                       std::chrono::nanoseconds loadTime );
+
     /**
      * Notifies statistics when an object is loaded.
      * @param cacheObject is the cache object.
@@ -86,6 +191,21 @@ public:
      */
     LIVRECORE_API void notifyUnloaded( const CacheObject& cacheObject );
 
+    /**
+     * Notifies statistics when a loaded object is pinned. Its memory moves
+     * from the used memory to the pinned memory.
+     * @param cacheObject is the cache object.
+     * @return false if the pinned memory would exceed its maximum, the object
+     * is not pinned then.
+     */
+    LIVRECORE_API bool notifyPinned( const CacheObject& cacheObject );
+
+    /**
+     * Notifies statistics when a pinned object is unpinned.
+     * @param cacheObject is the cache object.
+     */
+    LIVRECORE_API void notifyUnpinned( const CacheObject& cacheObject );
+
     /**
       * Clears the statistics
       */
@@ -102,11 +222,18 @@ public:
 private:
 
     std::string _name;
-    size_t _usedMemBytes;
-    const size_t _maxMemBytes;
-    size_t _objCount;
-    size_t _cacheHit;
-    size_t _cacheMiss;  
+    std::atomic< size_t > _usedMemBytes;
+    std::atomic< size_t > _maxMemBytes;
+    std::atomic< size_t > _pinnedMemBytes;
+    std::atomic< size_t > _maxPinnedMemBytes;
+    std::atomic< size_t > _objCount;
+    std::atomic< size_t > _cacheHit;
+    std::atomic< size_t > _cacheMiss;
+    std::atomic< size_t > _evictions;
+    std::atomic< size_t > _loadedBytes;
+    std::atomic< uint64_t > _loadTimeNs;
+    std::array< std::atomic< size_t >, LOAD_TIME_BUCKETS > _loadTimes;
+    const std::chrono::steady_clock::time_point _startTime;
 };
 
 }
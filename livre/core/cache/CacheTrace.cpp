@@ -0,0 +1,105 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/CacheTrace.h>
+
+#include <lunchbox/debug.h>
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+
+namespace livre
+{
+namespace
+{
+const std::string traceHeader = "livre-cache-trace 1";
+}
+
+struct CacheTrace::Impl
+{
+    explicit Impl( const std::string& filename )
+        : _frame( 0 )
+        , _file( filename.c_str(), std::ios::out | std::ios::trunc )
+    {
+        if( !_file )
+            LBTHROW( std::runtime_error( "Cannot create cache trace " + filename ));
+
+        // One line per access: frame, cache id, size and hit
+        _file << traceHeader << std::endl;
+    }
+
+    void notifyAccess( const CacheId& cacheId, const size_t size, const bool hit )
+    {
+        const uint32_t frame = _frame;
+        ScopedLock lock( _mutex );
+        _file << frame << " " << cacheId << " " << size << " " << hit << "\n";
+    }
+
+    std::atomic< uint32_t > _frame;
+    boost::mutex _mutex;
+    std::ofstream _file;
+};
+
+CacheTrace::CacheTrace( const std::string& filename )
+    : _impl( new CacheTrace::Impl( filename ))
+{}
+
+CacheTrace::~CacheTrace()
+{}
+
+void CacheTrace::setFrame( const uint32_t frame )
+{
+    _impl->_frame = frame;
+}
+
+uint32_t CacheTrace::getFrame() const
+{
+    return _impl->_frame;
+}
+
+void CacheTrace::notifyAccess( const CacheId& cacheId, const size_t size, const bool hit )
+{
+    _impl->notifyAccess( cacheId, size, hit );
+}
+
+CacheAccesses CacheTrace::read( const std::string& filename )
+{
+    std::ifstream file( filename.c_str( ));
+    std::string header;
+    if( !file || !std::getline( file, header ))
+        LBTHROW( std::runtime_error( "Cannot read cache trace " + filename ));
+    if( header != traceHeader )
+        LBTHROW( std::runtime_error( filename + " is not a cache trace" ));
+
+    CacheAccesses accesses;
+    std::string line;
+    while( std::getline( file, line ))
+    {
+        std::istringstream stream( line );
+        CacheAccess access;
+        if( !( stream >> access.frame >> access.cacheId >> access.size >> access.hit ))
+            LBTHROW( std::runtime_error( "Invalid access in cache trace " + filename +
+                                         ": " + line ));
+        accesses.push_back( access );
+    }
+    return accesses;
+}
+
+}
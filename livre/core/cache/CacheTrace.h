@@ -0,0 +1,92 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CacheTrace_h_
+#define _CacheTrace_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+
+/** An access to a cache object, as recorded by a \see CacheTrace */
+struct CacheAccess
+{
+    uint32_t frame; //!< The frame in which the object was requested
+    CacheId cacheId; //!< The id of the object
+    size_t size; //!< The size of the object
+    bool hit; //!< The object was in the cache
+};
+
+typedef std::vector< CacheAccess > CacheAccesses;
+
+/**
+ * Records the accesses of a \see Cache to a text file, one line per access,
+ * so they can be replayed with other policies and memory budgets, \see
+ * simulateCache. The accesses are buffered, and the file is complete once the
+ * trace is destroyed. The methods are thread safe.
+ */
+class CacheTrace
+{
+public:
+
+    /**
+     * Creates the trace file, replacing an existing one.
+     * @param filename the name of the trace file.
+     * @throw std::runtime_error if the file cannot be created
+     */
+    LIVRECORE_API explicit CacheTrace( const std::string& filename );
+
+    /** Flushes the trace file */
+    LIVRECORE_API ~CacheTrace();
+
+    /**
+     * Sets the frame of the next accesses.
+     * @param frame the current frame number.
+     */
+    LIVRECORE_API void setFrame( uint32_t frame );
+
+    /** @return the frame of the next accesses */
+    LIVRECORE_API uint32_t getFrame() const;
+
+    /**
+     * Records an access of the current frame.
+     * @param cacheId the id of the object.
+     * @param size the size of the object.
+     * @param hit the object was in the cache.
+     */
+    LIVRECORE_API void notifyAccess( const CacheId& cacheId, size_t size, bool hit );
+
+    /**
+     * @param filename the name of the trace file.
+     * @return the accesses of the trace, in recording order
+     * @throw std::runtime_error if the file cannot be read or is not a trace
+     */
+    LIVRECORE_API static CacheAccesses read( const std::string& filename );
+
+private:
+
+    struct Impl;
+    std::unique_ptr< Impl > _impl;
+};
+
+}
+
+#endif // _CacheTrace_h_
@@ -0,0 +1,496 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/DiskCache.h>
+#include <livre/core/cache/CacheObject.h>
+#include <livre/core/data/MemoryUnit.h>
+#include <livre/core/data/VolumeInformation.h>
+
+#include <lunchbox/debug.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <sstream>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace livre
+{
+namespace
+{
+const std::string indexFile = "index";
+const std::string indexHeader = "livre-disk-cache 2";
+const std::string brickExtension = ".brick";
+const std::string tmpExtension = ".tmp";
+
+// Only used for the statistics
+class BrickFile : public CacheObject
+{
+public:
+    BrickFile( const CacheId& cacheId, const size_t size )
+        : CacheObject( cacheId )
+        , _size( size )
+    {}
+
+    size_t getSize() const final { return _size; }
+
+private:
+    const size_t _size;
+};
+
+// FNV-1a, which is stable between runs and platforms
+uint64_t hash( const uint8_t* data, const size_t size )
+{
+    uint64_t hash = 14695981039346656037ull;
+    for( const uint8_t* ptr = data; ptr < data + size; ++ptr )
+    {
+        hash ^= *ptr;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t hash( const std::string& value )
+{
+    return hash( reinterpret_cast< const uint8_t* >( value.data( )), value.size( ));
+}
+
+// Precedes the data in the brick files, so the files which were not written
+// by this version, or changed since, are rejected. Its size keeps the data
+// aligned.
+struct BrickHeader
+{
+    uint64_t magic;
+    uint64_t size; // of the data
+    uint64_t checksum; // of the data
+    uint64_t reserved;
+};
+
+const uint64_t brickMagic = 0x6b63697262657669ull; // "ivebrick"
+
+// Unmaps the file when the data is not used anymore. The mapping stays valid
+// if the file is removed.
+class FileMemoryUnit : public MappedMemoryUnit
+{
+public:
+    FileMemoryUnit( const void* ptr, const size_t size )
+        : MappedMemoryUnit( static_cast< const uint8_t* >( ptr ) + sizeof( BrickHeader ),
+                            size - sizeof( BrickHeader ))
+        , _mapping( const_cast< void* >( ptr ))
+        , _mappingSize( size )
+    {}
+
+    ~FileMemoryUnit()
+    {
+        ::munmap( _mapping, _mappingSize );
+    }
+
+private:
+    void* const _mapping;
+    const size_t _mappingSize;
+};
+
+// @return the data of a brick file of the given size, empty if the file is
+// truncated or does not match its header. The checksum of the data is only
+// verified if requested, as it reads the whole file.
+ConstMemoryUnitPtr mapFile( const std::string& filename, const size_t size,
+                            const bool verify )
+{
+    if( size < sizeof( BrickHeader ))
+        return ConstMemoryUnitPtr();
+
+    const int fd = ::open( filename.c_str(), O_RDONLY );
+    if( fd == -1 )
+        return ConstMemoryUnitPtr();
+
+    // Reading beyond the end of a truncated file would crash
+    struct stat sb;
+    void* ptr = MAP_FAILED;
+    if( ::fstat( fd, &sb ) == 0 && size_t( sb.st_size ) == size )
+        ptr = ::mmap( 0, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+
+    if( ptr == MAP_FAILED )
+        return ConstMemoryUnitPtr();
+
+    const ConstMemoryUnitPtr data( new FileMemoryUnit( ptr, size ));
+    const BrickHeader& header = *static_cast< const BrickHeader* >( ptr );
+    if( header.magic != brickMagic || header.size != data->getMemSize() ||
+        ( verify && header.checksum != hash( data->getData< uint8_t >(),
+                                             data->getMemSize( ))))
+    {
+        return ConstMemoryUnitPtr();
+    }
+    return data;
+}
+
+std::string toHex( const uint64_t value )
+{
+    std::ostringstream stream;
+    stream << std::hex << std::setw( 16 ) << std::setfill( '0' ) << value;
+    return stream.str();
+}
+
+bool fromHex( const std::string& hex, uint64_t& value )
+{
+    std::istringstream stream( hex );
+    return stream >> std::hex >> value && stream.eof();
+}
+
+// @return the version of the local files of a data source, their size and
+// modification time, so the data set changes when they are rewritten. The
+// path follows the scheme of the URI, i.e. raw:///data/volume.raw.
+std::string getSourceVersion( const std::string& uri )
+{
+    const size_t schemeEnd = uri.find( "://" );
+    std::string path = schemeEnd == std::string::npos ? uri : uri.substr( schemeEnd + 3 );
+    path = path.substr( 0, path.find_first_of( "?#" ));
+
+    boost::system::error_code error;
+    if( path.empty() || !boost::filesystem::exists( path, error ))
+        return std::string();
+
+    std::ostringstream version;
+    if( boost::filesystem::is_regular_file( path, error ))
+        version << boost::filesystem::file_size( path, error );
+    version << " " << boost::filesystem::last_write_time( path, error );
+    return version.str();
+}
+}
+
+struct DiskCache::Impl
+{
+    typedef std::list< CacheId > IdList;
+
+    struct Entry
+    {
+        size_t size;
+        IdList::iterator position;
+        bool verified; // Written or checksummed by this process
+    };
+
+    Impl( const std::string& directory, const std::string& datasetId,
+          const size_t maxDiskBytes )
+        : _directory(( boost::filesystem::path( directory ) / datasetId ).string( ))
+        , _statistics( "Disk Cache", maxDiskBytes )
+    {
+        boost::system::error_code error;
+        boost::filesystem::create_directories( _directory, error );
+        if( error || !boost::filesystem::is_directory( _directory ))
+            LBTHROW( std::runtime_error( "Cannot create disk cache directory " +
+                                         _directory ));
+        open();
+    }
+
+    ~Impl()
+    {
+        writeIndex();
+    }
+
+    std::string getFilename( const CacheId& cacheId ) const
+    {
+        return ( boost::filesystem::path( _directory ) /
+                 ( toHex( cacheId ) + brickExtension )).string();
+    }
+
+    std::string getIndexFilename() const
+    {
+        return ( boost::filesystem::path( _directory ) / indexFile ).string();
+    }
+
+    // Reads the ids of the index in least recently used order and removes the
+    // index, so it is rebuilt if the process does not exit cleanly
+    CacheIds readIndex() const
+    {
+        CacheIds cacheIds;
+        {
+            std::ifstream stream( getIndexFilename( ));
+            std::string line;
+            if( !std::getline( stream, line ) || line != indexHeader )
+                return cacheIds;
+
+            CacheId cacheId;
+            while( std::getline( stream, line ))
+                if( fromHex( line, cacheId ))
+                    cacheIds.push_back( cacheId );
+        }
+
+        boost::system::error_code error;
+        boost::filesystem::remove( getIndexFilename(), error );
+        return cacheIds;
+    }
+
+    void open()
+    {
+        struct FileInfo
+        {
+            size_t size;
+            std::time_t time;
+        };
+
+        std::unordered_map< CacheId, FileInfo > files;
+        boost::system::error_code error;
+        for( boost::filesystem::directory_iterator it( _directory, error ), end;
+             it != end; it.increment( error ))
+        {
+            const boost::filesystem::path& path = it->path();
+            if( path.extension() == tmpExtension ) // Interrupted write
+            {
+                boost::filesystem::remove( path, error );
+                continue;
+            }
+
+            CacheId cacheId;
+            if( path.extension() != brickExtension ||
+                !fromHex( path.stem().string(), cacheId ))
+            {
+                continue;
+            }
+
+            const size_t size = boost::filesystem::file_size( path, error );
+            if( error || size == 0 )
+                continue;
+            files[ cacheId ] = { size, boost::filesystem::last_write_time( path, error )};
+        }
+
+        // The files which are not in the index are the least recently used
+        // ones, in the order they were written
+        const CacheIds indexed = readIndex();
+        const std::unordered_set< CacheId > indexedSet( indexed.begin(), indexed.end( ));
+        std::vector< std::pair< std::time_t, CacheId >> unindexed;
+        for( const auto& file: files )
+            if( indexedSet.count( file.first ) == 0 )
+                unindexed.push_back( std::make_pair( file.second.time, file.first ));
+        std::sort( unindexed.begin(), unindexed.end( ));
+
+        ScopedLock lock( _mutex );
+        for( const auto& file: unindexed )
+            insert( file.second, files[ file.second ].size, false );
+        for( const CacheId& cacheId: indexed )
+        {
+            const auto it = files.find( cacheId );
+            if( it != files.end() && _entries.count( cacheId ) == 0 )
+                insert( cacheId, it->second.size, false );
+        }
+        evict();
+    }
+
+    void writeIndex() const
+    {
+        const std::string filename = getIndexFilename();
+        {
+            std::ofstream stream( filename + tmpExtension );
+            stream << indexHeader << std::endl;
+            ScopedLock lock( _mutex );
+            for( const CacheId& cacheId: _lru )
+                stream << toHex( cacheId ) << std::endl;
+        }
+
+        boost::system::error_code error;
+        boost::filesystem::rename( filename + tmpExtension, filename, error );
+        if( error )
+            LBWARN << "Cannot write disk cache index " << filename << std::endl;
+    }
+
+    // The mutex has to be locked
+    void insert( const CacheId& cacheId, const size_t size, const bool verified )
+    {
+        _entries[ cacheId ] = { size, _lru.insert( _lru.end(), cacheId ), verified };
+        _statistics.notifyLoaded( BrickFile( cacheId, size ));
+    }
+
+    // The mutex has to be locked
+    void remove( const CacheId& cacheId )
+    {
+        const auto it = _entries.find( cacheId );
+        if( it == _entries.end( ))
+            return;
+
+        _statistics.notifyUnloaded( BrickFile( cacheId, it->second.size ));
+        _lru.erase( it->second.position );
+        _entries.erase( it );
+
+        boost::system::error_code error;
+        boost::filesystem::remove( getFilename( cacheId ), error );
+    }
+
+    // The mutex has to be locked
+    void evict()
+    {
+        while( !_lru.empty() &&
+               _statistics.getUsedMemory() > _statistics.getMaximumMemory( ))
+        {
+            remove( _lru.front( ));
+            _statistics.notifyEviction();
+        }
+    }
+
+    ConstMemoryUnitPtr load( const CacheId& cacheId )
+    {
+        size_t size = 0;
+        bool verified = false;
+        {
+            ScopedLock lock( _mutex );
+            const auto it = _entries.find( cacheId );
+            if( it != _entries.end( ))
+            {
+                _lru.splice( _lru.end(), _lru, it->second.position );
+                size = it->second.size;
+                verified = it->second.verified;
+            }
+        }
+
+        // The file can be evicted meanwhile, which fails the mapping. The
+        // files of the previous processes are checksummed on their first
+        // load, as they may have been left damaged by a crash.
+        const ConstMemoryUnitPtr data = size > 0 ? mapFile( getFilename( cacheId ), size,
+                                                            !verified )
+                                                 : ConstMemoryUnitPtr();
+        if( !data )
+        {
+            if( size > 0 ) // Removed, corrupted or changed by another process
+            {
+                ScopedLock lock( _mutex );
+                remove( cacheId );
+            }
+            _statistics.notifyMiss();
+            return data;
+        }
+
+        if( !verified )
+        {
+            ScopedLock lock( _mutex );
+            const auto it = _entries.find( cacheId );
+            if( it != _entries.end( ))
+                it->second.verified = true;
+        }
+        _statistics.notifyHit();
+        return data;
+    }
+
+    bool store( const CacheId& cacheId, const MemoryUnit& data )
+    {
+        const size_t size = data.getMemSize();
+        if( size == 0 || size + sizeof( BrickHeader ) > _statistics.getMaximumMemory( ))
+            return false;
+
+        {
+            ScopedLock lock( _mutex );
+            if( _entries.count( cacheId ) > 0 || !_writing.insert( cacheId ).second )
+                return true; // Stored or being stored by another thread
+        }
+
+        // The file is renamed after it is written, so a crash does not leave
+        // partially written files
+        const auto startTime = std::chrono::steady_clock::now();
+        const std::string filename = getFilename( cacheId );
+        const BrickHeader header = { brickMagic, size, hash( data.getData< uint8_t >(), size ), 0 };
+        bool written = false;
+        {
+            std::ofstream stream( filename + tmpExtension, std::ios::binary );
+            stream.write( reinterpret_cast< const char* >( &header ), sizeof( header ));
+            stream.write( data.getData< char >(), size );
+            stream.close();
+            written = stream.good();
+        }
+        boost::system::error_code error;
+        if( written )
+            boost::filesystem::rename( filename + tmpExtension, filename, error );
+        if( !written || error )
+        {
+            boost::filesystem::remove( filename + tmpExtension, error );
+            ScopedLock lock( _mutex );
+            _writing.erase( cacheId );
+            return false;
+        }
+
+        const BrickFile brick( cacheId, size );
+        _statistics.notifyLoadTime( brick, std::chrono::steady_clock::now() - startTime );
+
+        ScopedLock lock( _mutex );
+        _writing.erase( cacheId );
+        insert( cacheId, size + sizeof( header ), true );
+        evict();
+        return true;
+    }
+
+    const std::string _directory;
+    IdList _lru;
+    std::unordered_map< CacheId, Entry > _entries;
+    std::unordered_set< CacheId > _writing;
+    mutable boost::mutex _mutex;
+    CacheStatistics _statistics;
+};
+
+DiskCache::DiskCache( const std::string& directory,
+                      const std::string& datasetId,
+                      const size_t maxDiskBytes )
+    : _impl( new DiskCache::Impl( directory, datasetId, maxDiskBytes ))
+{}
+
+DiskCache::~DiskCache()
+{}
+
+ConstMemoryUnitPtr DiskCache::load( const CacheId& cacheId )
+{
+    return _impl->load( cacheId );
+}
+
+bool DiskCache::store( const CacheId& cacheId, const MemoryUnit& data )
+{
+    return _impl->store( cacheId, data );
+}
+
+size_t DiskCache::getCount() const
+{
+    ScopedLock lock( _impl->_mutex );
+    return _impl->_entries.size();
+}
+
+const CacheStatistics& DiskCache::getStatistics() const
+{
+    return _impl->_statistics;
+}
+
+std::string DiskCache::getDirectory() const
+{
+    return _impl->_directory;
+}
+
+std::string DiskCache::getDatasetId( const std::string& uri,
+                                     const VolumeInformation& volumeInfo )
+{
+    // The blocks change with the layout of the volume and with its files
+    std::ostringstream description;
+    description << uri << " " << volumeInfo.voxels << " "
+                << volumeInfo.maximumBlockSize << " " << volumeInfo.overlap << " "
+                << volumeInfo.dataType << " " << volumeInfo.compCount << " "
+                << volumeInfo.bigEndian << " " << getSourceVersion( uri );
+    return toHex( hash( description.str( )));
+}
+
+}
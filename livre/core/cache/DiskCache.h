@@ -0,0 +1,108 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _DiskCache_h_
+#define _DiskCache_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+#include <livre/core/cache/CacheStatistics.h>
+
+namespace livre
+{
+
+/**
+ * Keeps data blocks in files on a local disk, so they are not read from a
+ * slow data source again, also after a restart. Every block is a file which
+ * is memory mapped when it is loaded. The file starts with a 32 bytes header
+ * with the length and the checksum of the block, the files which do not
+ * match it are removed when they are loaded. The length is checked on every
+ * load, the checksum only on the first load of the files written by a
+ * previous process. The least recently used files are removed when the cache
+ * is full.
+ *
+ * The files of a data set are in a directory named after the data set id.
+ * The index of the files in least recently used order is written to this
+ * directory when the cache is destroyed. It is removed while the cache is
+ * open, so if the process crashes, the index is rebuilt from the files.
+ *
+ * A directory can only be used by one process at a time.
+ */
+class DiskCache
+{
+public:
+
+    /**
+     * Opens the cache, creating its directory if needed. The files are read
+     * from the index, or from the directory if there is no index.
+     * @param directory the cache directory, i.e. on a local disk.
+     * @param datasetId the identity of the data set, \see getDatasetId.
+     * @param maxDiskBytes maximum size of the files.
+     * @throw std::runtime_error if the directory cannot be created
+     */
+    LIVRECORE_API DiskCache( const std::string& directory,
+                             const std::string& datasetId,
+                             size_t maxDiskBytes );
+
+    /** Writes the index */
+    LIVRECORE_API ~DiskCache();
+
+    /**
+     * @param cacheId the id of the data block.
+     * @return the memory mapped data block, or an empty pointer if it is not
+     * in the cache.
+     */
+    LIVRECORE_API ConstMemoryUnitPtr load( const CacheId& cacheId );
+
+    /**
+     * Writes a data block, if it is not already in the cache.
+     * @param cacheId the id of the data block.
+     * @param data the data of the block.
+     * @return false if the block could not be written
+     */
+    LIVRECORE_API bool store( const CacheId& cacheId, const MemoryUnit& data );
+
+    /** @return the number of data blocks in the cache */
+    LIVRECORE_API size_t getCount() const;
+
+    /** @return the statistics, the memory is the size of the files */
+    LIVRECORE_API const CacheStatistics& getStatistics() const;
+
+    /** @return the directory of the data set */
+    LIVRECORE_API std::string getDirectory() const;
+
+    /**
+     * @param uri the URI of the data source.
+     * @param volumeInfo the volume information of the data source.
+     * @return the identity of a data set, which changes with the URI, the
+     * size and modification time of its local file or directory, and the
+     * layout of the data blocks.
+     */
+    LIVRECORE_API static std::string getDatasetId( const std::string& uri,
+                                                   const VolumeInformation& volumeInfo );
+
+private:
+
+    struct Impl;
+    std::unique_ptr< Impl > _impl;
+};
+
+}
+
+#endif // _DiskCache_h_
@@ -0,0 +1,371 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/MemoryBudget.h>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace livre
+{
+namespace
+{
+const std::string cgroupRoot = "/sys/fs/cgroup";
+const std::string meminfoFile = "/proc/meminfo";
+
+// @return false if the file does not exist or has no number ( i.e. "max" )
+bool readValue( const std::string& file, size_t& value )
+{
+    std::ifstream stream( file );
+    return stream && ( stream >> value );
+}
+
+// Reads the "key value" lines of memory.stat and /proc/meminfo
+size_t readKey( const std::string& file, const std::string& key )
+{
+    std::ifstream stream( file );
+    std::string line;
+    while( std::getline( stream, line ))
+    {
+        std::istringstream lineStream( line );
+        std::string name;
+        size_t value = 0;
+        if( lineStream >> name >> value && ( name == key || name == key + ":" ))
+            return value;
+    }
+    return 0;
+}
+}
+
+MemoryInfo::MemoryInfo()
+    : limit( 0 )
+    , used( 0 )
+    , available( 0 )
+{}
+
+CacheShare::CacheShare( const size_t weight_, const double missCost_,
+                        const size_t minMemBytes_, const size_t maxMemBytes_ )
+    : weight( weight_ )
+    , missCost( missCost_ )
+    , minMemBytes( minMemBytes_ )
+    , maxMemBytes( std::max( minMemBytes_, maxMemBytes_ ))
+{}
+
+MemoryInfo readMemoryInfo( const std::string& cgroupDir, const std::string& meminfo )
+{
+    const size_t total = readKey( meminfo, "MemTotal" ) * 1024; // kB
+    const size_t systemAvailable = readKey( meminfo, "MemAvailable" ) * 1024;
+
+    MemoryInfo info;
+    size_t limit = 0;
+    size_t current = 0;
+    if( !cgroupDir.empty() &&
+        readValue( cgroupDir + "/memory.max", limit ) &&
+        readValue( cgroupDir + "/memory.current", current ))
+    {
+        // The inactive page cache is reclaimed before the OOM killer runs
+        const size_t inactiveFile = readKey( cgroupDir + "/memory.stat", "inactive_file" );
+        info.limit = limit;
+        info.used = current > inactiveFile ? current - inactiveFile : 0;
+        info.available = info.used < limit ? limit - info.used : 0;
+        if( total > 0 )
+            info.available = std::min( info.available, systemAvailable );
+        return info;
+    }
+
+    info.limit = total;
+    info.used = total > systemAvailable ? total - systemAvailable : 0;
+    info.available = systemAvailable;
+    return info;
+}
+
+std::string getCgroupDir()
+{
+    // cgroup v2 has a single hierarchy, listed as "0::/path"
+    std::ifstream stream( "/proc/self/cgroup" );
+    std::string line;
+    while( std::getline( stream, line ))
+    {
+        if( line.compare( 0, 3, "0::" ) == 0 )
+            return cgroupRoot + line.substr( 3 );
+    }
+    return std::string();
+}
+
+struct MemoryBudget::Impl
+{
+    struct CacheEntry
+    {
+        const void* cache;
+        CacheShare share;
+        std::function< size_t() > getUsedMemory;
+        std::function< std::chrono::nanoseconds() > getLoadTime;
+        std::function< void( size_t ) > setMaximumMemory;
+        std::function< void() > evict;
+        std::chrono::nanoseconds previousLoadTime;
+        size_t maxMemBytes; // The current share
+    };
+
+    Impl( MemoryBudget& budget, const uint32_t periodMs )
+        : _budget( budget )
+        , _cgroupDir( getCgroupDir( ))
+        , _cachesChanged( false )
+        , _currentBudget( 0 )
+        , _periodMs( periodMs )
+        , _stop( false )
+        , _thread( boost::bind( &Impl::run, this ))
+    {}
+
+    ~Impl()
+    {
+        {
+            ScopedLock lock( _mutex );
+            _stop = true;
+        }
+        _condition.notify_one();
+        _thread.join();
+    }
+
+    void run()
+    {
+        ScopedLock lock( _mutex );
+        while( !_stop )
+        {
+            lock.unlock();
+            update();
+            lock.lock();
+            if( !_stop )
+                _condition.timed_wait( lock, boost::posix_time::milliseconds( _periodMs ));
+        }
+    }
+
+    // Shares the budget again when the caches, their misses or the budget
+    // changed, and evicts from the caches which shrank or loaded objects
+    void update()
+    {
+        ScopedLock lock( _cachesMutex );
+        if( _caches.empty( ))
+            return;
+
+        bool changed = _cachesChanged;
+        _cachesChanged = false;
+
+        std::vector< std::chrono::nanoseconds > costs;
+        costs.reserve( _caches.size( ));
+        for( CacheEntry& cache: _caches )
+        {
+            // The statistics restart from zero when they are cleared
+            const std::chrono::nanoseconds loadTime = cache.getLoadTime();
+            costs.push_back( loadTime >= cache.previousLoadTime ?
+                             loadTime - cache.previousLoadTime : loadTime );
+            cache.previousLoadTime = loadTime;
+            changed = changed || costs.back().count() > 0;
+        }
+
+        // A fixed budget does not need the memory information. Without memory
+        // information the budget is the maximum memory.
+        size_t budget = _budget._maxMemBytes;
+        if( _budget._minMemBytes < _budget._maxMemBytes )
+        {
+            const MemoryInfo info = readMemoryInfo( _cgroupDir, meminfoFile );
+            if( info.limit > 0 )
+            {
+                size_t usedCacheBytes = 0;
+                for( const CacheEntry& cache: _caches )
+                    usedCacheBytes += cache.getUsedMemory();
+                budget = _budget.computeBudget( info, usedCacheBytes );
+            }
+        }
+        changed = changed || budget != _currentBudget;
+        _currentBudget = budget;
+        if( !changed )
+            return;
+
+        std::vector< CacheShare > shares;
+        shares.reserve( _caches.size( ));
+        for( size_t i = 0; i < _caches.size(); ++i )
+        {
+            CacheShare& share = _caches[ i ].share;
+            share.missCost = 0.5 * share.missCost + 0.5 * double( costs[ i ].count( ));
+            shares.push_back( share );
+        }
+
+        const std::vector< size_t >& maxMemBytes = _budget.computeShares( budget, shares );
+        for( size_t i = 0; i < _caches.size(); ++i )
+        {
+            CacheEntry& cache = _caches[ i ];
+            const bool shrank = maxMemBytes[ i ] < cache.maxMemBytes;
+            cache.maxMemBytes = maxMemBytes[ i ];
+            cache.setMaximumMemory( cache.maxMemBytes );
+            if( shrank || costs[ i ].count() > 0 )
+                cache.evict();
+        }
+    }
+
+    MemoryBudget& _budget;
+    const std::string _cgroupDir;
+    std::vector< CacheEntry > _caches;
+    boost::mutex _cachesMutex;
+    bool _cachesChanged;
+    std::atomic< size_t > _currentBudget;
+    const uint32_t _periodMs;
+    bool _stop;
+    boost::mutex _mutex;
+    boost::condition_variable _condition;
+    boost::thread _thread;
+};
+
+MemoryBudget::MemoryBudget( const size_t minMemBytes,
+                            const size_t maxMemBytes,
+                            const float reserveRatio,
+                            const uint32_t periodMs,
+                            const float lendRatio )
+    : _minMemBytes( minMemBytes )
+    , _maxMemBytes( std::max( minMemBytes, maxMemBytes ))
+    , _reserveRatio( reserveRatio )
+    , _lendRatio( std::min( std::max( lendRatio, 0.0f ), 1.0f ))
+    , _impl( new MemoryBudget::Impl( *this, periodMs ))
+{}
+
+MemoryBudget::~MemoryBudget()
+{}
+
+size_t MemoryBudget::computeBudget( const MemoryInfo& info,
+                                    const size_t usedCacheBytes ) const
+{
+    // The caches can use their current memory and the available one, except
+    // the reserve
+    const size_t reserve = size_t( _reserveRatio * double( info.limit ));
+    const size_t usable = usedCacheBytes + info.available;
+    const size_t budget = usable > reserve ? usable - reserve : 0;
+    return std::min( std::max( budget, _minMemBytes ), _maxMemBytes );
+}
+
+std::vector< size_t > MemoryBudget::computeShares( const size_t budget,
+                                                   const std::vector< CacheShare >& caches ) const
+{
+    double totalWeight = 0.0;
+    double totalCost = 0.0;
+    for( const CacheShare& cache: caches )
+    {
+        totalWeight += double( cache.weight );
+        totalCost += cache.missCost;
+    }
+
+    const double lent = _lendRatio * double( budget );
+    const double guaranteed = double( budget ) - lent;
+    std::vector< double > unbounded;
+    unbounded.reserve( caches.size( ));
+    for( const CacheShare& cache: caches )
+    {
+        const double weight = totalWeight > 0.0 ? double( cache.weight ) / totalWeight
+                                                : 1.0 / double( caches.size( ));
+        const double cost = totalCost > 0.0 ? cache.missCost / totalCost : weight;
+        unbounded.push_back( weight * guaranteed + cost * lent );
+    }
+
+    // The caches outside of their quotas are bounded, the remaining budget is
+    // shared again by the others until all are within their quotas
+    std::vector< double > shares( caches.size( ));
+    std::vector< bool > bounded( caches.size(), false );
+    for( size_t pass = 0; pass <= caches.size(); ++pass )
+    {
+        double remaining = double( budget );
+        double unboundedSum = 0.0;
+        size_t nUnbounded = 0;
+        for( size_t i = 0; i < caches.size(); ++i )
+        {
+            if( bounded[ i ])
+                remaining -= shares[ i ];
+            else
+            {
+                unboundedSum += unbounded[ i ];
+                ++nUnbounded;
+            }
+        }
+
+        bool changed = false;
+        for( size_t i = 0; i < caches.size(); ++i )
+        {
+            if( bounded[ i ])
+                continue;
+
+            shares[ i ] = unboundedSum > 0.0 ? remaining * unbounded[ i ] / unboundedSum
+                                             : remaining / double( nUnbounded );
+            if( shares[ i ] < double( caches[ i ].minMemBytes ))
+                shares[ i ] = double( caches[ i ].minMemBytes );
+            else if( shares[ i ] > double( caches[ i ].maxMemBytes ))
+                shares[ i ] = double( caches[ i ].maxMemBytes );
+            else
+                continue;
+
+            bounded[ i ] = true;
+            changed = true;
+        }
+
+        if( !changed )
+            break;
+    }
+
+    std::vector< size_t > maxMemBytes;
+    maxMemBytes.reserve( caches.size( ));
+    for( const double share: shares )
+        maxMemBytes.push_back( size_t( std::max( share, 0.0 )));
+    return maxMemBytes;
+}
+
+void MemoryBudget::update()
+{
+    _impl->update();
+}
+
+size_t MemoryBudget::getBudget() const
+{
+    return _impl->_currentBudget;
+}
+
+void MemoryBudget::_addCache( const void* cache,
+                              const CacheShare& share,
+                              const std::function< size_t() >& getUsedMemory,
+                              const std::function< std::chrono::nanoseconds() >& getLoadTime,
+                              const std::function< void( size_t ) >& setMaximumMemory,
+                              const std::function< void() >& evict )
+{
+    ScopedLock lock( _impl->_cachesMutex );
+    _impl->_caches.push_back( { cache, share, getUsedMemory, getLoadTime,
+                                setMaximumMemory, evict, getLoadTime(), share.weight });
+    _impl->_cachesChanged = true;
+}
+
+void MemoryBudget::_removeCache( const void* cache )
+{
+    ScopedLock lock( _impl->_cachesMutex );
+    std::vector< Impl::CacheEntry >& caches = _impl->_caches;
+    caches.erase( std::remove_if( caches.begin(), caches.end(),
+                                  [cache]( const Impl::CacheEntry& entry )
+                                      { return entry.cache == cache; }),
+                  caches.end( ));
+    _impl->_cachesChanged = true;
+}
+
+}
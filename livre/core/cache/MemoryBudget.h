@@ -0,0 +1,185 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _MemoryBudget_h_
+#define _MemoryBudget_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+#include <livre/core/cache/Cache.h>
+
+#include <limits>
+
+namespace livre
+{
+
+/** The memory available to the process */
+struct MemoryInfo
+{
+    LIVRECORE_API MemoryInfo();
+
+    size_t limit; //!< cgroup memory.max, or the total system memory
+    size_t used; //!< cgroup memory.current, or the used system memory
+    size_t available; //!< Memory which can still be allocated
+};
+
+/**
+ * Reads the memory information of the cgroup ( v2 ) of the process and of the
+ * system. If there is no cgroup memory limit, only the system memory is used.
+ * @param cgroupDir the cgroup directory with memory.max and memory.current.
+ * @param meminfoFile the system memory information, i.e. /proc/meminfo.
+ * @return the memory information
+ */
+LIVRECORE_API MemoryInfo readMemoryInfo( const std::string& cgroupDir,
+                                         const std::string& meminfoFile );
+
+/** @return the cgroup v2 directory of the process, or empty if there is none */
+LIVRECORE_API std::string getCgroupDir();
+
+/** The state of a cache in the \see MemoryBudget */
+struct CacheShare
+{
+    LIVRECORE_API CacheShare( size_t weight, double missCost,
+                              size_t minMemBytes = 0,
+                              size_t maxMemBytes = std::numeric_limits< size_t >::max( ));
+
+    size_t weight; //!< Maximum memory of the cache when it was added
+    double missCost; //!< Recent load time of the cache
+    size_t minMemBytes; //!< The share is not reduced below ( quota )
+    size_t maxMemBytes; //!< The share is not increased above ( quota )
+};
+
+/**
+ * Arbitrates one memory budget between caches and adapts it to the memory
+ * available to the process. A background thread periodically computes the
+ * budget of the caches from the memory information, shares it between the
+ * caches and evicts the objects above the cache watermarks. A fixed budget,
+ * where the minimum and maximum memory are equal, does not read the memory
+ * information, and the budget is only shared again when the caches, their
+ * misses or the budget changed.
+ *
+ * Every cache is guaranteed a part of the budget proportional to its maximum
+ * memory when it was added. The rest of the budget is lent to the caches
+ * proportionally to their miss cost, the time spent loading objects, and
+ * reclaimed when the misses move to other caches. The share of a cache can be
+ * bounded by quotas, i.e. for the caches of several data sets.
+ */
+class MemoryBudget
+{
+public:
+
+    /**
+     * Starts the background thread.
+     * @param minMemBytes the budget of the caches is not reduced below.
+     * @param maxMemBytes the budget of the caches is not increased above.
+     * @param reserveRatio fraction of the memory limit which is kept free for
+     * the other allocations of the process and the system.
+     * @param periodMs update period in milliseconds.
+     * @param lendRatio fraction of the budget which is lent to the caches
+     * according to their miss cost.
+     */
+    LIVRECORE_API MemoryBudget( size_t minMemBytes,
+                                size_t maxMemBytes,
+                                float reserveRatio = 0.1f,
+                                uint32_t periodMs = 100,
+                                float lendRatio = 0.5f );
+
+    /** Stops the background thread */
+    LIVRECORE_API ~MemoryBudget();
+
+    /**
+     * Adds a cache to the budget. The maximum memory of the cache sets its
+     * guaranteed share of the budget. The cache has to outlive the budget or
+     * be removed before it is destroyed.
+     * @param cache the cache
+     * @param minMemBytes the share of the cache is not reduced below, even if
+     * the quotas of all caches exceed the budget.
+     * @param maxMemBytes the share of the cache is not increased above.
+     */
+    template< class CacheObjectT >
+    void addCache( Cache< CacheObjectT >& cache,
+                   const size_t minMemBytes = 0,
+                   const size_t maxMemBytes = std::numeric_limits< size_t >::max( ))
+    {
+        const CacheStatistics& statistics = cache.getStatistics();
+        _addCache( &cache, CacheShare( statistics.getMaximumMemory(), 0.0,
+                                       minMemBytes, maxMemBytes ),
+                   [&statistics]() { return statistics.getUsedMemory(); },
+                   [&statistics]() { return statistics.getLoadTime(); },
+                   [&cache]( const size_t bytes ) { cache.setMaximumMemory( bytes ); },
+                   [&cache]() { cache.evict(); });
+    }
+
+    /**
+     * Removes a cache from the budget, its share goes to the other caches.
+     * @param cache the cache
+     */
+    template< class CacheObjectT >
+    void removeCache( const Cache< CacheObjectT >& cache )
+    {
+        _removeCache( &cache );
+    }
+
+    /**
+     * @param info the memory information.
+     * @param usedCacheBytes the memory used by the caches.
+     * @return the budget of the caches, between the minimum and maximum memory.
+     */
+    LIVRECORE_API size_t computeBudget( const MemoryInfo& info,
+                                        size_t usedCacheBytes ) const;
+
+    /**
+     * @param budget the budget of the caches.
+     * @param caches the weights, miss costs and quotas of the caches.
+     * @return the maximum memory of the caches: the guaranteed part
+     * proportional to their weight, and the lent part proportional to their
+     * miss cost ( to their weight if there are no misses ), within their
+     * quotas. The memory above the maximum quota of a cache goes to the others.
+     */
+    LIVRECORE_API std::vector< size_t > computeShares( size_t budget,
+                                                       const std::vector< CacheShare >& caches ) const;
+
+    /** Updates the maximum memory of the caches and evicts. */
+    LIVRECORE_API void update();
+
+    /** @return the current budget of the caches */
+    LIVRECORE_API size_t getBudget() const;
+
+private:
+
+    LIVRECORE_API void _addCache( const void* cache,
+                                  const CacheShare& share,
+                                  const std::function< size_t() >& getUsedMemory,
+                                  const std::function< std::chrono::nanoseconds() >& getLoadTime,
+                                  const std::function< void( size_t ) >& setMaximumMemory,
+                                  const std::function< void() >& evict );
+    LIVRECORE_API void _removeCache( const void* cache );
+
+    const size_t _minMemBytes;
+    const size_t _maxMemBytes;
+    const float _reserveRatio;
+    const float _lendRatio;
+
+    struct Impl;
+    std::unique_ptr< Impl > _impl;
+};
+
+}
+
+#endif // _MemoryBudget_h_
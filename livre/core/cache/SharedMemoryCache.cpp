@@ -0,0 +1,440 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/SharedMemoryCache.h>
+#include <livre/core/cache/CacheObject.h>
+#include <livre/core/data/MemoryUnit.h>
+
+#include <lunchbox/debug.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert( ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+               "The shared memory index needs lock-free atomics" );
+
+namespace livre
+{
+namespace
+{
+const uint64_t segmentMagic = 0x6c69767265736d31ull; // "livresm1"
+const size_t alignment = 64; // Cache line
+const size_t maxProbes = 16;
+const auto openTimeout = std::chrono::seconds( 1 );
+
+// The state of a slot is the number of references plus one when it has a block
+const uint32_t EMPTY = 0;
+const uint32_t READY = 1;
+const uint32_t WRITING = std::numeric_limits< uint32_t >::max();
+
+struct Header
+{
+    std::atomic< uint64_t > magic; // Set once the segment is initialized
+    uint64_t slotSize;
+    uint64_t nSlots;
+    std::atomic< uint64_t > clock;
+};
+
+struct Slot
+{
+    std::atomic< uint32_t > state;
+    std::atomic< uint64_t > cacheId;
+    std::atomic< uint64_t > size;
+    std::atomic< uint64_t > lastUse;
+};
+
+size_t align( const size_t size )
+{
+    return ( size + alignment - 1 ) / alignment * alignment;
+}
+
+size_t getSlotsOffset()
+{
+    return align( sizeof( Header ));
+}
+
+size_t getDataOffset( const size_t nSlots )
+{
+    return align( getSlotsOffset() + nSlots * sizeof( Slot ));
+}
+
+std::string getSegmentName( const std::string& datasetId )
+{
+    return "/livre-" + datasetId;
+}
+
+// Only used for the statistics
+class SharedBlock : public CacheObject
+{
+public:
+    SharedBlock( const CacheId& cacheId, const size_t size )
+        : CacheObject( cacheId )
+        , _size( size )
+    {}
+
+    size_t getSize() const final { return _size; }
+
+private:
+    const size_t _size;
+};
+
+// The mapping of the segment, which is unmapped when the cache and all the
+// blocks loaded from it are destroyed
+class Segment
+{
+public:
+    Segment( void* ptr, const size_t size )
+        : _ptr( static_cast< uint8_t* >( ptr ))
+        , _size( size )
+    {}
+
+    ~Segment()
+    {
+        ::munmap( _ptr, _size );
+    }
+
+    uint8_t* getPtr() const { return _ptr; }
+
+private:
+    uint8_t* const _ptr;
+    const size_t _size;
+};
+
+typedef std::shared_ptr< Segment > SegmentPtr;
+
+// Releases the reference to the slot when the data is not used anymore. The
+// slot is accounted as allocated, so the objects holding it are evicted by
+// their caches and release it.
+class SharedMemoryUnit : public ConstMemoryUnit
+{
+public:
+    SharedMemoryUnit( const SegmentPtr& segment, Slot& slot,
+                      const uint8_t* ptr, const size_t size, const size_t slotSize )
+        : ConstMemoryUnit( ptr, size )
+        , _segment( segment )
+        , _slot( slot )
+        , _slotSize( slotSize )
+    {}
+
+    ~SharedMemoryUnit()
+    {
+        _slot.state.fetch_sub( 1, std::memory_order_release );
+    }
+
+    size_t getAllocSize() const final { return _slotSize; }
+
+private:
+    const SegmentPtr _segment;
+    Slot& _slot;
+    const size_t _slotSize;
+};
+
+// Adds a reference to a slot which has a block
+bool acquire( Slot& slot )
+{
+    uint32_t state = slot.state.load( std::memory_order_acquire );
+    while( state != EMPTY && state != WRITING && state != WRITING - 1 )
+    {
+        if( slot.state.compare_exchange_weak( state, state + 1,
+                                              std::memory_order_acquire ))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Waits for the process which created the segment to size it
+bool waitForSize( const int fd, const size_t size )
+{
+    const auto deadline = std::chrono::steady_clock::now() + openTimeout;
+    struct stat sb;
+    while( ::fstat( fd, &sb ) == 0 )
+    {
+        if( size_t( sb.st_size ) == size )
+            return true;
+        if( sb.st_size != 0 || std::chrono::steady_clock::now() > deadline )
+            return false;
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ));
+    }
+    return false;
+}
+}
+
+struct SharedMemoryCache::Impl
+{
+    Impl( const std::string& datasetId, const size_t slotSize,
+          const size_t maxMemBytes )
+        : _name( getSegmentName( datasetId ))
+        , _slotSize( align( slotSize ))
+        , _nSlots( slotSize > 0 ? maxMemBytes / _slotSize : 0 )
+        , _statistics( "Shared Memory Cache", maxMemBytes )
+    {
+        if( _nSlots == 0 )
+            LBTHROW( std::runtime_error( "Shared memory cache " + _name +
+                                         " is smaller than a block" ));
+
+        const size_t size = getDataOffset( _nSlots ) + _nSlots * _slotSize;
+        bool created = true;
+        int fd = ::shm_open( _name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600 );
+        if( fd == -1 && errno == EEXIST )
+        {
+            created = false;
+            fd = ::shm_open( _name.c_str(), O_RDWR, 0 );
+        }
+        if( fd == -1 )
+            LBTHROW( std::runtime_error( "Cannot open shared memory " + _name +
+                                         ": " + ::strerror( errno )));
+
+        // The new segment is filled with zeros, i.e. empty slots
+        const bool sized = created ? ::ftruncate( fd, size ) == 0
+                                   : waitForSize( fd, size );
+        void* ptr = sized ? ::mmap( 0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )
+                          : MAP_FAILED;
+        ::close( fd );
+        if( ptr == MAP_FAILED )
+        {
+            if( created )
+                ::shm_unlink( _name.c_str( ));
+            LBTHROW( std::runtime_error( "Cannot map shared memory " + _name +
+                                         ", it may have another size" ));
+        }
+        _segment.reset( new Segment( ptr, size ));
+
+        Header& header = getHeader();
+        if( created )
+        {
+            header.slotSize = _slotSize;
+            header.nSlots = _nSlots;
+            header.magic.store( segmentMagic, std::memory_order_release );
+            return;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + openTimeout;
+        while( header.magic.load( std::memory_order_acquire ) != segmentMagic )
+        {
+            if( std::chrono::steady_clock::now() > deadline )
+                LBTHROW( std::runtime_error( "Shared memory " + _name +
+                                             " is not initialized" ));
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ));
+        }
+        if( header.slotSize != _slotSize || header.nSlots != _nSlots )
+            LBTHROW( std::runtime_error( "Shared memory " + _name +
+                                         " has another slot size" ));
+    }
+
+    Header& getHeader() const
+    {
+        return *reinterpret_cast< Header* >( _segment->getPtr( ));
+    }
+
+    Slot& getSlot( const size_t index ) const
+    {
+        return reinterpret_cast< Slot* >( _segment->getPtr() + getSlotsOffset( ))[ index ];
+    }
+
+    uint8_t* getData( const size_t index ) const
+    {
+        return _segment->getPtr() + getDataOffset( _nSlots ) + index * _slotSize;
+    }
+
+    // Fibonacci hashing spreads the neighbour node ids, and is the same in
+    // all processes
+    size_t getProbe( const CacheId& cacheId, const size_t probe ) const
+    {
+        return size_t((( cacheId * 11400714819323198485ull ) >> 16 ) + probe ) % _nSlots;
+    }
+
+    size_t getProbeCount() const
+    {
+        return std::min( maxProbes, _nSlots );
+    }
+
+    ConstMemoryUnitPtr load( const CacheId& cacheId )
+    {
+        for( size_t probe = 0; probe < getProbeCount(); ++probe )
+        {
+            const size_t index = getProbe( cacheId, probe );
+            Slot& slot = getSlot( index );
+            if( slot.cacheId.load( std::memory_order_acquire ) != cacheId ||
+                !acquire( slot ))
+            {
+                continue;
+            }
+
+            // The slot may have been reused before it was acquired
+            if( slot.cacheId.load( std::memory_order_acquire ) != cacheId )
+            {
+                slot.state.fetch_sub( 1, std::memory_order_release );
+                continue;
+            }
+
+            slot.lastUse.store( getHeader().clock.fetch_add( 1 ) + 1,
+                                std::memory_order_relaxed );
+            _statistics.notifyHit();
+            return ConstMemoryUnitPtr(
+                new SharedMemoryUnit( _segment, slot, getData( index ),
+                                      slot.size.load( std::memory_order_acquire ),
+                                      _slotSize ));
+        }
+
+        _statistics.notifyMiss();
+        return ConstMemoryUnitPtr();
+    }
+
+    // Reserves an empty slot, or the least recently used unreferenced one
+    Slot* reserve( const CacheId& cacheId, size_t& index )
+    {
+        Slot* victim = nullptr;
+        uint64_t oldest = std::numeric_limits< uint64_t >::max();
+        for( size_t probe = 0; probe < getProbeCount(); ++probe )
+        {
+            const size_t candidate = getProbe( cacheId, probe );
+            Slot& slot = getSlot( candidate );
+            uint32_t state = slot.state.load( std::memory_order_acquire );
+            if( state == EMPTY &&
+                slot.state.compare_exchange_strong( state, WRITING,
+                                                    std::memory_order_acquire ))
+            {
+                index = candidate;
+                return &slot;
+            }
+
+            if( state == READY && slot.lastUse.load( std::memory_order_relaxed ) < oldest )
+            {
+                oldest = slot.lastUse.load( std::memory_order_relaxed );
+                victim = &slot;
+                index = candidate;
+            }
+        }
+
+        uint32_t state = READY;
+        if( !victim || !victim->state.compare_exchange_strong( state, WRITING,
+                                                               std::memory_order_acquire ))
+        {
+            return nullptr;
+        }
+        _statistics.notifyEviction();
+        return victim;
+    }
+
+    bool store( const CacheId& cacheId, const MemoryUnit& data )
+    {
+        const size_t size = data.getMemSize();
+        if( size == 0 || size > _slotSize )
+            return false;
+
+        for( size_t probe = 0; probe < getProbeCount(); ++probe )
+        {
+            Slot& slot = getSlot( getProbe( cacheId, probe ));
+            const uint32_t state = slot.state.load( std::memory_order_acquire );
+            if( state != EMPTY && state != WRITING &&
+                slot.cacheId.load( std::memory_order_acquire ) == cacheId )
+            {
+                return true; // Stored by another thread or process
+            }
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        size_t index = 0;
+        Slot* slot = reserve( cacheId, index );
+        if( !slot )
+            return false;
+
+        slot->cacheId.store( cacheId, std::memory_order_relaxed );
+        slot->size.store( size, std::memory_order_relaxed );
+        ::memcpy( getData( index ), data.getData< uint8_t >(), size );
+        slot->lastUse.store( getHeader().clock.fetch_add( 1 ) + 1,
+                             std::memory_order_relaxed );
+        slot->state.store( READY, std::memory_order_release );
+
+        _statistics.notifyLoadTime( SharedBlock( cacheId, size ),
+                                    std::chrono::steady_clock::now() - startTime );
+        return true;
+    }
+
+    size_t getCount() const
+    {
+        size_t count = 0;
+        for( size_t i = 0; i < _nSlots; ++i )
+        {
+            const uint32_t state = getSlot( i ).state.load( std::memory_order_relaxed );
+            if( state != EMPTY && state != WRITING )
+                ++count;
+        }
+        return count;
+    }
+
+    const std::string _name;
+    const size_t _slotSize;
+    const size_t _nSlots;
+    SegmentPtr _segment;
+    CacheStatistics _statistics;
+};
+
+SharedMemoryCache::SharedMemoryCache( const std::string& datasetId,
+                                      const size_t slotSize,
+                                      const size_t maxMemBytes )
+    : _impl( new SharedMemoryCache::Impl( datasetId, slotSize, maxMemBytes ))
+{}
+
+SharedMemoryCache::~SharedMemoryCache()
+{}
+
+ConstMemoryUnitPtr SharedMemoryCache::load( const CacheId& cacheId )
+{
+    return _impl->load( cacheId );
+}
+
+bool SharedMemoryCache::store( const CacheId& cacheId, const MemoryUnit& data )
+{
+    return _impl->store( cacheId, data );
+}
+
+size_t SharedMemoryCache::getCount() const
+{
+    return _impl->getCount();
+}
+
+const CacheStatistics& SharedMemoryCache::getStatistics() const
+{
+    return _impl->_statistics;
+}
+
+std::string SharedMemoryCache::getName() const
+{
+    return _impl->_name;
+}
+
+void SharedMemoryCache::remove( const std::string& datasetId )
+{
+    ::shm_unlink( getSegmentName( datasetId ).c_str( ));
+}
+
+}
@@ -0,0 +1,102 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _SharedMemoryCache_h_
+#define _SharedMemoryCache_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+#include <livre/core/cache/CacheStatistics.h>
+
+namespace livre
+{
+
+/**
+ * Keeps data blocks in a POSIX shared memory segment, so the processes on a
+ * node which render the same data set share one copy of the decoded blocks.
+ *
+ * The segment is divided in slots of the size of the largest block. The
+ * index of the slots is a lock-free hash table in the segment: a slot is
+ * reference counted while a process uses its block, and only the least
+ * recently used unreferenced slots are reused when the cache is full.
+ *
+ * The segment is kept when the processes exit, so it is reused by the next
+ * ones. A process which crashes while it uses a block leaves its slot
+ * referenced until the segment is removed, \see remove.
+ */
+class SharedMemoryCache
+{
+public:
+
+    /**
+     * Opens the segment of the data set, creating it if needed.
+     * @param datasetId the identity of the data set, \see DiskCache::getDatasetId.
+     * @param slotSize the size of the largest block.
+     * @param maxMemBytes the size of the segment.
+     * @throw std::runtime_error if the segment cannot be opened, or was created
+     * with another slot size or segment size
+     */
+    LIVRECORE_API SharedMemoryCache( const std::string& datasetId,
+                                     size_t slotSize,
+                                     size_t maxMemBytes );
+
+    /** Unmaps the segment once the blocks returned by load() are released */
+    LIVRECORE_API ~SharedMemoryCache();
+
+    /**
+     * @param cacheId the id of the data block.
+     * @return the data block in the segment, which is not reused while it is
+     * referenced, or an empty pointer if it is not in the cache.
+     */
+    LIVRECORE_API ConstMemoryUnitPtr load( const CacheId& cacheId );
+
+    /**
+     * Copies a data block to the segment, if it is not already in the cache.
+     * @param cacheId the id of the data block.
+     * @param data the data of the block.
+     * @return false if the block is larger than a slot, or all the slots it
+     * can go to are in use
+     */
+    LIVRECORE_API bool store( const CacheId& cacheId, const MemoryUnit& data );
+
+    /** @return the number of data blocks in the cache, of all processes */
+    LIVRECORE_API size_t getCount() const;
+
+    /** @return the statistics of this process */
+    LIVRECORE_API const CacheStatistics& getStatistics() const;
+
+    /** @return the name of the shared memory segment */
+    LIVRECORE_API std::string getName() const;
+
+    /**
+     * Removes the segment of a data set. The processes which have it open keep
+     * using it, the next ones create a new one.
+     * @param datasetId the identity of the data set.
+     */
+    LIVRECORE_API static void remove( const std::string& datasetId );
+
+private:
+
+    struct Impl;
+    std::unique_ptr< Impl > _impl;
+};
+
+}
+
+#endif // _SharedMemoryCache_h_
@@ -20,6 +20,8 @@
 
 #include "RendererParameters.h"
 
+#include <livre/core/cache/CachePolicy.h>
+
 namespace livre
 {
 
@@ -27,10 +29,28 @@ const std::string SCREENSPACEERROR_PARAM = "sse";
 const std::string SYNCHRONOUSMODE_PARAM = "synchronous";
 const std::string GPUCACHEMEM_PARAM = "gpu-cache-mem";
 const std::string CPUCACHEMEM_PARAM = "cpu-cache-mem";
+const std::string ADAPTIVECPUCACHEMEM_PARAM = "adaptive-cpu-cache-mem";
+const std::string COMPRESSEDCPUCACHEMEM_PARAM = "compressed-cpu-cache-mem";
+const std::string DISKCACHEDIR_PARAM = "disk-cache-dir";
+const std::string DISKCACHEMEM_PARAM = "disk-cache-mem";
+const std::string PINNEDLEVELS_PARAM = "pinned-levels";
+const std::string PINNEDCPUCACHEMEM_PARAM = "pinned-cpu-cache-mem";
+const std::string PINNEDGPUCACHEMEM_PARAM = "pinned-gpu-cache-mem";
+const std::string MINDATASETCACHEMEM_PARAM = "min-dataset-cache-mem";
+const std::string MAXDATASETCACHEMEM_PARAM = "max-dataset-cache-mem";
+const std::string SHAREDCPUCACHEMEM_PARAM = "shared-cpu-cache-mem";
+const std::string CACHETRACEDIR_PARAM = "cache-trace-dir";
+const std::string PIPELINETRACEDIR_PARAM = "pipeline-trace-dir";
+const std::string SLOWFRAMEDIR_PARAM = "slow-frame-dir";
+const std::string SLOWFRAMELATENCY_PARAM = "slow-frame-latency";
+const std::string SLOWFRAMEHISTORY_PARAM = "slow-frame-history";
 const std::string MINLOD_PARAM = "min-lod";
 const std::string MAXLOD_PARAM = "max-lod";
 const std::string SAMPLESPERRAY_PARAM = "samples-per-ray";
 const std::string SAMPLESPERPIXEL_PARAM = "samples-per-pixel";
+const std::string DATACACHEPOLICY_PARAM = "data-cache-policy";
+const std::string TEXTURECACHEPOLICY_PARAM = "texture-cache-policy";
+const std::string HISTOGRAMCACHEPOLICY_PARAM = "histogram-cache-policy";
 
 RendererParameters::RendererParameters()
     : Parameters( "Volume Renderer Parameters" )
@@ -43,6 +63,74 @@ RendererParameters::RendererParameters()
                                    "Maximum CPU cache memory (MB) - "
                                    "caches the volume data in CPU memory",
                                    getMaxCPUCacheMemoryMB( ));
+    _configuration.addDescription( configGroupName_, ADAPTIVECPUCACHEMEM_PARAM,
+                                   "Adapt the CPU cache memory to the memory "
+                                   "available in the cgroup and the system, "
+                                   "up to the maximum CPU cache memory",
+                                   getAdaptiveCPUCacheMemory( ));
+    _configuration.addDescription( configGroupName_, COMPRESSEDCPUCACHEMEM_PARAM,
+                                   "Compressed CPU cache memory (MB) - "
+                                   "keeps the volume data evicted from the "
+                                   "CPU cache compressed in CPU memory, 0 disables it",
+                                   getCompressedCPUCacheMemoryMB( ));
+    _configuration.addDescription( configGroupName_, DISKCACHEDIR_PARAM,
+                                   "Disk cache directory - keeps the volume "
+                                   "data in files on a local disk, which are "
+                                   "reused after a restart",
+                                   getDiskCacheDirectoryString( ));
+    _configuration.addDescription( configGroupName_, DISKCACHEMEM_PARAM,
+                                   "Maximum disk cache size (MB)",
+                                   getMaxDiskCacheMemoryMB( ));
+    _configuration.addDescription( configGroupName_, PINNEDLEVELS_PARAM,
+                                   "Number of coarse levels of detail which "
+                                   "are never evicted from the CPU and GPU "
+                                   "caches, 0 disables it",
+                                   getPinnedLevels( ));
+    _configuration.addDescription( configGroupName_, PINNEDCPUCACHEMEM_PARAM,
+                                   "Maximum CPU cache memory of the pinned levels (MB)",
+                                   getPinnedCPUCacheMemoryMB( ));
+    _configuration.addDescription( configGroupName_, PINNEDGPUCACHEMEM_PARAM,
+                                   "Maximum GPU cache memory of the pinned levels (MB)",
+                                   getPinnedGPUCacheMemoryMB( ));
+    _configuration.addDescription( configGroupName_, MINDATASETCACHEMEM_PARAM,
+                                   "Minimum CPU cache memory of each data set "
+                                   "(MB) - kept when the memory follows the "
+                                   "data sets on screen",
+                                   getMinDatasetCacheMemoryMB( ));
+    _configuration.addDescription( configGroupName_, MAXDATASETCACHEMEM_PARAM,
+                                   "Maximum CPU cache memory of each data set "
+                                   "(MB), 0 disables it",
+                                   getMaxDatasetCacheMemoryMB( ));
+    _configuration.addDescription( configGroupName_, SHAREDCPUCACHEMEM_PARAM,
+                                   "Shared CPU cache memory (MB) - keeps the "
+                                   "volume data in shared memory, where the "
+                                   "livre processes of a node share it, "
+                                   "0 disables it",
+                                   getSharedCPUCacheMemoryMB( ));
+    _configuration.addDescription( configGroupName_, CACHETRACEDIR_PARAM,
+                                   "Cache trace directory - records the "
+                                   "accesses of the CPU data cache of each "
+                                   "data set, to replay them with "
+                                   "livreCacheReplay",
+                                   getCacheTraceDirectoryString( ));
+    _configuration.addDescription( configGroupName_, PIPELINETRACEDIR_PARAM,
+                                   "Pipeline trace directory - records the "
+                                   "executions of the filters of each process, "
+                                   "to see them in chrome://tracing",
+                                   getPipelineTraceDirectoryString( ));
+    _configuration.addDescription( configGroupName_, SLOWFRAMEDIR_PARAM,
+                                   "Slow frame directory - dumps the latest "
+                                   "frames of a channel, with their filters "
+                                   "and cache statistics, when a frame is slow. "
+                                   "The default is the temporary directory",
+                                   getSlowFrameDirectoryString( ));
+    _configuration.addDescription( configGroupName_, SLOWFRAMELATENCY_PARAM,
+                                   "Latency (ms) of the slow frames, 0 disables "
+                                   "the slow frame dumps",
+                                   getSlowFrameLatencyMS( ));
+    _configuration.addDescription( configGroupName_, SLOWFRAMEHISTORY_PARAM,
+                                   "Number of latest frames in the slow frame "
+                                   "dumps", getSlowFrameHistory( ));
     _configuration.addDescription( configGroupName_, SCREENSPACEERROR_PARAM,
                                    "Screen space error", getSSE( ));
     _configuration.addDescription( configGroupName_, SYNCHRONOUSMODE_PARAM,
@@ -57,6 +145,18 @@ RendererParameters::RendererParameters()
                                    getSamplesPerRay( ));
     _configuration.addDescription( configGroupName_, SAMPLESPERPIXEL_PARAM,
                                    "Number of samples per pixel", getSamplesPerPixel( ));
+    _configuration.addDescription( configGroupName_, DATACACHEPOLICY_PARAM,
+                                   "Eviction policy of the CPU data cache "
+                                   "(lru, lfu, 2q, visible)",
+                                   getCachePolicyName( CachePolicyType( getDataCachePolicy( ))));
+    _configuration.addDescription( configGroupName_, TEXTURECACHEPOLICY_PARAM,
+                                   "Eviction policy of the GPU texture cache "
+                                   "(lru, lfu, 2q, visible)",
+                                   getCachePolicyName( CachePolicyType( getTextureCachePolicy( ))));
+    _configuration.addDescription( configGroupName_, HISTOGRAMCACHEPOLICY_PARAM,
+                                   "Eviction policy of the histogram cache "
+                                   "(lru, lfu, 2q, visible)",
+                                   getCachePolicyName( CachePolicyType( getHistogramCachePolicy( ))));
 }
 
 void RendererParameters::_initialize()
@@ -68,12 +168,54 @@ void RendererParameters::_initialize()
                                                      getMaxGPUCacheMemoryMB( )));
     setMaxCPUCacheMemoryMB( _configuration.getValue( CPUCACHEMEM_PARAM,
                                                      getMaxCPUCacheMemoryMB( )));
+    setAdaptiveCPUCacheMemory( _configuration.getValue( ADAPTIVECPUCACHEMEM_PARAM,
+                                                        getAdaptiveCPUCacheMemory( )));
+    setCompressedCPUCacheMemoryMB( _configuration.getValue( COMPRESSEDCPUCACHEMEM_PARAM,
+                                                            getCompressedCPUCacheMemoryMB( )));
+    setDiskCacheDirectory( _configuration.getValue( DISKCACHEDIR_PARAM,
+                                                    getDiskCacheDirectoryString( )));
+    setMaxDiskCacheMemoryMB( _configuration.getValue( DISKCACHEMEM_PARAM,
+                                                      getMaxDiskCacheMemoryMB( )));
+    setPinnedLevels( _configuration.getValue( PINNEDLEVELS_PARAM, getPinnedLevels( )));
+    setPinnedCPUCacheMemoryMB( _configuration.getValue( PINNEDCPUCACHEMEM_PARAM,
+                                                        getPinnedCPUCacheMemoryMB( )));
+    setPinnedGPUCacheMemoryMB( _configuration.getValue( PINNEDGPUCACHEMEM_PARAM,
+                                                        getPinnedGPUCacheMemoryMB( )));
+    setMinDatasetCacheMemoryMB( _configuration.getValue( MINDATASETCACHEMEM_PARAM,
+                                                         getMinDatasetCacheMemoryMB( )));
+    setMaxDatasetCacheMemoryMB( _configuration.getValue( MAXDATASETCACHEMEM_PARAM,
+                                                         getMaxDatasetCacheMemoryMB( )));
+    setSharedCPUCacheMemoryMB( _configuration.getValue( SHAREDCPUCACHEMEM_PARAM,
+                                                        getSharedCPUCacheMemoryMB( )));
+    setCacheTraceDirectory( _configuration.getValue( CACHETRACEDIR_PARAM,
+                                                     getCacheTraceDirectoryString( )));
+    setPipelineTraceDirectory( _configuration.getValue( PIPELINETRACEDIR_PARAM,
+                                                        getPipelineTraceDirectoryString( )));
+    setSlowFrameDirectory( _configuration.getValue( SLOWFRAMEDIR_PARAM,
+                                                    getSlowFrameDirectoryString( )));
+    setSlowFrameLatencyMS( _configuration.getValue( SLOWFRAMELATENCY_PARAM,
+                                                    getSlowFrameLatencyMS( )));
+    setSlowFrameHistory( _configuration.getValue( SLOWFRAMEHISTORY_PARAM,
+                                                  getSlowFrameHistory( )));
     setMinLOD( _configuration.getValue( MINLOD_PARAM, getMinLOD( )));
     setMaxLOD( _configuration.getValue( MAXLOD_PARAM, getMaxLOD( )));
     setSamplesPerRay( _configuration.getValue( SAMPLESPERRAY_PARAM,
                                                getSamplesPerRay( )));
     setSamplesPerPixel( _configuration.getValue( SAMPLESPERPIXEL_PARAM,
                                                  getSamplesPerPixel( )));
+
+    const std::string dataCachePolicy =
+        _configuration.getValue( DATACACHEPOLICY_PARAM,
+                                 getCachePolicyName( CachePolicyType( getDataCachePolicy( ))));
+    setDataCachePolicy( getCachePolicyType( dataCachePolicy ));
+    const std::string textureCachePolicy =
+        _configuration.getValue( TEXTURECACHEPOLICY_PARAM,
+                                 getCachePolicyName( CachePolicyType( getTextureCachePolicy( ))));
+    setTextureCachePolicy( getCachePolicyType( textureCachePolicy ));
+    const std::string histogramCachePolicy =
+        _configuration.getValue( HISTOGRAMCACHEPOLICY_PARAM,
+                                 getCachePolicyName( CachePolicyType( getHistogramCachePolicy( ))));
+    setHistogramCachePolicy( getCachePolicyType( histogramCachePolicy ));
 }
 
 } //Livre
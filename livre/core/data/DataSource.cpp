@@ -39,8 +39,9 @@ struct DataSource::Impl
 public:
     typedef PluginFactory< DataSourcePlugin, const DataSourcePluginData& > PFactory;
 
-    Impl( const servus::URI& uri, const AccessMode accessMode )
-        : plugin( PFactory::getInstance().create( DataSourcePluginData( uri, accessMode )))
+    Impl( const servus::URI& dataUri, const AccessMode accessMode )
+        : uri( dataUri )
+        , plugin( PFactory::getInstance().create( DataSourcePluginData( uri, accessMode )))
     {}
 
     LODNode getNode( const NodeId& nodeId ) const
@@ -58,6 +59,7 @@ public:
         return plugin->getData( node );
     }
 
+    const servus::URI uri;
     std::unique_ptr< DataSourcePlugin > plugin;
 };
 
@@ -94,6 +96,11 @@ const VolumeInformation& DataSource::getVolumeInfo() const
     return _impl->plugin->getVolumeInfo();
 }
 
+const servus::URI& DataSource::getURI() const
+{
+    return _impl->uri;
+}
+
 bool DataSource::initializeGL()
 {
     return _impl->plugin->initializeGL();
@@ -64,6 +64,9 @@ public:
      */
     LIVRECORE_API static VolumeInformation getVolumeInfo( const servus::URI& uri );
 
+    /** @return The URI the data source was created from. */
+    LIVRECORE_API const servus::URI& getURI() const;
+
     /** Initializes the GL specific functions. */
     LIVRECORE_API bool initializeGL();
 
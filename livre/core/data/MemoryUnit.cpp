@@ -19,8 +19,31 @@
 
 #include <livre/core/data/MemoryUnit.h>
 
+#include <sys/mman.h>
+#include <unistd.h>
+
 namespace livre
 {
+namespace
+{
+#ifdef __APPLE__
+typedef char PageFlag;
+#else
+typedef unsigned char PageFlag;
+#endif
+
+size_t getPageSize()
+{
+    static const size_t pageSize = ::sysconf( _SC_PAGESIZE );
+    return pageSize;
+}
+
+// The mapping functions need page aligned addresses
+uint8_t* getPageStart( const uint8_t* ptr )
+{
+    return reinterpret_cast< uint8_t* >( uintptr_t( ptr ) / getPageSize() * getPageSize( ));
+}
+}
 
 MemoryUnit::MemoryUnit()
 {}
@@ -43,6 +66,42 @@ const uint8_t* ConstMemoryUnit::_getData() const
     return ptr_;
 }
 
+MappedMemoryUnit::MappedMemoryUnit( const uint8_t* ptr, const size_t size )
+    : ConstMemoryUnit( ptr, size )
+{
+}
+
+void MappedMemoryUnit::prefetch() const
+{
+    if( size_ == 0 )
+        return;
+
+    uint8_t* start = getPageStart( ptr_ );
+    ::madvise( start, ptr_ + size_ - start, MADV_WILLNEED );
+
+    volatile uint8_t value = 0;
+    for( const uint8_t* page = start; page < ptr_ + size_; page += getPageSize( ))
+        value = *std::max( page, ptr_ );
+    (void)value;
+}
+
+size_t MappedMemoryUnit::getAllocSize() const
+{
+    if( size_ == 0 )
+        return 0;
+
+    uint8_t* start = getPageStart( ptr_ );
+    const size_t length = ptr_ + size_ - start;
+    std::vector< PageFlag > pages(( length + getPageSize() - 1 ) / getPageSize( ));
+    if( ::mincore( start, length, pages.data( )) != 0 )
+        return size_; // Unknown, all of it is accounted
+
+    size_t residentPages = 0;
+    for( const PageFlag page: pages )
+        residentPages += page & 1;
+    return std::min( residentPages * getPageSize(), size_ );
+}
+
 size_t AllocMemoryUnit::getMemSize() const
 {
     return _rawData.getSize();
@@ -84,13 +84,32 @@ public:
     ~ConstMemoryUnit() {}
 protected:
     size_t getMemSize() const final;
-    size_t getAllocSize() const final { return 0; }
+    size_t getAllocSize() const override { return 0; }
     const uint8_t* _getData() const final;
     uint8_t* _getData() final { LBDONTCALL; return 0; }
     const uint8_t* const ptr_;
     const size_t size_;
 };
 
+/**
+ * The MappedMemoryUnit class shows a part of a memory mapped file. The pages
+ * are read by the OS when they are used, so the allocated memory is the part
+ * which is resident in the page cache.
+ */
+class MappedMemoryUnit : public ConstMemoryUnit
+{
+public:
+    LIVRECORE_API MappedMemoryUnit( const uint8_t* ptr, const size_t size );
+    ~MappedMemoryUnit() {}
+
+    /** Reads the pages which are not resident, i.e. before the data is used */
+    LIVRECORE_API void prefetch() const;
+
+protected:
+    /** @return the resident memory, sampled with mincore */
+    LIVRECORE_API size_t getAllocSize() const final;
+};
+
 /**
  * The AllocMemoryUnit class shows an allocated memory pointer to keep track of memory consumption.
  * Memory is cleaned on destruction.
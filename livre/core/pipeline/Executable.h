@@ -28,6 +28,14 @@
 namespace livre
 {
 
+/** The scheduling priorities of the executables, \see Executable::getPriority */
+enum ExecutablePriority
+{
+    PRIORITY_BACKGROUND = 0u, //!< Work no frame waits for, i.e. histograms
+    PRIORITY_NORMAL = 1u,
+    PRIORITY_RENDER = 2u //!< Work the rendering of a frame waits for
+};
+
 /**
  * Is the base class for execution. It provides methods for execution,
  * preconditions and postconditions for decision on scheduling.
@@ -61,6 +69,26 @@ public:
      */
     virtual Futures getPreconditions() const = 0;
 
+    /**
+     * @return the priority of the executable. The executors run the ready
+     * executables with a higher priority first.
+     */
+    LIVRECORE_API virtual ExecutablePriority getPriority() const { return PRIORITY_NORMAL; }
+
+    /**
+     * @return the frame the executable works for, or 0 if it does not belong to
+     * a frame. The frames are waited for in order, so the executors run the
+     * executables of older frames than the newest scheduled one before all
+     * the others.
+     */
+    LIVRECORE_API virtual uint32_t getFrame() const { return 0; }
+
+    /**
+     * Is called by the executors when the executable is queued, i.e. to trace
+     * how long it waits before it runs, \see PipelineTrace.
+     */
+    LIVRECORE_API virtual void notifyScheduled() {}
+
     /**
      * Resets the executable by setting all pre and post conditions to an clean state
      * ( The futures are not ready )
@@ -64,6 +64,15 @@ public:
     LIVRECORE_API virtual ~Filter() {}
 };
 
+/**
+ * @param dataInfos the input or output data infos of a filter.
+ * @param portName the name of the port.
+ * @return the id of the port, which is the same in the FutureMap or the
+ * PromiseMap the filter is executed with.
+ * @throw std::runtime_error if there is no port with the name
+ */
+LIVRECORE_API PortId getPortId( const DataInfos& dataInfos, const std::string& portName );
+
 }
 
 #endif // _Filter_h_
@@ -18,59 +18,87 @@
  */
 
 #include <livre/core/pipeline/FutureMap.h>
+#include <livre/core/pipeline/InputPort.h>
 
 #include <lunchbox/debug.h>
 
+#include <algorithm>
+
 namespace livre
 {
-namespace
+
+struct FutureMapImpl
 {
+public:
 
-const std::string ALL_FUTURES = "ALL_FUTURES";
+    explicit FutureMapImpl( const Futures& futures )
+        : _futures( futures.begin(), futures.end( ))
+    {
+        std::stable_sort( _futures.begin(), _futures.end(),
+                          []( const Future& future1, const Future& future2 )
+                          { return future1.getName() < future2.getName(); });
 
-}
+        for( size_t i = 0; i < _futures.size(); ++i )
+        {
+            if( i + 1 == _futures.size() ||
+                _futures[ i + 1 ].getName() != _futures[ i ].getName( ))
+            {
+                _ends.push_back( i + 1 );
+            }
+        }
+    }
 
-typedef std::multimap< std::string, Future > NameFutureMap;
+    explicit FutureMapImpl( const InputPorts& ports )
+    {
+        size_t nFutures = 0;
+        for( const InputPort& port: ports )
+            nFutures += port.getSize();
 
-struct FutureMapImpl
-{
-public:
+        _futures.reserve( nFutures );
+        _ends.reserve( ports.size( ));
+        for( const InputPort& port: ports )
+        {
+            const Futures& futures = port.getFutures();
+            _futures.insert( _futures.end(), futures.begin(), futures.end( ));
+            _ends.push_back( _futures.size( ));
+        }
+    }
 
     void throwError( const std::string& name ) const
     {
         LBTHROW( std::logic_error( std::string( "Unknown future name: ") + name ));
     }
 
-    bool hasFuture( const std::string& name ) const
+    PortFutures getFutures() const
     {
-        return _futureMap.count( name ) > 0;
+        return PortFutures( _futures.data(), _futures.data() + _futures.size( ));
     }
 
-    Futures getFutures( const std::string& name ) const
+    PortFutures getFutures( const PortId port ) const
     {
-        if( name == ALL_FUTURES )
-        {
-            Futures futures;
-            for( const auto& nameFuture: _futureMap )
-                futures.push_back( nameFuture.second );
-            return futures;
-        }
-
-        if( !hasFuture( name ))
-            throwError( name );
+        if( port >= _ends.size( ))
+            LBTHROW( std::logic_error( std::string( "Unknown port id: ")
+                                       + std::to_string( port )));
 
-        Futures futures;
-        const auto& itPair = _futureMap.equal_range( name );
+        const size_t begin = port == 0 ? 0 : _ends[ port - 1 ];
+        return PortFutures( _futures.data() + begin, _futures.data() + _ends[ port ]);
+    }
 
-        for( auto it = itPair.first; it != itPair.second; ++it )
-            futures.push_back( it->second );
+    PortFutures getFutures( const std::string& name ) const
+    {
+        const auto& itPair =
+            std::equal_range( _futures.begin(), _futures.end(), name, NameLess( ));
+        if( itPair.first == itPair.second )
+            throwError( name );
 
-        return futures;
+        const Future* futures = _futures.data();
+        return PortFutures( futures + ( itPair.first - _futures.begin( )),
+                            futures + ( itPair.second - _futures.begin( )));
     }
 
-    bool isReady( const std::string& name ) const
+    bool isReady( const PortFutures& futures ) const
     {
-        for( const auto& future: getFutures( name ))
+        for( const auto& future: futures )
         {
             if( !future.isReady())
                 return false;
@@ -78,36 +106,46 @@ public:
         return true;
     }
 
-    void wait( const std::string& name ) const
+    void wait( const PortFutures& futures ) const
     {
-        for( const auto& future: getFutures( name ))
+        for( const auto& future: futures )
             future.wait();
     }
 
-    void waitForAny( const std::string& name ) const
+    void waitForAny( const PortFutures& futures ) const
     {
-        livre::waitForAny( getFutures( name ));
+        livre::waitForAny( Futures( futures.begin(), futures.end( )));
     }
 
-    void addFuture( const std::string& name, const Future& future )
+    // Compares the names of the futures with the searched name
+    struct NameLess
     {
-        _futureMap.insert( std::make_pair( name, future ));
-    }
-
-    NameFutureMap _futureMap;
+        bool operator()( const Future& future, const std::string& name ) const
+            { return future.getName() < name; }
+        bool operator()( const std::string& name, const Future& future ) const
+            { return name < future.getName(); }
+    };
+
+    // The futures in the order of their ports, and the end of the futures of
+    // each port
+    std::vector< Future > _futures;
+    std::vector< size_t > _ends;
 };
 
 struct UniqueFutureMap::Impl: public FutureMapImpl
 {
 public:
     Impl( const Futures& futures )
+        : FutureMapImpl( futures )
     {
-        for( const auto& future: futures )
+        if( _ends.size() == _futures.size( ))
+            return;
+
+        for( size_t i = 0; i < _ends.size(); ++i )
         {
-            const std::string& name = future.getName();
-            if( hasFuture( name ))
-                throwError( name );
-            addFuture( name, future );
+            const size_t begin = i == 0 ? 0 : _ends[ i - 1 ];
+            if( _ends[ i ] - begin > 1 )
+                throwError( _futures[ begin ].getName( ));
         }
     }
 };
@@ -118,27 +156,28 @@ UniqueFutureMap::UniqueFutureMap( const Futures& futures )
 
 Futures UniqueFutureMap::getFutures() const
 {
-    return _impl->getFutures( ALL_FUTURES );
+    const PortFutures& futures = _impl->getFutures();
+    return Futures( futures.begin(), futures.end( ));
 }
 
 Future UniqueFutureMap::getFuture( const std::string& name ) const
 {
-    return _impl->getFutures( name ).front();
+    return *_impl->getFutures( name ).begin();
 }
 
 bool UniqueFutureMap::isReady( const std::string& name ) const
 {
-    return _impl->isReady( name );
+    return _impl->isReady( _impl->getFutures( name ));
 }
 
 void UniqueFutureMap::wait( const std::string& name ) const
 {
-    _impl->wait( name );
+    _impl->wait( _impl->getFutures( name ));
 }
 
 void UniqueFutureMap::waitForAny() const
 {
-    _impl->waitForAny( ALL_FUTURES );
+    _impl->waitForAny( _impl->getFutures( ));
 }
 
 UniqueFutureMap::~UniqueFutureMap()
@@ -147,11 +186,13 @@ UniqueFutureMap::~UniqueFutureMap()
 struct FutureMap::Impl: public FutureMapImpl
 {
 public:
-    Impl( const Futures& futures )
-    {
-        for( const auto& future: futures )
-            addFuture( future.getName(), future );
-    }
+    explicit Impl( const Futures& futures )
+        : FutureMapImpl( futures )
+    {}
+
+    explicit Impl( const InputPorts& ports )
+        : FutureMapImpl( ports )
+    {}
 };
 
 FutureMap::FutureMap( const Futures& futures )
@@ -159,49 +200,78 @@ FutureMap::FutureMap( const Futures& futures )
 {
 }
 
+FutureMap::FutureMap( const InputPorts& ports )
+    : _impl( std::make_shared< FutureMap::Impl >( ports ))
+{
+}
+
 Futures FutureMap::getFutures( const std::string& name ) const
 {
-    return _impl->getFutures( name );
+    const PortFutures& futures = _impl->getFutures( name );
+    return Futures( futures.begin(), futures.end( ));
+}
+
+PortFutures FutureMap::getFutures( const PortId port ) const
+{
+    return _impl->getFutures( port );
+}
+
+const Future& FutureMap::getFuture( const PortId port ) const
+{
+    const PortFutures& futures = _impl->getFutures( port );
+    if( futures.empty( ))
+        LBTHROW( std::logic_error( std::string( "No future on port id: ")
+                                   + std::to_string( port )));
+    return *futures.begin();
 }
 
 Futures FutureMap::getFutures() const
 {
-    return _impl->getFutures( ALL_FUTURES );
+    const PortFutures& futures = _impl->getFutures();
+    return Futures( futures.begin(), futures.end( ));
 }
 
 bool FutureMap::isReady( const std::string& name ) const
 {
-    return _impl->isReady( name );
+    return _impl->isReady( _impl->getFutures( name ));
+}
+
+bool FutureMap::isReady( const PortId port ) const
+{
+    return _impl->isReady( _impl->getFutures( port ));
 }
 
 bool FutureMap::isReady() const
 {
-    return _impl->isReady( ALL_FUTURES );
+    return _impl->isReady( _impl->getFutures( ));
 }
 
 void FutureMap::wait( const std::string& name ) const
 {
-    _impl->wait( name );
+    _impl->wait( _impl->getFutures( name ));
+}
+
+void FutureMap::wait( const PortId port ) const
+{
+    _impl->wait( _impl->getFutures( port ));
 }
 
 void FutureMap::wait() const
 {
-    _impl->wait( ALL_FUTURES );
+    _impl->wait( _impl->getFutures( ));
 }
 
 void FutureMap::waitForAny( const std::string& name ) const
 {
-    _impl->waitForAny( name );
+    _impl->waitForAny( _impl->getFutures( name ));
 }
 
 void FutureMap::waitForAny() const
 {
-    _impl->waitForAny( ALL_FUTURES );
+    _impl->waitForAny( _impl->getFutures( ));
 }
 
 FutureMap::~FutureMap()
 {}
 
-
-
 }
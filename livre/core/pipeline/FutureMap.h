@@ -27,6 +27,25 @@
 namespace livre
 {
 
+/**
+ * The futures of a port in a FutureMap, valid as long as the map.
+ */
+class PortFutures
+{
+public:
+    PortFutures( const Future* begin, const Future* end )
+        : _begin( begin ), _end( end ) {}
+
+    const Future* begin() const { return _begin; }
+    const Future* end() const { return _end; }
+    size_t size() const { return _end - _begin; }
+    bool empty() const { return _begin == _end; }
+
+private:
+    const Future* _begin;
+    const Future* _end;
+};
+
 /**
  * FutureMap is a wrapper class to query the map of ( name, future )
  * futures with for data and state. In the map there can be multiple futures
@@ -38,7 +57,8 @@ namespace livre
  * are communicated through promise/future couples. The futures are named
  * with the port names and users can access those values using the port
  * names in the futures. This class provides convenient functions for querying
- * futures with port names.
+ * futures with port names, or with the port ids of the filter in the
+ * execution, which avoid the name comparisons, \see getPortId.
  */
 class FutureMap
 {
@@ -49,11 +69,19 @@ public:
      * future names are used for name-future association.
      */
     LIVRECORE_API explicit FutureMap( const Futures& futures );
+
+    /**
+     * @param ports the input ports of a filter, sorted by name. Their ids are
+     * their indices.
+     */
+    LIVRECORE_API explicit FutureMap( const InputPorts& ports );
     LIVRECORE_API ~FutureMap();
 
     /**
      * Gets a copy of value(s) with the given type T. Until all
-     * futures with a given name are ready, this function will block.
+     * futures with a given name are ready, this function will block. The
+     * types which are expensive to copy do not compile, they are read with
+     * Future::get() from getFutures() or with UniqueFutureMap::get().
      * @param name of the future.
      * @return the values of the futures.
      * @throw std::logic_error when there is no future associated with the
@@ -64,6 +92,7 @@ public:
     template< class T >
     std::vector< T > get( const std::string& name ) const
     {
+        static_assert( IsCheapToCopy< T >::value, "Read the value with Future::get()" );
         std::vector< T > results;
         for( const auto& future: getFutures( name ))
             results.push_back( future.get< T >( ));
@@ -72,7 +101,8 @@ public:
     }
 
     /**
-     * Gets the copy of ready value(s) with the given type T.
+     * Gets the copy of ready value(s) with the given type T. The types which
+     * are expensive to copy do not compile, \see get().
      * @param name of the future.
      * @return the values of the futures.
      * @throw std::logic_error when there is no future associated with the
@@ -83,6 +113,7 @@ public:
     template< class T >
     std::vector< T > getReady( const std::string& name ) const
     {
+        static_assert( IsCheapToCopy< T >::value, "Read the value with Future::get()" );
         std::vector< T > results;
         for( const auto& future: getFutures( name ))
         {
@@ -94,12 +125,48 @@ public:
         return results;
     }
 
+    /**
+     * Gets a copy of value(s) with the given type T, \see get().
+     * @param port the id of the port.
+     * @return the values of the futures.
+     * @throw std::logic_error when there is no port with the given id
+     * @throw std::runtime_error when the data is not exact
+     * type T
+     */
+    template< class T >
+    std::vector< T > get( const PortId port ) const
+    {
+        static_assert( IsCheapToCopy< T >::value, "Read the value with Future::get()" );
+        const PortFutures& futures = getFutures( port );
+        std::vector< T > results;
+        results.reserve( futures.size( ));
+        for( const auto& future: futures )
+            results.push_back( future.get< T >( ));
+
+        return results;
+    }
+
     /**
      * @param name of the future.
      * @return the futures with the given name
      */
     LIVRECORE_API Futures getFutures( const std::string& name ) const;
 
+    /**
+     * @param port the id of the port.
+     * @return the futures of the port, which is empty if the port is not
+     * connected.
+     * @throw std::logic_error when there is no port with the given id
+     */
+    LIVRECORE_API PortFutures getFutures( PortId port ) const;
+
+    /**
+     * @param port the id of the port.
+     * @return the first future of the port.
+     * @throw std::logic_error when there is no future for the port
+     */
+    LIVRECORE_API const Future& getFuture( PortId port ) const;
+
     /**
      * @return the futures
      */
@@ -114,6 +181,14 @@ public:
      */
     LIVRECORE_API bool isReady( const std::string& name ) const;
 
+    /**
+     * Queries if the futures of a port are ready
+     * @param port the id of the port.
+     * @return true if all futures of the port are ready.
+     * @throw std::logic_error when there is no port with the given id
+     */
+    LIVRECORE_API bool isReady( PortId port ) const;
+
     /**
      * Queries if all futures are ready
      * @return true if all futures are ready.
@@ -130,6 +205,13 @@ public:
      */
     LIVRECORE_API void wait( const std::string& name ) const;
 
+    /**
+     * Waits all futures of a port
+     * @param port the id of the port.
+     * @throw std::logic_error when there is no port with the given id
+     */
+    LIVRECORE_API void wait( PortId port ) const;
+
     /**
      * Waits all futures
      * @throw std::runtime_error when there is no future associated with the
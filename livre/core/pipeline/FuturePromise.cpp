@@ -20,71 +20,102 @@
 #include <livre/core/pipeline/FuturePromise.h>
 
 #include <lunchbox/debug.h>
-#include <servus/uint128_t.h>
 
-#include <boost/thread/future.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <atomic>
 
 namespace livre
 {
 
-typedef boost::shared_future< PortDataPtr > PortDataFuture;
-typedef boost::promise< PortDataPtr > PortDataPromise;
-typedef std::vector< PortDataFuture > PortDataFutures;
+namespace
+{
+// Ids are unique for each promise reset, a counter is enough for equality
+std::atomic< uint64_t > nextId( 1 );
+}
 
-struct Future::Impl
+// One generation of a promise: the data, shared by the futures of the
+// generation, and the functions called once it is set
+struct Future::State
 {
-    Impl( const PortDataFuture& future,
-          const std::string& name,
-          const servus::uint128_t& uuid )
-        : _name( name )
-        , _future( future )
-        , _uuid( uuid )
+    State()
+        : id( nextId++ )
+        , ready( false )
     {}
 
-    std::string getName() const
+    void wait()
     {
-        return _name;
+        if( ready )
+            return;
+
+        ScopedLock lock( mutex );
+        while( !ready )
+            condition.wait( lock );
     }
 
-    PortDataPtr get( const std::type_index& dataType ) const
+    // @return false if the data was set already
+    bool set( const PortDataPtr& value )
     {
-        const PortDataPtr& data = _future.get();
-
-        if( !data )
-            LBTHROW( std::runtime_error( "Returns empty data" ));
-
-        if( data->dataType != dataType )
-            LBTHROW( std::runtime_error( "Types does not match on get value"));
+        std::vector< std::function< void() >> readyCallbacks;
+        {
+            ScopedLock lock( mutex );
+            if( ready )
+                return false;
 
-        return data;
-    }
+            data = value;
+            ready = true;
+            readyCallbacks.swap( callbacks );
+        }
+        condition.notify_all();
 
-    bool isReady() const
-    {
-        return _future.is_ready();
+        // The callbacks are called without lock, in the thread setting the data
+        for( const auto& callback: readyCallbacks )
+            callback();
+        return true;
     }
 
-    void wait() const
+    void onReady( const std::function< void() >& callback )
     {
-        return _future.wait();
+        {
+            ScopedLock lock( mutex );
+            if( !ready )
+            {
+                callbacks.push_back( callback );
+                return;
+            }
+        }
+        callback();
     }
 
-    std::string _name;
-    mutable PortDataFuture _future;
-    servus::uint128_t _uuid;
+    const uint64_t id;
+    std::atomic< bool > ready;
+    boost::mutex mutex;
+    boost::condition_variable condition;
+    PortDataPtr data;
+    std::vector< std::function< void() >> callbacks;
 };
 
 struct Promise::Impl
 {
     Impl( const DataInfo& dataInfo )
         : _dataInfo( dataInfo )
-        , _uuid( servus::make_UUID( ))
-        , _futureImpl( new Future::Impl( PortDataFuture( _promise.get_future()),
-                                         dataInfo.first,
-                                         _uuid ))
+        , _name( std::make_shared< const std::string >( dataInfo.first ))
+        , _state( std::make_shared< Future::State >( ))
     {}
 
-    std::string getName() const
+    Impl( const Impl& impl )
+        : _dataInfo( impl._dataInfo )
+        , _name( impl._name )
+        , _state( impl._state )
+    {}
+
+    ~Impl()
+    {
+        flush();
+    }
+
+    const std::string& getName() const
     {
         return _dataInfo.first;
     }
@@ -102,53 +133,34 @@ struct Promise::Impl
                 LBTHROW( std::runtime_error( "Types does not match on set value"));
         }
 
-        try
-        {
-            _promise.set_value( data );
-        }
-        catch( const boost::promise_already_satisfied& )
-        {
+        if( !_state->set( data ))
             LBTHROW( std::runtime_error( "Data only can be set once"));
-        }
     }
 
     void reset()
     {
-        try
-        {
-            _promise.set_value( PortDataPtr( ));
-        }
-        catch( const boost::promise_already_satisfied& )
-        {
-        }
-
-        PortDataPromise promise;
-        _promise.swap( promise );
-        _uuid = servus::make_UUID();
-        _futureImpl->_future = _promise.get_future();
-        _futureImpl->_uuid = _uuid;
+        flush();
+        _state = std::make_shared< Future::State >();
     }
 
     void flush()
     {
-        try
-        {
-            _promise.set_value( PortDataPtr( ));
-        }
-        catch( const boost::promise_already_satisfied& )
-        {}
+        _state->set( PortDataPtr( ));
     }
 
-    PortDataPromise _promise;
     const DataInfo _dataInfo;
-    servus::uint128_t _uuid;
-    std::shared_ptr< Future::Impl > _futureImpl;
+    const std::shared_ptr< const std::string > _name;
+    std::shared_ptr< Future::State > _state;
 };
 
 Promise::Promise( const DataInfo& dataInfo )
     : _impl( new Promise::Impl( dataInfo ))
 {}
 
+Promise::Promise( const std::shared_ptr< Impl >& impl )
+    : _impl( impl )
+{}
+
 Promise::~Promise()
 {}
 
@@ -157,7 +169,7 @@ std::type_index Promise::getDataType() const
     return _impl->getDataType();
 }
 
-std::string Promise::getName() const
+const std::string& Promise::getName() const
 {
     return _impl->getName();
 }
@@ -178,57 +190,103 @@ void Promise::reset()
     _impl->reset();
 }
 
+Promise Promise::getCurrent() const
+{
+    return Promise( std::make_shared< Impl >( *_impl ));
+}
+
+void Promise::setData( const PortDataPtr& data )
+{
+    _impl->set( data );
+}
+
 void Promise::_set( PortDataPtr data )
 {
     _impl->set( data );
 }
 
 Future::Future( const Promise& promise )
-    : _impl( promise._impl->_futureImpl )
+    : _promise( promise._impl )
+    , _name( promise._impl->_name )
+{}
+
+Future::Future( const Promise& promise, const std::string& name )
+    : _promise( promise._impl )
+    , _name( std::make_shared< const std::string >( name ))
 {}
 
 Future::Future( const Future& future )
-    : _impl( new Future::Impl( future._impl->_future,
-                               future.getName( ),
-                               future._impl->_uuid ))
+    : _state( future._promise ? future._promise->_state : future._state )
+    , _name( future._name )
 {}
 
 Future::~Future()
 {}
 
-std::string Future::getName() const
+const std::string& Future::getName() const
 {
-    return _impl->getName();
+    return *_name;
 }
 
 Future::Future( const Future& future, const std::string& name )
-    : _impl( new Future::Impl( future._impl->_future, name, future._impl->_uuid ))
+    : _state( future._promise ? future._promise->_state : future._state )
+    , _name( std::make_shared< const std::string >( name ))
 {
 }
 
+Future::State& Future::_getState() const
+{
+    return _promise ? *_promise->_state : *_state;
+}
+
+PortDataPtr Future::getData() const
+{
+    wait();
+    return _getState().data;
+}
+
 void Future::wait() const
 {
-    return _impl->wait();
+    _getState().wait();
 }
 
 bool Future::isReady() const
 {
-    return _impl->isReady();
+    return _getState().ready;
+}
+
+void Future::onReady( const std::function< void() >& callback ) const
+{
+    _getState().onReady( callback );
 }
 
 bool Future::operator==( const Future& future ) const
 {
-    return _impl->_uuid == future._impl->_uuid;
+    return getId() == future.getId();
+}
+
+uint64_t Future::getId() const
+{
+   return _getState().id;
 }
 
-const servus::uint128_t& Future::getId() const
+long Future::getUseCount() const
 {
-   return _impl->_uuid;
+    return _promise ? _promise->_state.use_count() : _state.use_count();
 }
 
 PortDataPtr Future::_getPtr( const std::type_index& dataType ) const
 {
-    return _impl->get( dataType );
+    wait();
+    const PortDataPtr& data = _getState().data;
+
+    if( !data )
+        LBTHROW( std::runtime_error( "Returns empty data" ));
+
+    if( data->dataType != dataType )
+        LBTHROW( std::runtime_error( "Types does not match on get value"));
+
+    return data;
 }
 
 void waitForAny( const Futures& futures )
@@ -236,12 +294,37 @@ void waitForAny( const Futures& futures )
     if( futures.empty( ))
         return;
 
-    PortDataFutures boostFutures;
-    boostFutures.reserve( futures.size( ));
     for( const auto& future: futures )
-        boostFutures.push_back( future._impl->_future );
+    {
+        if( future.isReady( ))
+            return;
+    }
+
+    // Woken by the first future set, the others call it when they are set
+    struct Waiter
+    {
+        Waiter() : ready( false ) {}
+        boost::mutex mutex;
+        boost::condition_variable condition;
+        bool ready;
+    };
+
+    const auto waiter = std::make_shared< Waiter >();
+    for( const auto& future: futures )
+    {
+        future.onReady( [waiter]
+        {
+            {
+                ScopedLock lock( waiter->mutex );
+                waiter->ready = true;
+            }
+            waiter->condition.notify_all();
+        });
+    }
 
-    boost::wait_for_any( boostFutures.begin(), boostFutures.end( ));
+    ScopedLock lock( waiter->mutex );
+    while( !waiter->ready )
+        waiter->condition.wait( lock );
 }
 
 }
@@ -24,8 +24,6 @@
 #include <livre/core/pipeline/PortData.h>
 #include <livre/core/types.h>
 
-#include <servus/uint128_t.h>
-
 namespace livre
 {
 
@@ -51,10 +49,11 @@ public:
     /**
      * @return the name of the connection
      */
-    LIVRECORE_API std::string getName() const;
+    LIVRECORE_API const std::string& getName() const;
 
     /**
-     * Sets the port with the value.
+     * Sets the port with a copy of the value. The types which are expensive
+     * to copy do not compile, they are moved in or shared with setData().
      * @param value to be set
      * @throw std::runtime_error when the port data is not exact
      * type T or there is no such port name.
@@ -62,9 +61,35 @@ public:
     template< class T >
     void set( const T& value )
     {
+        static_assert( IsCheapToCopy< T >::value,
+                       "Move the value in, or share it with makePortData()" );
         _set( std::make_shared< PortDataT< T >>( value ));
     }
 
+    /**
+     * Sets the port with the value, moved in without copy.
+     * @param value to be set
+     * @throw std::runtime_error when the port data is not exact
+     * type T or there is no such port name.
+     */
+    template< class T,
+              class = typename std::enable_if< !std::is_lvalue_reference< T >::value >::type >
+    void set( T&& value )
+    {
+        typedef typename std::remove_const< T >::type DataT;
+        static_assert( !std::is_const< T >::value || IsCheapToCopy< DataT >::value,
+                       "Move the value in, or share it with makePortData()" );
+        _set( std::make_shared< PortDataT< DataT >>( std::move( value )));
+    }
+
+    /**
+     * Sets the port with data shared with other promises and futures.
+     * @param data to be set, \see makePortData and Future::getData
+     * @throw std::runtime_error when the port data is not of the type
+     * of the port.
+     */
+    LIVRECORE_API void setData( const PortDataPtr& data );
+
     /**
      * Sets the promise with empty data if it is not set already
      */
@@ -87,13 +112,22 @@ public:
      */
     LIVRECORE_API void reset();
 
+    /**
+     * @return a promise of the data since the last reset, which is not
+     * affected by the later resets of this promise, i.e. for the execution of
+     * a filter while its pipeline is reset for the next frame.
+     */
+    LIVRECORE_API Promise getCurrent() const;
+
 private:
 
     friend class Future;
 
+    struct Impl;
+    explicit Promise( const std::shared_ptr< Impl >& impl );
+
     void _set( PortDataPtr data );
 
-    struct Impl;
     std::shared_ptr<Impl> _impl;
 };
 
@@ -117,7 +151,7 @@ public:
     /**
      * @return name of the future
      */
-    std::string getName() const;
+    const std::string& getName() const;
 
     /**
      * Constructs a shallow copy of the future with the given name
@@ -134,6 +168,13 @@ public:
     template< class T >
     const T& get() const { return _get<T>(); }
 
+    /**
+     * Gets the data to set it on other promises without copy. Blocks until
+     * data is available.
+     * @return the shared data, empty if the promise was flushed.
+     */
+    PortDataPtr getData() const;
+
     /**
      * Waits until the data is ready.
      */
@@ -144,6 +185,15 @@ public:
      */
     bool isReady() const;
 
+    /**
+     * Calls a function once the future is ready. The function is called in
+     * the thread which sets the promise, or right away in the calling thread
+     * if the future is ready already. A reset of the promise before it is set
+     * makes the future ready with empty data.
+     * @param callback the function, which should not block.
+     */
+    void onReady( const std::function< void() >& callback ) const;
+
     /**
      * @param future is the future to be checked with
      * @return true if both futures are belonging to same promise
@@ -157,9 +207,16 @@ public:
     bool operator!=( const Future& future ) const { return !(*this == future); }
 
     /**
-     * @return the unique identifier for the future
+     * @return the identifier of the future, unique to a promise and to each of
+     * its resets in the process
+     */
+    uint64_t getId() const;
+
+    /**
+     * @return the number of futures and promises sharing the data of the
+     * future, i.e. to know if a future handed out is still held.
      */
-    const servus::uint128_t& getId() const;
+    long getUseCount() const;
 
     /**
      * Promise based construction is needed when reset() on the promise
@@ -170,13 +227,18 @@ public:
      */
     Future( const Promise& promise );
 
+    /**
+     * Constructs a future following the resets of the promise, with another
+     * name, i.e. the name of the input port it is connected to.
+     * @param promise that future is retrieved
+     * @param name of the future
+     */
+    Future( const Promise& promise, const std::string& name );
+
 private:
 
     friend class Promise;
 
-    friend void waitForAny( const Futures& future );
-    friend bool operator<( const Future& future1, const Future& future2 );
-
     template< class T >
     const T& _get() const
     {
@@ -188,8 +250,14 @@ private:
 
     PortDataPtr _getPtr( const std::type_index& dataType ) const;
 
-    struct Impl;
-    std::shared_ptr<Impl> _impl;
+    struct State;
+    State& _getState() const;
+
+    // Copies share the state of the promise, unless the future is bound to
+    // the promise to follow its resets
+    std::shared_ptr< State > _state;
+    std::shared_ptr< Promise::Impl > _promise;
+    std::shared_ptr< const std::string > _name;
 };
 
 /**
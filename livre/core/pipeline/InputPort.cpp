@@ -35,7 +35,7 @@ struct InputPort::Impl
     ~Impl()
     {}
 
-    std::string getName() const
+    const std::string& getName() const
     {
         return _info.first;
     }
@@ -55,7 +55,7 @@ struct InputPort::Impl
         if( getDataType() != port.getDataType( ))
             LBTHROW( std::runtime_error( "Data types does not match between ports"));
 
-        _futures.emplace_back( port.getPromise( ));
+        _futures.emplace_back( port.getPromise(), getName( ));
     }
 
     bool disconnect( const OutputPort& port )
@@ -78,6 +78,10 @@ InputPort::InputPort( const DataInfo& dataInfo )
     : _impl( new InputPort::Impl( dataInfo ))
 {}
 
+InputPort::InputPort( InputPort&& port )
+    : _impl( std::move( port._impl ))
+{}
+
 InputPort::~InputPort()
 {}
 
@@ -96,7 +100,7 @@ bool InputPort::disconnect( const OutputPort& port )
     return _impl->disconnect( port );
 }
 
-std::string InputPort::getName() const
+const std::string& InputPort::getName() const
 {
     return _impl->getName();
 }
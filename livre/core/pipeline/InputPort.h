@@ -37,12 +37,13 @@ public:
      * @param dataInfo is the name and type information for the data.
      */
     LIVRECORE_API explicit InputPort( const DataInfo& dataInfo );
+    LIVRECORE_API InputPort( InputPort&& port );
     LIVRECORE_API ~InputPort();
 
     /**
      * @return name of the port
      */
-    LIVRECORE_API std::string getName() const;
+    LIVRECORE_API const std::string& getName() const;
 
     /**
      * @return data type of the port
@@ -55,7 +56,7 @@ public:
     LIVRECORE_API size_t getSize() const;
 
     /**
-     * @return Return all the futures this port has.
+     * @return Return all the futures this port has, named after the port.
      */
     LIVRECORE_API const Futures& getFutures() const;
 
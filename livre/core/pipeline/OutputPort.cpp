@@ -45,7 +45,7 @@ struct OutputPort::Impl
         return _promise.getDataType();
     }
 
-    std::string getName() const
+    const std::string& getName() const
     {
         return _promise.getName();
     }
@@ -62,11 +62,14 @@ OutputPort::OutputPort( const DataInfo& dataInfo )
     : _impl( new OutputPort::Impl( dataInfo ))
 {}
 
+OutputPort::OutputPort( OutputPort&& port )
+    : _impl( std::move( port._impl ))
+{}
 
 OutputPort::~OutputPort()
 {}
 
-std::string OutputPort::getName() const
+const std::string& OutputPort::getName() const
 {
     return _impl->getName();
 }
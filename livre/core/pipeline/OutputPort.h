@@ -36,12 +36,13 @@ public:
      * @param dataInfo is the name and type information for the data.
      */
     LIVRECORE_API explicit OutputPort( const DataInfo& dataInfo );
+    LIVRECORE_API OutputPort( OutputPort&& port );
     LIVRECORE_API ~OutputPort();
 
     /**
      * @return name of the port
      */
-    LIVRECORE_API std::string getName() const;
+    LIVRECORE_API const std::string& getName() const;
 
     /**
      * @return data type of the port
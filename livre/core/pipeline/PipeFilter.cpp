@@ -23,69 +23,79 @@
 #include <livre/core/pipeline/PromiseMap.h>
 #include <livre/core/pipeline/FutureMap.h>
 #include <livre/core/pipeline/PipeFilter.h>
+#include <livre/core/pipeline/PipelineTrace.h>
 #include <livre/core/pipeline/FuturePromise.h>
 #include <livre/core/pipeline/Filter.h>
 
 #include <lunchbox/debug.h>
 
+#include <algorithm>
+#include <atomic>
+
 namespace livre
 {
+namespace
+{
+template< class PortsT >
+PortId findPort( const PortsT& ports, const std::string& portName )
+{
+    const auto& it = std::lower_bound( ports.begin(), ports.end(), portName,
+                                       []( const typename PortsT::value_type& port,
+                                           const std::string& name )
+                                       { return port.getName() < name; });
+    if( it == ports.end() || it->getName() != portName )
+        LBTHROW( std::runtime_error( std::string( "There is no port with name: ")
+                                     + portName ));
+    return PortId( it - ports.begin( ));
+}
 
-struct PipeFilter::Impl
+void checkPort( const size_t nPorts, const PortId port )
+{
+    if( port >= nPorts )
+        LBTHROW( std::runtime_error( std::string( "There is no port with id: ")
+                                     + std::to_string( port )));
+}
+}
+
+PortId getPortId( const DataInfos& dataInfos, const std::string& portName )
 {
-    typedef std::map< std::string, OutputPort > OutputPortMap;
-    typedef std::map< std::string, InputPort > InputPortMap;
+    const auto& it = dataInfos.find( portName );
+    if( it == dataInfos.end( ))
+        LBTHROW( std::runtime_error( std::string( "There is no port with name: ")
+                                     + portName ));
+    return PortId( std::distance( dataInfos.begin(), it ));
+}
 
+struct PipeFilter::Impl
+{
     Impl( PipeFilter& pipeFilter,
           const std::string& name,
           FilterPtr filter )
         : _pipeFilter( pipeFilter )
         , _name( name )
         , _filter( std::move( filter ))
+        , _priority( PRIORITY_NORMAL )
+        , _frame( 0 )
+        , _scheduleTime( 0 )
     {
-        for( const DataInfo& dataInfo: _filter->getInputDataInfos( ))
-        {
-            _inputMap.emplace( std::piecewise_construct,
-                               std::forward_as_tuple( dataInfo.first ),
-                               std::forward_as_tuple( dataInfo ));
-        }
-
-        for( const DataInfo& dataInfo: _filter->getOutputDataInfos( ))
-        {
-            _outputMap.emplace( std::piecewise_construct,
-                                std::forward_as_tuple( dataInfo.first ),
-                                std::forward_as_tuple( dataInfo ));
-        }
-    }
-
-    bool hasInputPort( const std::string& portName ) const
-    {
-        return _inputMap.count( portName ) > 0;
-    }
-
-    bool hasOutputPort( const std::string& portName ) const
-    {
-        return _outputMap.count( portName ) > 0;
-    }
-
-    void throwPortError( const std::string& portName ) const
-    {
-        LBTHROW( std::runtime_error( std::string( "There is no port with name: ")
-                                                  + portName ));
+        // The data infos are sorted by name, the ports are in the same order
+        const DataInfos& inputDataInfos = _filter->getInputDataInfos();
+        _inputs.reserve( inputDataInfos.size( ));
+        for( const DataInfo& dataInfo: inputDataInfos )
+            _inputs.emplace_back( dataInfo );
+        _manuallySetPorts.resize( _inputs.size( ));
+
+        const DataInfos& outputDataInfos = _filter->getOutputDataInfos();
+        _outputs.reserve( outputDataInfos.size( ));
+        for( const DataInfo& dataInfo: outputDataInfos )
+            _outputs.emplace_back( dataInfo );
     }
 
     void execute()
     {
-        Futures inputFutures;
-        for( const auto& namePort: _inputMap )
-        {
-            const Futures& futures = namePort.second.getFutures();
-            for( const auto& future: futures )
-                inputFutures.emplace_back( future, namePort.second.getName( ));
-        }
-
-        const FutureMap futures( inputFutures );
-        PromiseMap promises( getOutputPromises( ));
+        const uint64_t startTime = PipelineTrace::isEnabled() ? PipelineTrace::getTime() : 0;
+        const FutureMap futures( _inputs );
+        PromiseMap promises( _outputs );
 
         try
         {
@@ -95,102 +105,93 @@ struct PipeFilter::Impl
         catch( const std::runtime_error& err )
         {
             promises.flush();
+            notifyExecution( startTime );
             throw err;
         }
         catch( const std::logic_error& err )
         {
             promises.flush();
+            notifyExecution( startTime );
             throw err;
         }
+        notifyExecution( startTime );
     }
 
-    Promise getInputPromise( const std::string& portName )
+    void notifyExecution( const uint64_t startTime )
     {
-        if( !hasInputPort( portName ))
-            throwPortError( portName );
-
-        const auto& itPromise = _manuallySetPortsMap.find( portName );
-        if( itPromise != _manuallySetPortsMap.end( ))
-            return itPromise->second.getPromise();
-
-        InputPort& inputPort = _inputMap.find( portName )->second;
-        const auto& itPort =  _manuallySetPortsMap.emplace( std::piecewise_construct,
-                                      std::forward_as_tuple( inputPort.getName( )),
-                                      std::forward_as_tuple( DataInfo( inputPort.getName(),
-                                                                       inputPort.getDataType( ))));
-        OutputPort& outputPort = itPort.first->second;
-        inputPort.connect( outputPort );
-        return outputPort.getPromise();
+        const uint64_t scheduleTime = _scheduleTime.exchange( 0 );
+        if( startTime > 0 )
+            PipelineTrace::notifyExecution( _name, _frame, scheduleTime, startTime,
+                                            PipelineTrace::getTime( ));
     }
 
-    Promises getOutputPromises() const
+    Promise getInputPromise( const PortId port )
     {
-        Promises promises;
-        for( const auto& namePort: _outputMap )
-            promises.push_back( namePort.second.getPromise( ));
+        checkPort( _inputs.size(), port );
+
+        std::unique_ptr< OutputPort >& outputPort = _manuallySetPorts[ port ];
+        if( outputPort )
+            return outputPort->getPromise();
 
-        return promises;
+        InputPort& inputPort = _inputs[ port ];
+        outputPort.reset( new OutputPort( DataInfo( inputPort.getName(),
+                                                    inputPort.getDataType( ))));
+        inputPort.connect( *outputPort );
+        return outputPort->getPromise();
     }
 
     Futures getPostconditions() const
     {
         Futures futures;
-        for( const auto& namePort: _outputMap )
-        {
-            const Future& outputFuture = namePort.second.getPromise().getFuture();
-            futures.push_back( outputFuture );
-        }
+        for( const OutputPort& port: _outputs )
+            futures.push_back( port.getPromise().getFuture( ));
         return futures;
     }
 
     Futures getPreconditions() const
     {
         Futures futures;
-        for( const auto& namePort: _inputMap )
+        for( const InputPort& port: _inputs )
         {
-            const Futures& inputFutures = namePort.second.getFutures();
+            const Futures& inputFutures = port.getFutures();
             futures.insert( futures.end(), inputFutures.begin(), inputFutures.end( ));
         }
         return futures;
     }
 
-    void connect( const std::string& srcPortName,
+    void connect( const PortId srcPort,
                   Impl& dstImpl,
-                  const std::string& dstPortName )
+                  const PortId dstPort )
     {
-        if( !hasOutputPort( srcPortName ))
-            throwPortError( srcPortName );
-
-        if( !dstImpl.hasInputPort( dstPortName ))
-            throwPortError( dstPortName );
-
-        // The value on the output port may already be set
-        if( !dstImpl._manuallySetPortsMap.count( dstPortName ))
-            std::runtime_error( std::string( "The value on port:  ")
-                                + dstPortName
-                                + "is already set" );
-
-        _outputMap.find( srcPortName )->second.connect(
-                    dstImpl._inputMap.find( dstPortName )->second );
+        checkPort( _outputs.size(), srcPort );
+        checkPort( dstImpl._inputs.size(), dstPort );
+        _outputs[ srcPort ].connect( dstImpl._inputs[ dstPort ]);
     }
 
     void reset()
     {
-        for( auto& namePort: _manuallySetPortsMap )
-            _inputMap.find( namePort.first )->second.disconnect( namePort.second );
+        for( size_t i = 0; i < _inputs.size(); ++i )
+        {
+            if( !_manuallySetPorts[ i ] )
+                continue;
 
-        _manuallySetPortsMap.clear();
-        for( auto& namePort: _outputMap )
-            namePort.second.reset();
+            _inputs[ i ].disconnect( *_manuallySetPorts[ i ]);
+            _manuallySetPorts[ i ].reset();
+        }
 
+        for( OutputPort& port: _outputs )
+            port.reset();
     }
 
     PipeFilter& _pipeFilter;
     const std::string _name;
     const FilterPtr _filter;
-    InputPortMap _inputMap;
-    OutputPortMap _outputMap;
-    OutputPortMap _manuallySetPortsMap;
+    InputPorts _inputs;
+    OutputPorts _outputs;
+    std::vector< std::unique_ptr< OutputPort >> _manuallySetPorts; // per input
+    std::atomic< ExecutablePriority > _priority;
+    std::atomic< uint32_t > _frame;
+    std::atomic< uint64_t > _scheduleTime; // When queued in the workers, if traced
 };
 
 PipeFilter::PipeFilter( const std::string& name,
@@ -213,7 +214,28 @@ std::string PipeFilter::getName() const
 
 Promise PipeFilter::getPromise( const std::string& portName )
 {
-    return _impl->getInputPromise( portName );
+    return _impl->getInputPromise( getInputPortId( portName ));
+}
+
+Promise PipeFilter::getPromise( const PortId port )
+{
+    return _impl->getInputPromise( port );
+}
+
+Future PipeFilter::getFuture( const PortId port ) const
+{
+    checkPort( _impl->_outputs.size(), port );
+    return _impl->_outputs[ port ].getPromise().getFuture();
+}
+
+PortId PipeFilter::getInputPortId( const std::string& portName ) const
+{
+    return findPort( _impl->_inputs, portName );
+}
+
+PortId PipeFilter::getOutputPortId( const std::string& portName ) const
+{
+    return findPort( _impl->_outputs, portName );
 }
 
 void PipeFilter::execute()
@@ -236,11 +258,43 @@ void PipeFilter::reset()
     _impl->reset();
 }
 
+void PipeFilter::setPriority( const ExecutablePriority priority )
+{
+    _impl->_priority = priority;
+}
+
+ExecutablePriority PipeFilter::getPriority() const
+{
+    return _impl->_priority;
+}
+
+void PipeFilter::setFrame( const uint32_t frame )
+{
+    _impl->_frame = frame;
+}
+
+uint32_t PipeFilter::getFrame() const
+{
+    return _impl->_frame;
+}
+
+void PipeFilter::notifyScheduled()
+{
+    if( PipelineTrace::isEnabled( ))
+        _impl->_scheduleTime = PipelineTrace::getTime();
+}
+
 void PipeFilter::connect( const std::string& srcPortName,
                           PipeFilter& dst,
                           const std::string& dstPortName )
 {
-    _impl->connect( srcPortName, *dst._impl, dstPortName );
+    _impl->connect( getOutputPortId( srcPortName ), *dst._impl,
+                    dst.getInputPortId( dstPortName ));
+}
+
+void PipeFilter::connect( const PortId srcPort, PipeFilter& dst, const PortId dstPort )
+{
+    _impl->connect( srcPort, *dst._impl, dstPort );
 }
 
 }
@@ -30,6 +30,8 @@ namespace livre
 /**
  * Responsible for execution of the Filter objects by constructing
  * the communication layer ( output ports, input ports ) around the filter.
+ * The ports are named for the setup of the connections, and have ids, their
+ * indices in the sorted ports of the filter, \see getPortId.
  * Accesing the copies of the object from other threads for non-const functions
  * is not thread safe.
  */
@@ -56,6 +58,15 @@ public:
                   PipeFilter& dst,
                   const std::string& dstPortName );
 
+    /**
+     * Connects to given pipe filter with the given port ids, \see connect.
+     * @param srcPort is the id of the output port.
+     * @param dst is the destination pipe filter.
+     * @param dstPort is the id of the input port of the destination.
+     * @throw std::runtime_error if connection can not be established
+     */
+    LIVRECORE_API void connect( PortId srcPort, PipeFilter& dst, PortId dstPort );
+
     /**
      * @return promise for the given input port. If there is no connection to the
      * input port, a new promise is created for the port and no further connections are allowed,
@@ -65,6 +76,35 @@ public:
      */
     LIVRECORE_API Promise getPromise( const std::string& portName );
 
+    /**
+     * @param port the id of the input port.
+     * @return promise for the given input port, \see getPromise.
+     * @throw std::runtime_error if there is no input port with the id
+     */
+    LIVRECORE_API Promise getPromise( PortId port );
+
+    /**
+     * @param port the id of the output port.
+     * @return the future of the output port, which is not affected by the
+     * later resets of the filter.
+     * @throw std::runtime_error if there is no output port with the id
+     */
+    LIVRECORE_API Future getFuture( PortId port ) const;
+
+    /**
+     * @param portName the name of the input port.
+     * @return the id of the input port.
+     * @throw std::runtime_error if there is no input port with the name
+     */
+    LIVRECORE_API PortId getInputPortId( const std::string& portName ) const;
+
+    /**
+     * @param portName the name of the output port.
+     * @return the id of the output port.
+     * @throw std::runtime_error if there is no output port with the name
+     */
+    LIVRECORE_API PortId getOutputPortId( const std::string& portName ) const;
+
     /**
      * @copydoc Executable::execute
      */
@@ -85,6 +125,27 @@ public:
      */
     LIVRECORE_API void reset() final;
 
+    /**
+     * Sets the scheduling priority, which is shared by the copies.
+     * @param priority of the filter, normal by default.
+     */
+    LIVRECORE_API void setPriority( ExecutablePriority priority );
+
+    /** @copydoc Executable::getPriority */
+    LIVRECORE_API ExecutablePriority getPriority() const final;
+
+    /**
+     * Sets the frame the filter works for, which is shared by the copies.
+     * @param frame the frame number, 0 if the filter does not belong to a frame.
+     */
+    LIVRECORE_API void setFrame( uint32_t frame );
+
+    /** @copydoc Executable::getFrame */
+    LIVRECORE_API uint32_t getFrame() const final;
+
+    /** @copydoc Executable::notifyScheduled */
+    LIVRECORE_API void notifyScheduled() final;
+
 protected:
 
     /**
@@ -18,114 +18,157 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <livre/core/pipeline/FutureMap.h>
+#include <livre/core/pipeline/FuturePromise.h>
 #include <livre/core/pipeline/Pipeline.h>
 
 #include <lunchbox/debug.h>
 
+#include <set>
+#include <unordered_map>
+
 namespace livre
 {
 
 struct Pipeline::Impl
 {
-    typedef std::map< std::string, const Pipeline > PipelineMap;
-    typedef std::map< std::string, const PipeFilter > PipeFilterMap;
-    typedef std::map< std::string, std::unique_ptr< Executable >> ExecutableMap;
+    typedef std::unordered_map< std::string, size_t > IndexMap;
+    typedef std::vector< size_t > Indices;
 
     Impl( Pipeline& pipeline )
         : _pipeline( pipeline )
+        , _compiled( false )
     {}
 
     void add( const std::string& name,
               Pipeline::UniqueExecutablePtr executable,
               bool wait )
     {
-        if( _executableMap.count( name ) > 0 )
+        if( _indices.count( name ) > 0 )
             LBTHROW( std::runtime_error( name + " already exists"));
 
+        _indices[ name ] = _executables.size();
         if( wait )
-        {
-            const Futures& futures = executable->getPostconditions();
-            _outFutures.insert( _outFutures.end(), futures.begin(), futures.end( ));
-        }
-
-        _executableMap.emplace( std::piecewise_construct,
-                                std::forward_as_tuple( name ),
-                                std::forward_as_tuple( std::move( executable )));
+            _waited.push_back( _executables.size( ));
+        _executables.push_back( std::move( executable ));
+        _compiled = false;
     }
 
-    void execute()
+    // Orders the executables so that every executable comes after the ones
+    // producing its preconditions. The order is kept across resets, as the
+    // connections of the executables do not change.
+    void compile()
     {
-        Executables executables = getExecutables();
-        Executables::iterator it = executables.begin();
-        while( !executables.empty( ))
+        if( _compiled )
+            return;
+
+        std::unordered_map< uint64_t, size_t > producers;
+        for( size_t i = 0; i < _executables.size(); ++i )
         {
-            Executable* executable = *it;
-            const FutureMap futureMap( executable->getPreconditions( ));
-            if( futureMap.isReady( ))
+            for( const Future& future: _executables[ i ]->getPostconditions( ))
+                producers[ future.getId() ] = i;
+        }
+
+        std::vector< Indices > consumers( _executables.size( ));
+        std::vector< size_t > nProducers( _executables.size(), 0 );
+        for( size_t i = 0; i < _executables.size(); ++i )
+        {
+            std::set< size_t > dependencies;
+            for( const Future& future: _executables[ i ]->getPreconditions( ))
             {
-                executable->execute();
-                executables.erase( it );
-                it = executables.begin();
+                const auto& it = producers.find( future.getId( ));
+                if( it != producers.end() && it->second != i )
+                    dependencies.insert( it->second );
             }
-            else
+
+            for( const size_t dependency: dependencies )
+                consumers[ dependency ].push_back( i );
+            nProducers[ i ] = dependencies.size();
+        }
+
+        // The executables without dependencies keep the order they are added
+        Indices order;
+        order.reserve( _executables.size( ));
+        for( size_t i = 0; i < _executables.size(); ++i )
+        {
+            if( nProducers[ i ] == 0 )
+                order.push_back( i );
+        }
+
+        for( size_t i = 0; i < order.size(); ++i )
+        {
+            for( const size_t consumer: consumers[ order[ i ]])
             {
-                if( it == executables.end( ))
-                    break;
-                ++it;
+                if( --nProducers[ consumer ] == 0 )
+                    order.push_back( consumer );
             }
         }
-    }
 
-    Executables getExecutables() const
-    {
-        Executables executables;
+        if( order.size() != _executables.size( ))
+            LBTHROW( std::runtime_error( "The pipeline has a cycle" ));
 
-        for( auto& nameExec: _executableMap )
-            executables.push_back( nameExec.second.get( ));
+        _order.swap( order );
+        _compiled = true;
+    }
 
-        return executables;
+    void execute()
+    {
+        compile();
+        for( const size_t index: _order )
+            _executables[ index ]->execute();
     }
 
     Executable& getExecutable( const std::string& name )
     {
-        if( _executableMap.count( name ) == 0 )
+        const auto& it = _indices.find( name );
+        if( it == _indices.end( ))
             LBTHROW( std::runtime_error( name + " executable does not exist"));
 
-        return *_executableMap.find( name )->second;
+        return *_executables[ it->second ];
     }
 
     Futures getPreconditions() const
     {
         Futures inFutures;
-        for( auto& nameExec: _executableMap )
+        for( const auto& executable: _executables )
         {
-            const Futures& futures = nameExec.second->getPreconditions();
+            const Futures& futures = executable->getPreconditions();
             inFutures.insert( inFutures.end(), futures.begin(), futures.end( ));
         }
         return inFutures;
     }
 
+    // Queried at every call, as a reset renews the futures of the executables
     Futures getPostconditions() const
     {
-        return _outFutures;
+        Futures outFutures;
+        for( const size_t index: _waited )
+        {
+            const Futures& futures = _executables[ index ]->getPostconditions();
+            outFutures.insert( outFutures.end(), futures.begin(), futures.end( ));
+        }
+        return outFutures;
     }
 
+    // The producers are scheduled before their consumers
     void schedule( Executor& executor )
     {
-        for( auto& nameExec: _executableMap )
-            executor.schedule( nameExec.second->clone( ));
+        compile();
+        for( const size_t index: _order )
+            executor.schedule( _executables[ index ]->clone( ));
     }
 
     void reset()
     {
-        for( auto& nameExec: _executableMap )
-            nameExec.second->reset();
+        for( const auto& executable: _executables )
+            executable->reset();
     }
 
     Pipeline& _pipeline;
-    ExecutableMap _executableMap;
-    Futures _outFutures;
+    std::vector< Pipeline::UniqueExecutablePtr > _executables;
+    IndexMap _indices;
+    Indices _waited;
+    Indices _order;
+    bool _compiled;
 };
 
 Pipeline::Pipeline()
@@ -31,6 +31,11 @@ namespace livre
 /**
  * Implements the executable graph. Accesing the copies of the object from
  * other threads for non-const functions is not thread safe.
+ *
+ * The graph is compiled once, at the first execution or scheduling after an
+ * executable is added, into a topological order of the executables. The
+ * connections of the executables should not change afterwards: the pipeline
+ * is reused for every frame with reset() and new inputs.
  */
 class Pipeline : public Executable
 {
@@ -86,7 +91,9 @@ public:
     LIVRECORE_API Executable& getExecutable( const std::string& name );
 
     /**
-     * @copydoc Executable::execute
+     * Executes the executables in the calling thread, every one after the
+     * producers of its preconditions.
+     * @throw std::runtime_error if the executables have cyclic connections
      */
     LIVRECORE_API void execute() final;
 
@@ -0,0 +1,305 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/pipeline/PipelineTrace.h>
+
+#include <lunchbox/debug.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include <sys/prctl.h>
+#include <unistd.h>
+
+namespace livre
+{
+namespace
+{
+const size_t maxEventsPerThread = 4096;
+
+typedef std::chrono::steady_clock Clock;
+const Clock::time_point clockOrigin = Clock::now();
+
+// The latest events of a thread. Only the thread writes them, the readers
+// discard the events which may have been overwritten while they are read.
+struct ThreadBuffer
+{
+    ThreadBuffer( const uint32_t index_, const std::string& name_ )
+        : index( index_ )
+        , name( name_ )
+        , events( maxEventsPerThread )
+        , count( 0 )
+    {}
+
+    const uint32_t index;
+    const std::string name;
+    std::vector< TraceEvent > events;
+    std::atomic< uint64_t > count; // The events recorded so far
+};
+
+typedef std::shared_ptr< ThreadBuffer > ThreadBufferPtr;
+
+// The buffers of the threads which recorded events, kept once the threads
+// exit until the next trace is written
+boost::mutex buffersMutex;
+std::vector< ThreadBufferPtr > threadBuffers;
+uint32_t nThreads = 0;
+
+std::atomic< bool > traceEnabled( false );
+std::atomic< uint32_t > nRecorders( 0 ); // The trace and the flight recorders
+
+ThreadBuffer& getThreadBuffer()
+{
+    static thread_local ThreadBufferPtr buffer;
+    if( !buffer )
+    {
+        char name[ 17 ] = { 0 };
+        prctl( PR_GET_NAME, name, 0, 0, 0 );
+
+        ScopedLock lock( buffersMutex );
+        buffer = std::make_shared< ThreadBuffer >( nThreads++, name );
+        threadBuffers.push_back( buffer );
+    }
+    return *buffer;
+}
+
+TraceEvents collectEvents( const uint64_t startTime )
+{
+    TraceEvents events;
+    ScopedLock lock( buffersMutex );
+    for( const ThreadBufferPtr& buffer: threadBuffers )
+    {
+        const uint64_t end = buffer->count.load( std::memory_order_acquire );
+        const uint64_t begin = end > maxEventsPerThread ? end - maxEventsPerThread : 0;
+
+        TraceEvents threadEvents;
+        threadEvents.reserve( end - begin );
+        for( uint64_t i = begin; i < end; ++i )
+            threadEvents.push_back( buffer->events[ i % maxEventsPerThread ]);
+
+        // The slots reused since the copy started hold other events
+        std::atomic_thread_fence( std::memory_order_acquire );
+        const uint64_t count = buffer->count.load( std::memory_order_relaxed );
+        const uint64_t valid = count >= maxEventsPerThread ?
+                               count - maxEventsPerThread + 1 : 0;
+
+        for( uint64_t i = std::max( begin, valid ); i < end; ++i )
+        {
+            const TraceEvent& event = threadEvents[ i - begin ];
+            if( event.startTime >= startTime )
+                events.push_back( event );
+        }
+    }
+
+    std::sort( events.begin(), events.end(),
+               []( const TraceEvent& event1, const TraceEvent& event2 )
+               { return event1.startTime < event2.startTime; });
+    return events;
+}
+
+// Forgets the threads which exited, once nothing records
+void removeRecorder()
+{
+    if( --nRecorders > 0 )
+        return;
+
+    ScopedLock lock( buffersMutex );
+    threadBuffers.erase( std::remove_if( threadBuffers.begin(), threadBuffers.end(),
+                                         []( const ThreadBufferPtr& buffer )
+                                         { return buffer.use_count() == 1; }),
+                         threadBuffers.end( ));
+}
+
+void writeString( std::ostream& os, const char* string )
+{
+    os << '"';
+    for( ; *string; ++string )
+    {
+        const char c = *string;
+        if( c == '"' || c == '\\' )
+            os << '\\' << c;
+        else if( static_cast< unsigned char >( c ) >= 0x20 )
+            os << c;
+    }
+    os << '"';
+}
+}
+
+struct PipelineTrace::Impl
+{
+    explicit Impl( const std::string& filename )
+        : _startTime( getTime( ))
+    {
+        bool enabled = false;
+        if( !traceEnabled.compare_exchange_strong( enabled, true ))
+            LBTHROW( std::runtime_error( "Another pipeline trace is enabled" ));
+
+        ++nRecorders;
+        _file.open( filename.c_str(), std::ios::out | std::ios::trunc );
+        if( !_file )
+        {
+            traceEnabled = false;
+            removeRecorder();
+            LBTHROW( std::runtime_error( "Cannot create pipeline trace " + filename ));
+        }
+    }
+
+    ~Impl()
+    {
+        const TraceEvents& events = collectEvents( _startTime );
+        traceEnabled = false;
+        write( events, _file );
+        removeRecorder();
+    }
+
+    const uint64_t _startTime;
+    std::ofstream _file;
+};
+
+PipelineTrace::PipelineTrace( const std::string& filename )
+    : _impl( new PipelineTrace::Impl( filename ))
+{}
+
+PipelineTrace::~PipelineTrace()
+{}
+
+TraceEvents PipelineTrace::getEvents() const
+{
+    return collectEvents( _impl->_startTime );
+}
+
+bool PipelineTrace::isEnabled()
+{
+    return nRecorders.load( std::memory_order_relaxed ) > 0;
+}
+
+void PipelineTrace::startRecording()
+{
+    ++nRecorders;
+}
+
+void PipelineTrace::stopRecording()
+{
+    removeRecorder();
+}
+
+TraceEvents PipelineTrace::getEvents( const uint64_t startTime )
+{
+    return collectEvents( startTime );
+}
+
+uint64_t PipelineTrace::getTime()
+{
+    // Starts at 1, 0 is the time of the events which did not happen
+    return std::chrono::duration_cast< std::chrono::microseconds >(
+                Clock::now() - clockOrigin ).count() + 1;
+}
+
+void PipelineTrace::notifyExecution( const std::string& name, const uint32_t frame,
+                                     const uint64_t scheduleTime,
+                                     const uint64_t startTime, const uint64_t endTime )
+{
+    if( !isEnabled( ))
+        return;
+
+    ThreadBuffer& buffer = getThreadBuffer();
+    const uint64_t count = buffer.count.load( std::memory_order_relaxed );
+    TraceEvent& event = buffer.events[ count % maxEventsPerThread ];
+
+    const size_t length = std::min( name.size(), sizeof( event.name ) - 1 );
+    std::memcpy( event.name, name.c_str(), length );
+    event.name[ length ] = 0;
+    event.frame = frame;
+    event.thread = buffer.index;
+    event.scheduleTime = scheduleTime;
+    event.startTime = startTime;
+    event.endTime = endTime;
+
+    buffer.count.store( count + 1, std::memory_order_release );
+}
+
+void PipelineTrace::write( const TraceEvents& events, std::ostream& os )
+{
+    os << "{";
+    writeEvents( events, os );
+    os << ",\"displayTimeUnit\":\"ms\"}" << std::endl;
+}
+
+void PipelineTrace::writeEvents( const TraceEvents& events, std::ostream& os )
+{
+    std::map< uint32_t, std::string > threadNames;
+    {
+        ScopedLock lock( buffersMutex );
+        for( const ThreadBufferPtr& buffer: threadBuffers )
+            threadNames[ buffer->index ] = buffer->name;
+    }
+
+    const pid_t pid = getpid();
+    os << "\"traceEvents\":[" << std::endl;
+    for( const auto& threadName: threadNames )
+    {
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+           << ",\"tid\":" << threadName.first << ",\"args\":{\"name\":";
+        writeString( os, threadName.second.c_str( ));
+        os << "}}," << std::endl;
+    }
+
+    // The executions on the timelines of their threads, and the waits in the
+    // queues of the workers on a timeline of their own
+    size_t id = 0;
+    for( const TraceEvent& event: events )
+    {
+        const bool queued = event.scheduleTime > 0 && event.scheduleTime <= event.startTime;
+        const uint64_t queueWait = queued ? event.startTime - event.scheduleTime : 0;
+
+        os << "{\"name\":";
+        writeString( os, event.name );
+        os << ",\"cat\":\"filter\",\"ph\":\"X\",\"pid\":" << pid
+           << ",\"tid\":" << event.thread
+           << ",\"ts\":" << event.startTime
+           << ",\"dur\":" << event.endTime - event.startTime
+           << ",\"args\":{\"frame\":" << event.frame
+           << ",\"queueWait\":" << queueWait << "}}";
+
+        if( queued )
+        {
+            for( const char* phase: { "b", "e" })
+            {
+                os << "," << std::endl << "{\"name\":";
+                writeString( os, event.name );
+                os << ",\"cat\":\"queue\",\"ph\":\"" << phase << "\",\"id\":" << id
+                   << ",\"pid\":" << pid << ",\"tid\":" << event.thread
+                   << ",\"ts\":" << ( *phase == 'b' ? event.scheduleTime : event.startTime )
+                   << "}";
+            }
+            ++id;
+        }
+        os << "," << std::endl;
+    }
+
+    // The trailing commas are not allowed by all readers
+    os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+       << ",\"args\":{\"name\":\"livre\"}}" << std::endl << "]";
+}
+
+}
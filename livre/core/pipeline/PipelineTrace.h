@@ -0,0 +1,170 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _PipelineTrace_h_
+#define _PipelineTrace_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+
+/** An execution recorded by a \see PipelineTrace, the times are in microseconds */
+struct TraceEvent
+{
+    char name[ 48 ]; //!< The name of the filter, truncated
+    uint32_t frame; //!< The frame the filter worked for, 0 if none
+    uint32_t thread; //!< The index of the recording thread in the process
+    uint64_t scheduleTime; //!< When it was queued in the workers, 0 if it was not
+    uint64_t startTime; //!< When the execution started
+    uint64_t endTime; //!< When the execution ended
+};
+
+typedef std::vector< TraceEvent > TraceEvents;
+
+/**
+ * Records the executions of the filters of the process as Chrome trace
+ * events, to see in chrome://tracing where the time of the frames goes. For
+ * each execution, the queue wait in the workers, the start and end times,
+ * the thread and the frame number are recorded.
+ *
+ * Only one trace is enabled at once in the process, and the flight recorders
+ * share its recording, \see FlightRecorder. The events are recorded without
+ * locks in a ring buffer of each thread, which keeps its latest events, so
+ * the trace is cheap enough to leave enabled. The file is written once the
+ * trace is destroyed. The methods are thread safe.
+ */
+class PipelineTrace
+{
+public:
+
+    /**
+     * Creates the trace file, replacing an existing one, and enables the
+     * trace of the process.
+     * @param filename the name of the trace file.
+     * @throw std::runtime_error if the file cannot be created or another
+     * trace is enabled
+     */
+    LIVRECORE_API explicit PipelineTrace( const std::string& filename );
+
+    /** Disables the trace and writes the trace file */
+    LIVRECORE_API ~PipelineTrace();
+
+    /**
+     * @return the events recorded since the trace is enabled, which are
+     * still in the buffers of the threads, sorted by start time
+     */
+    LIVRECORE_API TraceEvents getEvents() const;
+
+    /**
+     * @return true if the executions are recorded, for a trace or a flight
+     * recorder, \see startRecording
+     */
+    LIVRECORE_API static bool isEnabled();
+
+    /**
+     * Records the executions without a trace, until the matching
+     * stopRecording call, i.e. for a \see FlightRecorder. The calls are
+     * counted.
+     */
+    LIVRECORE_API static void startRecording();
+
+    /** Stops the recording of a startRecording call */
+    LIVRECORE_API static void stopRecording();
+
+    /**
+     * @param startTime the earliest start time of the events.
+     * @return the recorded events which are still in the buffers of the
+     * threads, sorted by start time
+     */
+    LIVRECORE_API static TraceEvents getEvents( uint64_t startTime );
+
+    /** @return the current time of the traces, in microseconds */
+    LIVRECORE_API static uint64_t getTime();
+
+    /**
+     * Records an execution in the buffer of the calling thread, if the
+     * executions are recorded.
+     * @param name the name of the filter.
+     * @param frame the frame the filter worked for, 0 if none.
+     * @param scheduleTime when it was queued in the workers, 0 if it was not.
+     * @param startTime when the execution started, \see getTime.
+     * @param endTime when the execution ended.
+     */
+    LIVRECORE_API static void notifyExecution( const std::string& name, uint32_t frame,
+                                               uint64_t scheduleTime, uint64_t startTime,
+                                               uint64_t endTime );
+
+    /**
+     * Writes events in the Chrome trace event format.
+     * @param events the events to write.
+     * @param os the stream to write to.
+     */
+    LIVRECORE_API static void write( const TraceEvents& events, std::ostream& os );
+
+    /**
+     * Writes the "traceEvents" member of a Chrome trace object, to write
+     * events along with other data.
+     * @param events the events to write.
+     * @param os the stream to write to.
+     */
+    LIVRECORE_API static void writeEvents( const TraceEvents& events, std::ostream& os );
+
+private:
+
+    struct Impl;
+    std::unique_ptr< Impl > _impl;
+};
+
+/**
+ * Records the scope it lives in as an execution in the pipeline trace, i.e.
+ * the compositing of a channel.
+ */
+class ScopedTrace
+{
+public:
+
+    /**
+     * @param name the name of the execution, which has to outlive the scope.
+     * @param frame the frame of the execution, 0 if none.
+     */
+    ScopedTrace( const char* name, const uint32_t frame )
+        : _name( name )
+        , _frame( frame )
+        , _startTime( PipelineTrace::isEnabled() ? PipelineTrace::getTime() : 0 )
+    {}
+
+    ~ScopedTrace()
+    {
+        if( _startTime > 0 )
+            PipelineTrace::notifyExecution( _name, _frame, 0, _startTime,
+                                            PipelineTrace::getTime( ));
+    }
+
+private:
+
+    const char* const _name;
+    const uint32_t _frame;
+    const uint64_t _startTime;
+};
+
+}
+
+#endif // _PipelineTrace_h_
@@ -22,9 +22,29 @@
 
 #include <livre/core/types.h>
 
+#include <type_traits>
+
 namespace livre
 {
 
+namespace detail
+{
+template< class T > struct VoidType { typedef void type; };
+}
+
+/**
+ * Is true for the types copied when they are set on a promise. The types
+ * with an allocator, i.e. the standard containers, are copied in a time
+ * growing with their size, so they have to be moved in or shared, \see
+ * makePortData. Specialize it for other types which are expensive to copy.
+ */
+template< class T, class = void >
+struct IsCheapToCopy : std::true_type {};
+
+template< class T >
+struct IsCheapToCopy< T, typename detail::VoidType< typename T::allocator_type >::type >
+    : std::false_type {};
+
 /**
  * Base class for keeping the track for types of data
  * by using the std::type_index.
@@ -55,6 +75,15 @@ struct PortDataT final : public PortData
         , data( data_ )
     {}
 
+    /**
+     * Constructor
+     * @param data_ is moved
+     */
+    explicit PortDataT( T&& data_ )
+        : PortData( getType< T >())
+        , data( std::move( data_ ))
+    {}
+
     ~PortDataT() {}
     const T data;
 
@@ -63,6 +92,18 @@ struct PortDataT final : public PortData
     PortDataT< T >& operator=( const PortDataT< T >& ) = delete;
 };
 
+/**
+ * @param data is moved in, or copied once if it is an lvalue.
+ * @return the data, which can be set on several promises without copies,
+ * \see Promise::setData
+ */
+template< class T >
+PortDataPtr makePortData( T&& data )
+{
+    typedef typename std::decay< T >::type DataT;
+    return std::make_shared< PortDataT< DataT >>( std::forward< T >( data ));
+}
+
 }
 
 #endif // _PortData_h_
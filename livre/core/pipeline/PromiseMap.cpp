@@ -18,83 +18,130 @@
  */
 
 #include <livre/core/pipeline/PromiseMap.h>
+#include <livre/core/pipeline/OutputPort.h>
 
 #include <lunchbox/debug.h>
 
-namespace livre
-{
+#include <algorithm>
+#include <atomic>
 
-namespace
+namespace livre
 {
 
-const std::string ALL_PROMISES = "ALL_PROMISES";
-
-}
-
-typedef std::map< std::string, Promise > NamePromiseMap;
-typedef NamePromiseMap::value_type NamePromisePair;
-
 struct PromiseMap::Impl
 {
-    Impl( const Promises& promises )
+    explicit Impl( const Promises& promises )
+        : _promises( promises.begin(), promises.end( ))
+        , _deferred( _promises.size(), false )
     {
-        for( const auto& promise: promises )
-            _promiseMap.insert({ promise.getName(), promise });
+        std::stable_sort( _promises.begin(), _promises.end(),
+                          []( const Promise& promise1, const Promise& promise2 )
+                          { return promise1.getName() < promise2.getName(); });
     }
 
-    void throwError( const std::string& name ) const
+    // The promises are not affected by the resets of the ports, so an
+    // execution sets the data of the frame it started with
+    explicit Impl( const OutputPorts& ports )
+        : _deferred( ports.size(), false )
     {
-        LBTHROW( std::logic_error( std::string( "Unknown promise name: ") + name ));
+        _promises.reserve( ports.size( ));
+        for( const OutputPort& port: ports )
+            _promises.push_back( port.getPromise().getCurrent( ));
     }
 
-    bool hasPromise( const std::string& name ) const
+    void throwError( const std::string& name ) const
     {
-        return _promiseMap.count( name ) > 0;
+        LBTHROW( std::logic_error( std::string( "Unknown promise name: ") + name ));
     }
 
-    void flush( const std::string& name ) const
+    void flush( const std::string& name )
     {
         getPromise( name ).flush();
     }
 
-    void flush() const
+    void flush()
     {
-        for( auto& namePromise: _promiseMap )
+        for( size_t i = 0; i < _promises.size(); ++i )
         {
-            Promise promise = namePromise.second;
-            promise.flush();
+            if( !_deferred[ i ])
+                _promises[ i ].flush();
         }
     }
 
-    void reset( const std::string& name ) const
+    void setWhenReady( const PortId port, const Futures& futures,
+                       const std::function< PortDataPtr() >& getData )
+    {
+        Promise promise = getPromise( port );
+        _deferred[ port ] = true;
+
+        // Counts the registration too, so the data is set once all the
+        // futures are ready, whether or not they were ready when registered
+        const auto nWaiting = std::make_shared< std::atomic< size_t >>( futures.size() + 1 );
+        const std::function< void() > setData = [promise, nWaiting, getData]() mutable
+        {
+            if( --(*nWaiting) > 0 )
+                return;
+
+            try
+            {
+                promise.setData( getData( ));
+            }
+            catch( const std::exception& error )
+            {
+                LBERROR << "Cannot set " << promise.getName() << ": " << error.what()
+                        << std::endl;
+                promise.flush();
+            }
+        };
+
+        for( const Future& future: futures )
+            future.onReady( setData );
+        setData();
+    }
+
+    void reset( const std::string& name )
     {
         getPromise( name ).reset();
     }
 
-    void reset() const
+    void reset()
     {
-        for( auto& namePromise: _promiseMap )
-        {
-            Promise promise = namePromise.second;
+        for( auto& promise: _promises )
             promise.reset();
-        }
     }
 
-    Promise getPromise( const std::string& name ) const
+    Promise& getPromise( const std::string& name )
     {
-        if( !hasPromise( name ))
+        const auto& it = std::lower_bound( _promises.begin(), _promises.end(), name,
+                                           []( const Promise& promise, const std::string& key )
+                                           { return promise.getName() < key; });
+        if( it == _promises.end() || it->getName() != name )
             throwError( name );
 
-        return _promiseMap.find( name )->second;
+        return *it;
     }
 
-    NamePromiseMap _promiseMap;
+    Promise& getPromise( const PortId port )
+    {
+        if( port >= _promises.size( ))
+            LBTHROW( std::logic_error( std::string( "Unknown port id: ")
+                                       + std::to_string( port )));
+        return _promises[ port ];
+    }
+
+    // The promises in the order of their ports
+    std::vector< Promise > _promises;
+    std::vector< bool > _deferred; // Set once their futures are ready
 };
 
 PromiseMap::PromiseMap( const Promises& promises )
     : _impl( new PromiseMap::Impl( promises ))
 {}
 
+PromiseMap::PromiseMap( const OutputPorts& ports )
+    : _impl( new PromiseMap::Impl( ports ))
+{}
+
 PromiseMap::~PromiseMap()
 {}
 
@@ -108,6 +155,12 @@ void PromiseMap::flush() const
     _impl->flush();
 }
 
+void PromiseMap::setWhenReady( const PortId port, const Futures& futures,
+                               const std::function< PortDataPtr() >& getData ) const
+{
+    _impl->setWhenReady( port, futures, getData );
+}
+
 void PromiseMap::reset( const std::string& name) const
 {
     _impl->reset( name );
@@ -123,4 +176,9 @@ Promise PromiseMap::getPromise( const std::string& name ) const
     return _impl->getPromise( name );
 }
 
+Promise PromiseMap::getPromise( const PortId port ) const
+{
+    return _impl->getPromise( port );
+}
+
 }
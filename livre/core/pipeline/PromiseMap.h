@@ -29,7 +29,8 @@ namespace livre
 
 /**
  * Wrapper class for applying operations on map of @Promise objects. i.e a promise with
- * the name can be set.
+ * the name can be set. The promises of the output ports of a filter can also
+ * be set with the port ids, \see getPortId.
  */
 class PromiseMap
 {
@@ -37,6 +38,13 @@ class PromiseMap
 public:
 
     LIVRECORE_API explicit PromiseMap( const Promises& promises );
+
+    /**
+     * @param ports the output ports of a filter, sorted by name. Their ids are
+     * their indices. The promises are not affected by the later resets of the
+     * ports, \see Promise::getCurrent.
+     */
+    LIVRECORE_API explicit PromiseMap( const OutputPorts& ports );
     LIVRECORE_API ~PromiseMap();
 
     /**
@@ -46,7 +54,14 @@ public:
     LIVRECORE_API Promise getPromise( const std::string& name ) const;
 
     /**
-     * Sets the port with the value.
+     * @param port the id of the port
+     * @return the promise of the port.
+     * @throw std::logic_error when there is no port with the given id
+     */
+    LIVRECORE_API Promise getPromise( PortId port ) const;
+
+    /**
+     * Sets the port with the value, copied or moved in, \see Promise::set.
      * @param name of the promise
      * @param value to be set
      * @throw std::logic_error when there is no promise associated with the
@@ -55,11 +70,38 @@ public:
      * type T
      */
     template< class T >
-    void set( const std::string& name, const T& value ) const
+    void set( const std::string& name, T&& value ) const
+    {
+        getPromise( name ).set( std::forward< T >( value ));
+    }
+
+    /**
+     * Sets the port with the value, copied or moved in, \see Promise::set.
+     * @param port the id of the port
+     * @param value to be set
+     * @throw std::logic_error when there is no port with the given id
+     * @throw std::runtime_error when the port data is not exact
+     * type T
+     */
+    template< class T >
+    void set( const PortId port, T&& value ) const
     {
-        getPromise( name ).set( value );
+        getPromise( port ).set( std::forward< T >( value ));
     }
 
+    /**
+     * Sets the port once the futures are ready, without waiting for them in
+     * the executing thread, i.e. for the objects loaded by other threads. The
+     * port is not flushed at the end of the execution.
+     * @param port the id of the port
+     * @param futures the futures to wait for
+     * @param getData gives the data of the port, called once in the thread
+     * setting the last future. The port is flushed if it throws.
+     * @throw std::logic_error when there is no port with the given id
+     */
+    LIVRECORE_API void setWhenReady( PortId port, const Futures& futures,
+                                     const std::function< PortDataPtr() >& getData ) const;
+
     /**
      * Writes empty values to promises which are not set already.
      * @param name of the promise.
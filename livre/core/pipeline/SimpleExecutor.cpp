@@ -20,121 +20,131 @@
 
 #include <livre/core/pipeline/SimpleExecutor.h>
 
-#include <livre/core/pipeline/Filter.h>
 #include <livre/core/pipeline/Workers.h>
 #include <livre/core/pipeline/Executable.h>
-#include <livre/core/pipeline/FutureMap.h>
 #include <livre/core/pipeline/FuturePromise.h>
-#include <livre/core/pipeline/PipeFilter.h>
-
-#include <livre/core/data/NodeId.h>
-#include <livre/core/data/LODNode.h>
 #include <livre/core/render/GLContext.h>
 
-#include <lunchbox/mtQueue.h>
-
-#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
 
-#include <algorithm>
-#include <iterator>
+#include <atomic>
+#include <unordered_set>
 
 namespace livre
 {
+namespace
+{
+// A scheduled executable, and the number of its preconditions which are not
+// ready yet
+struct PendingExecutable
+{
+    PendingExecutable( const ExecutablePtr& executable_, const size_t nPending_ )
+        : executable( executable_ )
+        , nPending( nPending_ )
+    {}
+
+    const ExecutablePtr executable;
+    std::atomic< size_t > nPending;
+};
+
+typedef std::shared_ptr< PendingExecutable > PendingExecutablePtr;
+typedef std::weak_ptr< PendingExecutable > PendingExecutableWeakPtr;
 
-bool operator<( const Future& future1, const Future& future2 )
+// Owns the pending executables, and hands them to the workers once they are
+// ready. The callbacks of the preconditions only reference them weakly, so
+// the executables are released by clear() or the executor destruction even if
+// their preconditions are never set.
+struct Dispatcher
 {
-    return future1.getId() < future2.getId();
+    explicit Dispatcher( Workers& workers_ )
+        : workers( &workers_ )
+    {}
+
+    void add( const PendingExecutablePtr& pending )
+    {
+        ScopedLock lock( mutex );
+        pendings.insert( pending );
+    }
+
+    void dispatch( const PendingExecutablePtr& pending )
+    {
+        ScopedLock lock( mutex );
+        if( pendings.erase( pending ) && workers )
+            workers->schedule( pending->executable );
+    }
+
+    // The executables are released without lock, their output ports set
+    // the promises when destroyed
+    void clear( const bool stop = false )
+    {
+        std::unordered_set< PendingExecutablePtr > released;
+        ScopedLock lock( mutex );
+        if( stop )
+            workers = nullptr;
+        released.swap( pendings );
+        lock.unlock();
+    }
+
+    boost::mutex mutex;
+    Workers* workers; // Reset when the executor is destroyed
+    std::unordered_set< PendingExecutablePtr > pendings;
+};
+
+typedef std::shared_ptr< Dispatcher > DispatcherPtr;
+typedef std::weak_ptr< Dispatcher > DispatcherWeakPtr;
+
+void notifyReady( const DispatcherWeakPtr& weakDispatcher,
+                  const PendingExecutableWeakPtr& weakPending )
+{
+    const PendingExecutablePtr pending = weakPending.lock();
+    if( !pending || --pending->nPending > 0 )
+        return;
+
+    const DispatcherPtr dispatcher = weakDispatcher.lock();
+    if( dispatcher )
+        dispatcher->dispatch( pending );
+}
 }
 
 struct SimpleExecutor::Impl
 {
-
     Impl( const size_t threadCount, const std::string& threadPoolName, ConstGLContextPtr glContext )
         : _workers( threadCount, threadPoolName, glContext )
-        , _unlockPromise( DataInfo( "LoopUnlock", getType< bool >( )))
-        , _workThread( boost::thread( boost::bind( &Impl::schedule, this )))
+        , _dispatcher( std::make_shared< Dispatcher >( _workers ))
     {}
 
     ~Impl()
     {
-        _mtWorkQueue.clear();
-        _mtWorkQueue.push( 0 );
-        {
-            ScopedLock lock( _promiseReset );
-             _unlockPromise.set( true );
-        }
-        _workThread.join();
-    }
-
-    void schedule()
-    {
-        std::set< Future > inputConditions;
-        std::list< ExecutablePtr > executables;
-        while( true )
-        {
-            Futures futures = { Future( _unlockPromise ) };
-            futures.insert( futures.end(),
-                            inputConditions.begin(), inputConditions.end( ));
-            waitForAny( futures );
-            {
-                ScopedLock lock( _promiseReset );
-                if( _unlockPromise.getFuture().isReady( ))
-                {
-                    while( !_mtWorkQueue.empty( ))
-                    {
-                        ExecutablePtr exec = _mtWorkQueue.pop();
-                        // In destruction tine "0" is pushed to the queue
-                        // and no further executable is scheduled
-                        if( !exec )
-                            return;
-
-                        executables.push_back( exec );
-                        const Futures& preConds = exec->getPreconditions();
-                        inputConditions.insert( preConds.begin(), preConds.end( ));
-                    }
-
-                    _unlockPromise.reset();
-                }
-            }
-
-            std::list< ExecutablePtr >::iterator it = executables.begin();
-            while( it != executables.end( ))
-            {
-                ExecutablePtr executable = *it;
-                const Futures& preConds = executable->getPreconditions();
-                const FutureMap futureMap( preConds );
-                if( futureMap.isReady( ))
-                {
-                    _workers.schedule( executable );
-                    it = executables.erase( it );
-                    for( const auto& future: futureMap.getFutures( ))
-                        inputConditions.erase( future );
-                }
-                else
-                    ++it;
-            }
-        }
+        // The executables which are not ready yet are not executed anymore,
+        // the workers finish the dispatched ones
+        _dispatcher->clear( true );
     }
 
     void clear()
     {
-        _mtWorkQueue.clear();
+        _dispatcher->clear();
     }
 
-    void schedule( ExecutablePtr exec )
+    void schedule( const ExecutablePtr& executable )
     {
-        ScopedLock lock( _promiseReset );
-        const bool wasEmpty = _mtWorkQueue.empty();
-        _mtWorkQueue.pushFront( exec );
-        if( wasEmpty )
-            _unlockPromise.set( true );
+        // The executable is dispatched by the thread which sets the last of
+        // its preconditions, the extra count is released once all the
+        // callbacks are registered
+        const Futures& preConditions = executable->getPreconditions();
+        const PendingExecutablePtr pending =
+            std::make_shared< PendingExecutable >( executable, preConditions.size() + 1 );
+        _dispatcher->add( pending );
+
+        const DispatcherWeakPtr weakDispatcher = _dispatcher;
+        const PendingExecutableWeakPtr weakPending = pending;
+        for( const Future& future: preConditions )
+            future.onReady( [weakDispatcher, weakPending]
+                            { notifyReady( weakDispatcher, weakPending ); });
+        notifyReady( weakDispatcher, weakPending );
     }
 
-    lunchbox::MTQueue< ExecutablePtr > _mtWorkQueue;
     Workers _workers;
-    Promise _unlockPromise;
-    boost::mutex _promiseReset;
-    boost::thread _workThread;
+    const DispatcherPtr _dispatcher;
 };
 
 SimpleExecutor::SimpleExecutor( const size_t threadCount,
@@ -32,8 +32,10 @@ namespace livre
  * class. It has a thread pool for executing multiple executables
  * asynchronously.
  *
- * The submitted executables are scheduled to the worker threads,
- * by looking at the preconditions if they are satisfied.
+ * The submitted executables are scheduled to the worker threads
+ * once their preconditions are satisfied. Every executable counts its
+ * preconditions which are not ready, and is handed to the workers by the
+ * thread which sets the last one, without a scheduling thread.
  */
 class SimpleExecutor : public Executor
 {
@@ -21,17 +21,44 @@
 #include <livre/core/pipeline/Executable.h>
 #include <livre/core/render/GLContext.h>
 
-#include <lunchbox/mtQueue.h>
-
+#include <boost/thread/condition_variable.hpp>
 #include <boost/thread/thread.hpp>
 
+#include <array>
+#include <atomic>
+#include <deque>
+
 #include <sys/prctl.h>
 
 namespace livre
 {
+namespace
+{
+const size_t nSpins = 64; // Attempts to find work before sleeping
+
+// The work is queued by priority. The frames are waited for in order, so the
+// work of the frames older than the newest scheduled one goes above all
+// priorities, ordered by frame.
+const size_t WAITED_BAND = PRIORITY_RENDER + 1;
+const size_t N_BANDS = PRIORITY_RENDER + 2;
+
+// The pool and the queue of a worker thread, so the work it schedules goes to
+// its own queue
+thread_local const void* currentPool = nullptr;
+thread_local size_t currentQueue = 0;
+}
 
 struct Workers::Impl
 {
+    // The work of one thread. The owner takes the newest work of a band, so
+    // the work scheduled last runs first, and the other threads steal the
+    // oldest. The lock is only contended by the thieves.
+    struct WorkQueue
+    {
+        boost::mutex mutex;
+        std::array< std::deque< ExecutablePtr >, N_BANDS > bands;
+    };
+
     Impl( Workers& workers,
           const size_t nThreads,
           const std::string& threadPoolName,
@@ -39,12 +66,21 @@ struct Workers::Impl
         : _workers( workers )
         , _name( threadPoolName )
         , _glContext( glContext )
+        , _nextQueue( 0 )
+        , _pending( 0 )
+        , _sleeping( 0 )
+        , _stopping( false )
+        , _frame( 0 )
     {
+        for( auto& bandPending: _bandPending )
+            bandPending = 0;
+        for( size_t i = 0; i < std::max( nThreads, size_t( 1 )); ++i )
+            _queues.emplace_back( new WorkQueue );
         for( size_t i = 0; i < nThreads; ++i )
-            _threadGroup.create_thread( boost::bind( &Impl::execute, this ));
+            _threadGroup.create_thread( boost::bind( &Impl::execute, this, i ));
     }
 
-    void execute()
+    void execute( const size_t index )
     {
         prctl( PR_SET_NAME, _name.c_str(), 0, 0, 0 );
 
@@ -56,31 +92,187 @@ struct Workers::Impl
             context->makeCurrent();
         }
 
+        currentPool = this;
+        currentQueue = index;
         while( true )
         {
-            ExecutablePtr exec = _workQueue.pop();
-            if( !exec )
+            ExecutablePtr exec = takeWork( index );
+            if( exec )
+                exec->execute();
+            else if( !waitForWork( ))
                 break;
-
-            exec->execute();
         }
 
         if( context )
             context.reset();
     }
 
+    bool isWaited( const uint32_t frame ) const
+    {
+        return frame > 0 && frame < _frame;
+    }
+
+    size_t getBand( const Executable& executable ) const
+    {
+        if( isWaited( executable.getFrame( )))
+            return WAITED_BAND;
+        return size_t( executable.getPriority( ));
+    }
+
+    // The waited band is sorted by frame, the work of a frame is usually
+    // scheduled after the work of the older ones
+    static void insert( std::deque< ExecutablePtr >& executables, const size_t band,
+                        const ExecutablePtr& executable )
+    {
+        auto i = executables.end();
+        if( band == WAITED_BAND )
+        {
+            while( i != executables.begin() &&
+                   ( *( i - 1 ))->getFrame() > executable->getFrame( ))
+                --i;
+        }
+        executables.insert( i, executable );
+    }
+
+    void push( WorkQueue& queue, const size_t band, const ExecutablePtr& executable )
+    {
+        {
+            ScopedLock lock( queue.mutex );
+            insert( queue.bands[ band ], band, executable );
+        }
+        ++_bandPending[ band ];
+    }
+
+    // Moves the queued work of the frames older than the newest one to the
+    // waited band, once per frame
+    void promoteWaitedFrames()
+    {
+        for( const auto& queue: _queues )
+        {
+            ScopedLock lock( queue->mutex );
+            std::deque< ExecutablePtr >& waited = queue->bands[ WAITED_BAND ];
+            for( size_t band = WAITED_BAND; band-- > 0; )
+            {
+                std::deque< ExecutablePtr >& executables = queue->bands[ band ];
+                for( auto i = executables.begin(); i != executables.end(); )
+                {
+                    if( !isWaited( (*i)->getFrame( )))
+                    {
+                        ++i;
+                        continue;
+                    }
+                    insert( waited, WAITED_BAND, *i );
+                    i = executables.erase( i );
+                    --_bandPending[ band ];
+                    ++_bandPending[ WAITED_BAND ];
+                }
+            }
+        }
+    }
+
+    ExecutablePtr pop( WorkQueue& queue, const size_t band, bool newest )
+    {
+        ScopedLock lock( queue.mutex );
+        std::deque< ExecutablePtr >& executables = queue.bands[ band ];
+        if( executables.empty( ))
+            return ExecutablePtr();
+
+        // The oldest waited frame first, as the frames are waited for in order
+        if( band == WAITED_BAND &&
+            executables.front()->getFrame() < executables.back()->getFrame( ))
+        {
+            newest = false;
+        }
+
+        ExecutablePtr exec;
+        if( newest )
+        {
+            exec = executables.back();
+            executables.pop_back();
+        }
+        else
+        {
+            exec = executables.front();
+            executables.pop_front();
+        }
+        --_bandPending[ band ];
+        return exec;
+    }
+
+    // The highest band first, in it own work first, then steals from the next
+    // queues
+    ExecutablePtr takeWork( const size_t index )
+    {
+        for( size_t band = N_BANDS; band-- > 0; )
+        {
+            for( size_t i = 0; i < _queues.size() && _bandPending[ band ] > 0; ++i )
+            {
+                const ExecutablePtr exec = pop( *_queues[ ( index + i ) % _queues.size( )],
+                                                band, i == 0 );
+                if( exec )
+                {
+                    --_pending;
+                    return exec;
+                }
+            }
+        }
+        return ExecutablePtr();
+    }
+
+    // Spins for a short while, as the work of a frame comes in bursts, then
+    // sleeps until work is scheduled.
+    // @return false if the pool is destroyed and all the work is done
+    bool waitForWork()
+    {
+        for( size_t i = 0; i < nSpins; ++i )
+        {
+            if( _pending > 0 )
+                return true;
+            boost::this_thread::yield();
+        }
+
+        ScopedLock lock( _mutex );
+        ++_sleeping;
+        while( _pending <= 0 && !_stopping )
+            _condition.wait( lock );
+        --_sleeping;
+        return _pending > 0 || !_stopping;
+    }
+
     ~Impl()
     {
-        for( size_t i = 0; i < getSize(); ++i )
-            _workQueue.push( ExecutablePtr( ));
+        {
+            ScopedLock lock( _mutex );
+            _stopping = true;
+        }
+        _condition.notify_all();
         _threadGroup.join_all();
         _glContext.reset();
     }
 
-
-    void submitWork( ExecutablePtr executable )
+    void submitWork( const ExecutablePtr& executable )
     {
-        _workQueue.pushFront( executable );
+        // The work scheduled by the workers stays local, the other work is
+        // spread over the queues
+        const size_t index = currentPool == this ? currentQueue
+                                                 : _nextQueue++ % _queues.size();
+
+        // The newest frame makes the previous ones waited for
+        const uint32_t frame = executable->getFrame();
+        uint32_t newestFrame = _frame;
+        while( frame > newestFrame && !_frame.compare_exchange_weak( newestFrame, frame ))
+            ;
+        if( frame > newestFrame )
+            promoteWaitedFrames();
+        push( *_queues[ index ], getBand( *executable ), executable );
+
+        // A thread going to sleep either sees the work, or is woken up
+        ++_pending;
+        if( _sleeping > 0 )
+        {
+            ScopedLock lock( _mutex );
+            _condition.notify_one();
+        }
     }
 
     size_t getSize() const
@@ -89,10 +281,18 @@ struct Workers::Impl
     }
 
     Workers& _workers;
-    lunchbox::MTQueue< ExecutablePtr > _workQueue;
+    std::vector< std::unique_ptr< WorkQueue >> _queues;
     boost::thread_group _threadGroup;
     const std::string _name;
     ConstGLContextPtr _glContext;
+    std::atomic< size_t > _nextQueue;
+    std::atomic< int64_t > _pending; // Negative while a scheduled work is taken early
+    std::array< std::atomic< int64_t >, N_BANDS > _bandPending;
+    std::atomic< size_t > _sleeping;
+    bool _stopping;
+    boost::mutex _mutex;
+    boost::condition_variable _condition;
+    std::atomic< uint32_t > _frame; // The newest scheduled frame
 };
 
 Workers::Workers( const size_t nThreads,
@@ -109,6 +309,7 @@ Workers::~Workers()
 
 void Workers::schedule( ExecutablePtr executable )
 {
+    executable->notifyScheduled();
     _impl->submitWork( executable );
 }
 
@@ -27,7 +27,16 @@ namespace livre
 {
 
 /**
- * A simple thread pool
+ * A work stealing thread pool. Every thread has its own queue: the work
+ * scheduled by a thread of the pool goes to its queue, the other work is
+ * spread over the queues. A thread runs its newest work first and steals the
+ * oldest work of the others when its queue is empty. Idle threads spin
+ * shortly before they sleep, so bursts of small tasks are picked up quickly.
+ *
+ * The work of a higher \see Executable::getPriority() runs first. The frames
+ * are waited for in order, so the work of a frame older than the newest
+ * scheduled one (\see Executable::getFrame()) runs before all other work,
+ * the oldest frame first.
  */
 class Workers
 {
@@ -47,7 +56,8 @@ public:
 
     /**
      * Submitted executable is scheduled to the execution
-     * queue.
+     * queue. The scheduled executables are all executed before the thread
+     * pool is destroyed.
      * @param executable is executed by thread pool.
      */
     LIVRECORE_API void schedule( ExecutablePtr executable );
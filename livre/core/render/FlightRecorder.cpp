@@ -0,0 +1,210 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/render/FlightRecorder.h>
+
+#include <lunchbox/debug.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+
+namespace livre
+{
+
+struct FlightRecorder::Impl
+{
+    Impl( const std::string& prefix, const size_t nFrames, const uint32_t latencyThreshold )
+        : _prefix( prefix )
+        , _nFrames( nFrames )
+        , _latencyThreshold( uint64_t( latencyThreshold ) * 1000 )
+        , _framesSinceDump( nFrames )
+    {
+        if( _nFrames == 0 )
+            LBTHROW( std::runtime_error( "The flight recorder needs to keep frames" ));
+
+        _current.frame = 0;
+        _current.startTime = 0;
+        _current.endTime = 0;
+        PipelineTrace::startRecording();
+    }
+
+    ~Impl()
+    {
+        wait();
+        PipelineTrace::stopRecording();
+    }
+
+    void wait()
+    {
+        if( _writer.joinable( ))
+            _writer.join();
+    }
+
+    void startFrame( const uint32_t frame, const uint64_t time )
+    {
+        _current.frame = frame;
+        _current.startTime = time;
+    }
+
+    std::string finishFrame( const RenderStatistics& statistics, const uint64_t time )
+    {
+        if( _current.startTime == 0 )
+            return std::string();
+
+        _current.endTime = time;
+        _current.statistics = statistics;
+        PipelineTrace::notifyExecution( "frame", _current.frame, 0,
+                                        _current.startTime, _current.endTime );
+
+        _frames.push_back( _current );
+        if( _frames.size() > _nFrames )
+            _frames.pop_front();
+        _current.startTime = 0;
+        ++_framesSinceDump;
+
+        const FrameRecord& frame = _frames.back();
+        if( frame.endTime - frame.startTime < _latencyThreshold ||
+            _framesSinceDump < _nFrames )
+        {
+            return std::string();
+        }
+
+        _framesSinceDump = 0;
+        return dump();
+    }
+
+    // Collects the executions and writes them in the background, so the
+    // slow frame is not delayed further. The previous dump is done, as it
+    // was written at least nFrames ago.
+    std::string dump()
+    {
+        const std::string filename = _prefix + std::to_string( _frames.back().frame ) +
+                                     ".json";
+        wait();
+        const FrameRecords frames( _frames.begin(), _frames.end( ));
+        _writer = boost::thread( [filename, frames]
+        {
+            // The executions of the next frames are not dumped
+            TraceEvents events = PipelineTrace::getEvents( frames.front().startTime );
+            const uint64_t endTime = frames.back().endTime;
+            events.erase( std::remove_if( events.begin(), events.end(),
+                                          [endTime]( const TraceEvent& event )
+                                          { return event.startTime > endTime; }),
+                          events.end( ));
+
+            std::ofstream file( filename.c_str(), std::ios::out | std::ios::trunc );
+            if( !file )
+            {
+                LBWARN << "Cannot create slow frame dump " << filename << std::endl;
+                return;
+            }
+            write( frames, events, file );
+        });
+        return filename;
+    }
+
+    const std::string _prefix;
+    const size_t _nFrames;
+    const uint64_t _latencyThreshold; // us
+    size_t _framesSinceDump;
+    FrameRecord _current;
+    std::deque< FrameRecord > _frames;
+    boost::thread _writer; // Writes the latest dump
+};
+
+FlightRecorder::FlightRecorder( const std::string& prefix, const size_t nFrames,
+                                const uint32_t latencyThreshold )
+    : _impl( new FlightRecorder::Impl( prefix, nFrames, latencyThreshold ))
+{}
+
+FlightRecorder::~FlightRecorder()
+{}
+
+void FlightRecorder::startFrame( const uint32_t frame )
+{
+    _impl->startFrame( frame, PipelineTrace::getTime( ));
+}
+
+void FlightRecorder::startFrame( const uint32_t frame, const uint64_t time )
+{
+    _impl->startFrame( frame, time );
+}
+
+std::string FlightRecorder::finishFrame( const RenderStatistics& statistics )
+{
+    return _impl->finishFrame( statistics, PipelineTrace::getTime( ));
+}
+
+std::string FlightRecorder::finishFrame( const RenderStatistics& statistics,
+                                         const uint64_t time )
+{
+    return _impl->finishFrame( statistics, time );
+}
+
+void FlightRecorder::wait()
+{
+    _impl->wait();
+}
+
+FrameRecords FlightRecorder::getFrames() const
+{
+    return FrameRecords( _impl->_frames.begin(), _impl->_frames.end( ));
+}
+
+void FlightRecorder::write( const FrameRecords& frames, const TraceEvents& events,
+                            std::ostream& os )
+{
+    os << "{";
+    PipelineTrace::writeEvents( events, os );
+    os << ",\"displayTimeUnit\":\"ms\"," << std::endl << "\"frames\":[";
+
+    for( size_t i = 0; i < frames.size(); ++i )
+    {
+        const FrameRecord& frame = frames[ i ];
+        const RenderStatistics& statistics = frame.statistics;
+        os << ( i > 0 ? "," : "" ) << std::endl
+           << "{\"frame\":" << frame.frame
+           << ",\"ts\":" << frame.startTime
+           << ",\"latency\":" << frame.endTime - frame.startTime
+           << ",\"nAvailable\":" << statistics.nAvailable
+           << ",\"nNotAvailable\":" << statistics.nNotAvailable
+           << ",\"nRenderAvailable\":" << statistics.nRenderAvailable
+           << ",\"caches\":[";
+
+        for( size_t j = 0; j < statistics.cacheStatistics.size(); ++j )
+        {
+            const CacheStatisticsSnapshot& cache = statistics.cacheStatistics[ j ];
+            os << ( j > 0 ? "," : "" )
+               << "{\"name\":\"" << cache.name << "\""
+               << ",\"hits\":" << cache.hits
+               << ",\"misses\":" << cache.misses
+               << ",\"evictions\":" << cache.evictions
+               << ",\"loadedBytes\":" << cache.loadedBytes
+               << ",\"usedMemBytes\":" << cache.usedMemBytes
+               << ",\"loadTimeP95\":" << cache.getLoadTimePercentile( 95.f ) << "}";
+        }
+        os << "]}";
+    }
+    os << std::endl << "]}" << std::endl;
+}
+
+}
@@ -0,0 +1,124 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _FlightRecorder_h_
+#define _FlightRecorder_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+#include <livre/core/pipeline/PipelineTrace.h>
+#include <livre/core/render/FrameInfo.h> // member
+
+namespace livre
+{
+
+/** A frame recorded by a \see FlightRecorder, the times are in microseconds */
+struct FrameRecord
+{
+    uint32_t frame; //!< The frame number
+    uint64_t startTime; //!< When the frame started, \see PipelineTrace::getTime
+    uint64_t endTime; //!< When the frame ended
+    RenderStatistics statistics; //!< The visible nodes and the cache activity
+};
+
+typedef std::vector< FrameRecord > FrameRecords;
+
+/**
+ * Keeps the latest frames of a channel, with the executions of the filters
+ * while they were rendered, and dumps them to a file once a frame is slower
+ * than a latency threshold. The file is a Chrome trace, with the statistics
+ * of the frames in its "frames" member; the loaded bytes of the texture cache
+ * are the bytes uploaded to the GPU.
+ *
+ * The recorder runs all the time, so the slow frames can be looked at after
+ * the fact. It enables the recording of the executions without a trace file,
+ * \see PipelineTrace::startRecording. A frame dumps again only once all the
+ * frames of the previous dump are replaced, so a slow period writes one file
+ * per history. The dumps are written by a background thread, so the slow
+ * frames are not delayed further. The methods are not thread safe.
+ */
+class FlightRecorder
+{
+public:
+
+    /**
+     * @param prefix of the dump files, which are named <prefix><frame>.json.
+     * @param nFrames the number of latest frames to keep.
+     * @param latencyThreshold the latency of the slow frames in milliseconds.
+     * @throw std::runtime_error if no frame is kept
+     */
+    LIVRECORE_API FlightRecorder( const std::string& prefix, size_t nFrames,
+                                  uint32_t latencyThreshold );
+
+    LIVRECORE_API ~FlightRecorder();
+
+    /**
+     * Starts a frame now.
+     * @param frame the frame number.
+     */
+    LIVRECORE_API void startFrame( uint32_t frame );
+
+    /**
+     * Starts a frame at a given time.
+     * @param frame the frame number.
+     * @param time when the frame started, \see PipelineTrace::getTime.
+     */
+    LIVRECORE_API void startFrame( uint32_t frame, uint64_t time );
+
+    /**
+     * Ends the frame started last now, and dumps the latest frames if it was
+     * slow. The dump is written in the background, a failure is logged.
+     * @param statistics of the frame.
+     * @return the name of the dump file, or empty if nothing was dumped
+     */
+    LIVRECORE_API std::string finishFrame( const RenderStatistics& statistics );
+
+    /**
+     * Ends the frame started last at a given time, \see finishFrame.
+     * @param statistics of the frame.
+     * @param time when the frame ended, \see PipelineTrace::getTime.
+     * @return the name of the dump file, or empty if nothing was dumped
+     */
+    LIVRECORE_API std::string finishFrame( const RenderStatistics& statistics,
+                                           uint64_t time );
+
+    /** Waits until the latest dump is written. */
+    LIVRECORE_API void wait();
+
+    /** @return the latest frames, the oldest first */
+    LIVRECORE_API FrameRecords getFrames() const;
+
+    /**
+     * Writes frames and the executions of their filters as a Chrome trace.
+     * @param frames the frames to write.
+     * @param events the executions of the filters.
+     * @param os the stream to write to.
+     */
+    LIVRECORE_API static void write( const FrameRecords& frames, const TraceEvents& events,
+                                     std::ostream& os );
+
+private:
+
+    struct Impl;
+    std::unique_ptr< Impl > _impl;
+};
+
+}
+
+#endif // _FlightRecorder_h_
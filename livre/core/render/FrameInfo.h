@@ -22,6 +22,7 @@
 
 #include <livre/core/api.h>
 #include <livre/core/cache/CacheObject.h> // member
+#include <livre/core/cache/CacheStatistics.h> // member
 #include <livre/core/data/NodeId.h> // member
 #include <livre/core/render/Frustum.h> // member
 
@@ -61,6 +62,9 @@ struct RenderStatistics
     size_t nAvailable; //!< Number of available nodes
     size_t nNotAvailable; //!< Number of not available nodes
     size_t nRenderAvailable; //!< Number of render nodes
+
+    /** Activity of the caches since the previous frame of the renderer */
+    std::vector< CacheStatisticsSnapshot > cacheStatistics;
 };
 
 }
@@ -29,6 +29,7 @@
 #include <livre/core/configuration/RendererParameters.h>
 #include <livre/core/render/FrameInfo.h>
 #include <livre/core/pipeline/PipeFilter.h>
+#include <livre/core/pipeline/PortData.h>
 
 namespace livre
 {
@@ -48,5 +49,8 @@ struct RenderInputs
     DataSource& dataSource;
 };
 
+/** The render inputs are shared by the filters of a frame, \see makePortData */
+template<> struct IsCheapToCopy< RenderInputs > : std::false_type {};
+
 }
 #endif // _RendererPlugin_h_
@@ -180,6 +180,11 @@ const NodeIds& SelectVisibles::getVisibles() const
     return _impl->_visibles;
 }
 
+NodeIds SelectVisibles::takeVisibles()
+{
+    return std::move( _impl->_visibles );
+}
+
 void SelectVisibles::visitPre()
 {
     _impl->visitPre();
@@ -57,6 +57,11 @@ public:
      */
     const NodeIds& getVisibles() const;
 
+    /**
+     * @return the list of visibles, moved out of the visitor
+     */
+    NodeIds takeVisibles();
+
 protected:
 
     void visitPre() final;
@@ -52,11 +52,13 @@ class Cache;
 
 class CacheObject;
 class CacheStatistics;
+class CacheTrace;
 class ClipPlanes;
 class Configuration;
 class DataSource;
 class DataSourcePlugin;
 class DataSourcePluginData;
+class DiskCache;
 class EventHandler;
 class EventHandlerFactory;
 class EventInfo;
@@ -75,6 +77,7 @@ class RendererPlugin;
 class RenderPipeline;
 class RenderSettings;
 class RootNode;
+class SharedMemoryCache;
 class TexturePool;
 class VisitState;
 class RendererParameters;
@@ -109,6 +112,7 @@ struct VolumeInformation;
 typedef uint64_t Identifier;
 typedef Identifier CacheId;
 typedef std::array< float, 2 > Range;
+typedef uint32_t PortId; //!< Index of a port in the sorted ports of a filter
 
 /**
  * SmartPtr definitions
@@ -179,6 +183,8 @@ typedef std::vector< CacheId > CacheIds;
 typedef std::vector< CacheObjectPtr > CacheObjects;
 typedef std::vector< ConstCacheObjectPtr > ConstCacheObjects;
 typedef std::vector< std::string > Strings;
+typedef std::vector< InputPort > InputPorts;
+typedef std::vector< OutputPort > OutputPorts;
 
 /**
  * List definitions for complex types
@@ -0,0 +1,193 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/util/Compression.h>
+
+#include <cstring>
+
+namespace livre
+{
+namespace
+{
+const size_t MIN_MATCH = 4;
+const size_t LAST_LITERALS = 5; // The last bytes are always literals
+const size_t MATCH_FIND_LIMIT = 12; // The last match starts before
+const size_t MAX_OFFSET = 65535;
+const size_t HASH_BITS = 16;
+
+uint32_t read32( const uint8_t* data )
+{
+    uint32_t value;
+    ::memcpy( &value, data, sizeof( value ));
+    return value;
+}
+
+uint32_t hash( const uint32_t value )
+{
+    return ( value * 2654435761u ) >> ( 32 - HASH_BITS );
+}
+
+// Lengths above 15 continue in bytes of 255 and a remainder
+void writeLength( std::vector< uint8_t >& output, size_t length )
+{
+    for( ; length >= 255; length -= 255 )
+        output.push_back( 255 );
+    output.push_back( uint8_t( length ));
+}
+
+void writeSequence( std::vector< uint8_t >& output,
+                    const uint8_t* literals, const size_t nLiterals,
+                    const size_t offset, const size_t matchLength )
+{
+    const size_t matchCode = matchLength - MIN_MATCH;
+    output.push_back( uint8_t(( std::min( nLiterals, size_t( 15 )) << 4 ) |
+                              std::min( matchCode, size_t( 15 ))));
+    if( nLiterals >= 15 )
+        writeLength( output, nLiterals - 15 );
+    output.insert( output.end(), literals, literals + nLiterals );
+
+    output.push_back( uint8_t( offset & 0xff ));
+    output.push_back( uint8_t( offset >> 8 ));
+    if( matchCode >= 15 )
+        writeLength( output, matchCode - 15 );
+}
+
+void writeLastLiterals( std::vector< uint8_t >& output,
+                        const uint8_t* literals, const size_t nLiterals )
+{
+    output.push_back( uint8_t( std::min( nLiterals, size_t( 15 )) << 4 ));
+    if( nLiterals >= 15 )
+        writeLength( output, nLiterals - 15 );
+    output.insert( output.end(), literals, literals + nLiterals );
+}
+
+// @return false if the input ends within the length
+bool readLength( const uint8_t* data, const size_t size, size_t& pos, size_t& length )
+{
+    uint8_t value;
+    do
+    {
+        if( pos >= size )
+            return false;
+        value = data[ pos++ ];
+        length += value;
+    }
+    while( value == 255 );
+    return true;
+}
+}
+
+std::vector< uint8_t > compressLZ4( const uint8_t* data, const size_t size )
+{
+    std::vector< uint8_t > output;
+    output.reserve( size + size / 255 + 16 );
+
+    size_t anchor = 0;
+    if( size > MATCH_FIND_LIMIT )
+    {
+        // Positions of the last occurrences of 4 byte sequences. The matches
+        // are verified, so the initial zeros are harmless.
+        std::vector< uint32_t > table( size_t( 1 ) << HASH_BITS, 0 );
+        const size_t matchLimit = size - LAST_LITERALS;
+        const size_t inputLimit = size - MATCH_FIND_LIMIT;
+
+        size_t pos = 0;
+        while( pos < inputLimit )
+        {
+            const uint32_t sequence = read32( data + pos );
+            uint32_t& entry = table[ hash( sequence )];
+            const size_t candidate = entry;
+            entry = uint32_t( pos );
+
+            if( candidate >= pos || pos - candidate > MAX_OFFSET ||
+                read32( data + candidate ) != sequence )
+            {
+                // Skip faster through incompressible data
+                pos += 1 + (( pos - anchor ) >> 6 );
+                continue;
+            }
+
+            size_t matchLength = MIN_MATCH;
+            while( pos + matchLength < matchLimit &&
+                   data[ candidate + matchLength ] == data[ pos + matchLength ])
+            {
+                ++matchLength;
+            }
+
+            writeSequence( output, data + anchor, pos - anchor, pos - candidate,
+                           matchLength );
+            pos += matchLength;
+            anchor = pos;
+        }
+    }
+
+    writeLastLiterals( output, data + anchor, size - anchor );
+    return output;
+}
+
+bool decompressLZ4( const uint8_t* data, const size_t size,
+                    uint8_t* output, const size_t outputSize )
+{
+    size_t pos = 0;
+    size_t outputPos = 0;
+    while( pos < size )
+    {
+        const uint8_t token = data[ pos++ ];
+
+        size_t nLiterals = token >> 4;
+        if( nLiterals == 15 && !readLength( data, size, pos, nLiterals ))
+            return false;
+        if( nLiterals > size - pos || nLiterals > outputSize - outputPos )
+            return false;
+
+        ::memcpy( output + outputPos, data + pos, nLiterals );
+        pos += nLiterals;
+        outputPos += nLiterals;
+        if( pos == size ) // The last sequence has no match
+            break;
+
+        if( size - pos < 2 )
+            return false;
+        const size_t offset = size_t( data[ pos ]) | ( size_t( data[ pos + 1 ]) << 8 );
+        pos += 2;
+        if( offset == 0 || offset > outputPos )
+            return false;
+
+        size_t matchLength = token & 0x0f;
+        if( matchLength == 15 && !readLength( data, size, pos, matchLength ))
+            return false;
+        matchLength += MIN_MATCH;
+        if( matchLength > outputSize - outputPos )
+            return false;
+
+        // The match can overlap the output, i.e. for runs
+        const uint8_t* match = output + outputPos - offset;
+        if( offset >= matchLength )
+            ::memcpy( output + outputPos, match, matchLength );
+        else
+        {
+            for( size_t i = 0; i < matchLength; ++i )
+                output[ outputPos + i ] = match[ i ];
+        }
+        outputPos += matchLength;
+    }
+    return outputPos == outputSize;
+}
+
+}
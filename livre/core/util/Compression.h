@@ -0,0 +1,53 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _Compression_h_
+#define _Compression_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+
+/**
+ * Compresses the data in the LZ4 block format. The greedy single pass
+ * compression trades the ratio for speed, the volume bricks are compressed on
+ * cache eviction and decompressed on every hit.
+ * @param data the data to compress.
+ * @param size the size of the data in bytes.
+ * @return the compressed data
+ */
+LIVRECORE_API std::vector< uint8_t > compressLZ4( const uint8_t* data, size_t size );
+
+/**
+ * Decompresses data in the LZ4 block format.
+ * @param data the compressed data.
+ * @param size the size of the compressed data in bytes.
+ * @param output the decompressed data.
+ * @param outputSize the size of the decompressed data in bytes.
+ * @return false if the data is corrupt or does not decompress to outputSize
+ * bytes
+ */
+LIVRECORE_API bool decompressLZ4( const uint8_t* data, size_t size,
+                                  uint8_t* output, size_t outputSize );
+
+}
+
+#endif // _Compression_h_
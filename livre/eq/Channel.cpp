@@ -36,8 +36,10 @@
 #include <livre/eq/settings/EqVolumeSettings.h>
 #include <livre/eq/Window.h>
 
+#include <livre/core/configuration/RendererParameters.h>
 #include <livre/core/data/DataSource.h>
 #include <livre/core/data/Histogram.h>
+#include <livre/core/render/FlightRecorder.h>
 #include <livre/core/render/FrameInfo.h>
 #include <livre/core/render/Frustum.h>
 #include <livre/core/render/RenderPipeline.h>
@@ -47,6 +49,7 @@
 #include <livre/core/pipeline/PipeFilter.h>
 #include <livre/core/pipeline/FutureMap.h>
 #include <livre/core/pipeline/Filter.h>
+#include <livre/core/pipeline/PipelineTrace.h>
 
 #ifdef LIVRE_USE_ZEROEQ
 #  include <zeroeq/publisher.h>
@@ -56,11 +59,21 @@
 #include <eq/eq.h>
 #include <eq/gl.h>
 
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <unistd.h>
+
 namespace livre
 {
 const float nearPlane = 0.1f;
 const float farPlane = 15.0f;
 
+namespace
+{
+std::atomic< uint32_t > nChannels( 0 ); // Names the slow frame dumps
+}
+
 struct RedrawFilter : public Filter
 {
     explicit RedrawFilter( Channel* channel )
@@ -316,11 +329,56 @@ public:
     void configInit()
     {
         initializeFrame();
+        startFlightRecorder();
+    }
+
+    // The latest frames are dumped when one is slow, to the temporary
+    // directory unless another one is given
+    void startFlightRecorder()
+    {
+        const RendererParameters& vrParams = getFrameData()->getVRParameters();
+        if( vrParams.getSlowFrameLatencyMS() == 0 )
+            return;
+
+        std::string slowFrameDir = vrParams.getSlowFrameDirectoryString();
+        if( slowFrameDir.empty( ))
+            slowFrameDir = boost::filesystem::temp_directory_path().string();
+
+        try
+        {
+            _flightRecorder.reset(
+                new FlightRecorder( slowFrameDir + "/slow-frame-" + std::to_string( getpid( )) +
+                                    "-" + std::to_string( nChannels++ ) + "-",
+                                    vrParams.getSlowFrameHistory(),
+                                    vrParams.getSlowFrameLatencyMS( )));
+        }
+        catch( const std::runtime_error& error )
+        {
+            LBWARN << "Slow frame dumps disabled: " << error.what() << std::endl;
+        }
+    }
+
+    void finishFrame()
+    {
+        if( !_flightRecorder )
+            return;
+
+        try
+        {
+            const std::string& filename = _flightRecorder->finishFrame( _statistics );
+            if( !filename.empty( ))
+                LBINFO << "Slow frame dumped to " << filename << std::endl;
+        }
+        catch( const std::runtime_error& error )
+        {
+            LBWARN << error.what() << std::endl;
+        }
     }
 
     void configExit()
     {
         _frame.getFrameData()->flush();
+        _flightRecorder.reset();
     }
 
     void addImageListener()
@@ -418,6 +476,18 @@ public:
         os << "All nodes: " << all << "\n"
            << int( 100.f * done + .5f ) << "% loaded" << std::endl;
 
+        // Hit ratio, load throughput and load times tell whether the frame
+        // waited for I/O
+        for( const CacheStatisticsSnapshot& cache: _statistics.cacheStatistics )
+            os << cache.name << ": "
+               << int( 100.f * cache.getHitRatio() + .5f ) << "% hits, "
+               << cache.evictions << " evicted, "
+               << cache.getLoadedBytesPerSecond() / LB_1MB << " MB/s, "
+               << "load p50/p95/p99 "
+               << cache.getLoadTimePercentile( 50.f ) << "/"
+               << cache.getLoadTimePercentile( 95.f ) << "/"
+               << cache.getLoadTimePercentile( 99.f ) << " ms" << std::endl;
+
         float y = 260.f;
         std::string text = os.str();
         const eq::util::BitmapFont* font = _channel->getWindow()->getSmallFont();
@@ -591,6 +661,7 @@ public:
     FrameGrabber _frameGrabber;
     FrameInfo _frameInfo;
     RenderStatistics _statistics;
+    std::unique_ptr< FlightRecorder > _flightRecorder;
     ::lexis::data::Progress _progress;
 #ifdef LIVRE_USE_ZEROEQ
     zeroeq::Publisher _publisher;
@@ -625,10 +696,13 @@ void Channel::frameStart( const eq::uint128_t& frameID,
 {
     eq::Channel::frameStart( frameID, frameCounter );
     _impl->_drawRange = eq::Range::ALL;
+    if( _impl->_flightRecorder )
+        _impl->_flightRecorder->startFrame( frameCounter );
 }
 
 void Channel::frameDraw( const lunchbox::uint128_t& frameId )
 {
+    const ScopedTrace trace( "frameDraw", getPipe()->getCurrentFrame( ));
     eq::Channel::frameDraw( frameId );
     _impl->frameDraw();
 }
@@ -641,6 +715,7 @@ void Channel::frameViewStart( const eq::uint128_t& frameId )
 
 void Channel::frameViewFinish( const eq::uint128_t &frameID )
 {
+    const ScopedTrace trace( "frameViewFinish", getPipe()->getCurrentFrame( ));
     setupAssemblyState();
     _impl->frameViewFinish();
     resetAssemblyState();
@@ -650,6 +725,7 @@ void Channel::frameViewFinish( const eq::uint128_t &frameID )
 
 void Channel::frameAssemble( const eq::uint128_t&, const eq::Frames& frames )
 {
+    const ScopedTrace trace( "frameAssemble", getPipe()->getCurrentFrame( ));
     applyBuffer();
     applyViewport();
     setupAssemblyState();
@@ -660,10 +736,17 @@ void Channel::frameAssemble( const eq::uint128_t&, const eq::Frames& frames )
 void Channel::frameReadback( const eq::uint128_t& frameId,
                              const eq::Frames& frames )
 {
+    const ScopedTrace trace( "frameReadback", getPipe()->getCurrentFrame( ));
     _impl->frameReadback( frames );
     eq::Channel::frameReadback( frameId, frames );
 }
 
+void Channel::frameFinish( const eq::uint128_t& frameID, const uint32_t frameNumber )
+{
+    _impl->finishFrame();
+    eq::Channel::frameFinish( frameID, frameNumber );
+}
+
 std::string Channel::getDumpImageFileName() const
 {
     std::stringstream filename;
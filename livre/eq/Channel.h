@@ -49,6 +49,7 @@ private:
     void frameViewFinish( const eq::uint128_t &frameID ) final;
     void frameAssemble( const eq::uint128_t&, const eq::Frames& ) final;
     void frameReadback( const eq::uint128_t&, const eq::Frames& ) final;
+    void frameFinish( const eq::uint128_t&, const uint32_t ) final;
     std::string getDumpImageFileName() const final;
 
     std::unique_ptr< Impl >  _impl;
@@ -34,10 +34,13 @@
 #include <livre/core/configuration/RendererParameters.h>
 
 #include <livre/core/data/DataSource.h>
+#include <livre/core/pipeline/PipelineTrace.h>
 
 #include <eq/eq.h>
 #include <eq/gl.h>
 
+#include <unistd.h>
+
 namespace livre
 {
 struct Node::Impl
@@ -76,6 +79,26 @@ public:
         return true;
     }
 
+    // The executions of the filters of the process are recorded for
+    // chrome://tracing
+    void startPipelineTrace()
+    {
+        const RendererParameters& vrParams = _config->getFrameData().getVRParameters();
+        const std::string& pipelineTraceDir = vrParams.getPipelineTraceDirectoryString();
+        if( pipelineTraceDir.empty( ))
+            return;
+
+        try
+        {
+            _pipelineTrace.reset( new PipelineTrace( pipelineTraceDir + "/pipeline-" +
+                                                     std::to_string( getpid( )) + ".json" ));
+        }
+        catch( const std::runtime_error& error )
+        {
+            LBWARN << "Pipeline trace disabled: " << error.what() << std::endl;
+        }
+    }
+
     void frameStart( const eq::uint128_t &frameId )
     {
         if( !_node->isApplicationNode( ))
@@ -94,6 +117,7 @@ public:
     livre::Node* const _node;
     livre::Config* const _config;
     std::unique_ptr< DataSource > _dataSource;
+    std::unique_ptr< PipelineTrace > _pipelineTrace;
 };
 
 Node::Node( eq::Config* parent )
@@ -127,11 +151,13 @@ bool Node::configInit( const eq::uint128_t& initId )
         config->mapFrameData( initId );
     }
 
+    _impl->startPipelineTrace();
     return true;
 }
 
 bool Node::configExit()
 {
+    _impl->_pipelineTrace.reset();
     if( !isApplicationNode( ))
     {
         Config *config = static_cast< Config *>( getConfig() );
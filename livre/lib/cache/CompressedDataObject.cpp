@@ -0,0 +1,84 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/lib/cache/CompressedDataObject.h>
+#include <livre/lib/cache/DataObject.h>
+
+#include <livre/core/data/MemoryUnit.h>
+#include <livre/core/util/Compression.h>
+
+#include <lunchbox/debug.h>
+
+namespace livre
+{
+struct CompressedDataObject::Impl
+{
+public:
+
+    Impl( const CacheId& cacheId, const DataObject& dataObject )
+        : _dataSize( dataObject.getDataSize( ))
+    {
+        if( _dataSize == 0 )
+            LBTHROW( CacheLoadException( cacheId, "No data to compress" ));
+
+        _data = compressLZ4( static_cast< const uint8_t* >( dataObject.getDataPtr( )),
+                             _dataSize );
+        _data.shrink_to_fit();
+    }
+
+    ConstMemoryUnitPtr decompress() const
+    {
+        AllocMemoryUnitPtr memUnit( new AllocMemoryUnit( _dataSize ));
+        if( !decompressLZ4( _data.data(), _data.size(),
+                            memUnit->getData< uint8_t >(), _dataSize ))
+        {
+            LBTHROW( std::runtime_error( "Corrupt compressed data" ));
+        }
+        return memUnit;
+    }
+
+    const size_t _dataSize;
+    std::vector< uint8_t > _data;
+};
+
+CompressedDataObject::CompressedDataObject( const CacheId& cacheId,
+                                            const DataObject& dataObject )
+    : CacheObject( cacheId )
+    , _impl( new Impl( cacheId, dataObject ))
+{}
+
+CompressedDataObject::~CompressedDataObject()
+{}
+
+ConstMemoryUnitPtr CompressedDataObject::decompress() const
+{
+    return _impl->decompress();
+}
+
+size_t CompressedDataObject::getDataSize() const
+{
+    return _impl->_dataSize;
+}
+
+size_t CompressedDataObject::getSize() const
+{
+    return _impl->_data.size();
+}
+
+}
@@ -0,0 +1,71 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CompressedDataObject_h_
+#define _CompressedDataObject_h_
+
+#include <livre/lib/api.h>
+#include <livre/lib/types.h>
+
+#include <livre/core/cache/CacheObject.h> // base class
+
+namespace livre
+{
+
+/**
+ * The CompressedDataObject class keeps the data of an evicted DataObject
+ * compressed in memory, so it can be restored without loading it from the
+ * data source again.
+ */
+class CompressedDataObject : public CacheObject
+{
+public:
+
+    /**
+     * Constructor
+     * @param cacheId is the unique identifier
+     * @param dataObject the data object to compress
+     * @throws CacheLoadException when the data object has no data
+     */
+    LIVRE_API CompressedDataObject( const CacheId& cacheId, const DataObject& dataObject );
+
+    LIVRE_API ~CompressedDataObject();
+
+    /**
+     * Decompresses the data.
+     * @return the memory unit with the data of the data object
+     * @throws std::runtime_error if the compressed data is corrupt
+     */
+    LIVRE_API ConstMemoryUnitPtr decompress() const;
+
+    /** @return the size of the decompressed data in bytes */
+    LIVRE_API size_t getDataSize() const;
+
+    /** @copydoc livre::CacheObject::getSize */
+    LIVRE_API size_t getSize() const final;
+
+private:
+
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+
+}
+
+#endif // _CompressedDataObject_h_
@@ -19,6 +19,10 @@
  */
 
 #include <livre/lib/cache/DataObject.h>
+#include <livre/lib/cache/CompressedDataObject.h>
+#include <livre/core/cache/Cache.h>
+#include <livre/core/cache/DiskCache.h>
+#include <livre/core/cache/SharedMemoryCache.h>
 #include <livre/core/data/LODNode.h>
 #include <livre/core/data/MemoryUnit.h>
 #include <livre/core/data/DataSource.h>
@@ -31,15 +35,60 @@ struct DataObject::Impl
 {
 public:
 
-    Impl( const CacheId& cacheId, DataSource& dataSource )
+    Impl( const CacheId& cacheId, DataSource& dataSource,
+          CompressedDataCache* compressedCache, DiskCache* diskCache,
+          SharedMemoryCache* sharedCache )
     {
-        if( !load( cacheId, dataSource ))
-            LBTHROW( CacheLoadException( cacheId, "Unable to construct data cache object" ));
+        read( cacheId, dataSource, compressedCache, diskCache, sharedCache );
+        _size = getResidentSize();
     }
 
     ~Impl()
     {}
 
+    void read( const CacheId& cacheId, DataSource& dataSource,
+               CompressedDataCache* compressedCache, DiskCache* diskCache,
+               SharedMemoryCache* sharedCache )
+    {
+        if( compressedCache && restore( cacheId, *compressedCache ))
+            return;
+
+        if( sharedCache )
+        {
+            _data = sharedCache->load( cacheId );
+            if( _data )
+                return;
+        }
+
+        if( diskCache )
+            _data = diskCache->load( cacheId );
+
+        if( !_data )
+        {
+            if( !load( cacheId, dataSource ))
+                LBTHROW( CacheLoadException( cacheId, "Unable to construct data cache object" ));
+
+            if( diskCache )
+                diskCache->store( cacheId, *_data );
+        }
+
+        if( sharedCache )
+            share( cacheId, *sharedCache );
+    }
+
+    // The pages of memory mapped data are read here, where the load time is
+    // measured, so the data cache accounts the memory they use in the page
+    // cache. The size is sampled once, as it has to be the same when the
+    // object is unloaded.
+    size_t getResidentSize() const
+    {
+        const MappedMemoryUnit* mapped =
+            dynamic_cast< const MappedMemoryUnit* >( _data.get( ));
+        if( mapped )
+            mapped->prefetch();
+        return _data->getAllocSize();
+    }
+
     const void* getDataPtr() const
     {
         return _data->getData< void >();
@@ -58,12 +107,40 @@ public:
         return true;
     }
 
+    // The compressed cache only keeps the data which is not in the data cache
+    bool restore( const CacheId& cacheId, CompressedDataCache& compressedCache )
+    {
+        const ConstCompressedDataObjectPtr compressed = compressedCache.get( cacheId );
+        if( !compressed )
+            return false;
+
+        _data = compressed->decompress();
+        compressedCache.purge( cacheId );
+        return true;
+    }
+
+    // The data is replaced by its copy in shared memory, so the other
+    // processes use the same memory
+    void share( const CacheId& cacheId, SharedMemoryCache& sharedCache )
+    {
+        if( !sharedCache.store( cacheId, *_data ))
+            return;
+
+        const ConstMemoryUnitPtr shared = sharedCache.load( cacheId );
+        if( shared )
+            _data = shared;
+    }
+
     ConstMemoryUnitPtr _data;
+    size_t _size;
 };
 
-DataObject::DataObject( const CacheId& cacheId, DataSource& dataSource )
+DataObject::DataObject( const CacheId& cacheId, DataSource& dataSource,
+                        CompressedDataCache* compressedCache,
+                        DiskCache* diskCache,
+                        SharedMemoryCache* sharedCache )
     : CacheObject( cacheId )
-    , _impl( new Impl( cacheId, dataSource ))
+    , _impl( new Impl( cacheId, dataSource, compressedCache, diskCache, sharedCache ))
 {}
 
 DataObject::~DataObject()
@@ -71,7 +148,7 @@ DataObject::~DataObject()
 
 size_t DataObject::getSize() const
 {
-    return _impl->_data->getAllocSize();
+    return _impl->_size;
 }
 
 const void* DataObject::getDataPtr() const
@@ -79,4 +156,9 @@ const void* DataObject::getDataPtr() const
     return _impl->getDataPtr();
 }
 
+size_t DataObject::getDataSize() const
+{
+    return _impl->_data->getMemSize();
+}
+
 }
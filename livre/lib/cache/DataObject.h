@@ -40,15 +40,28 @@ public:
      * Constructor
      * @param cacheId is the unique identifier
      * @param dataSource the data source cache object is created from
+     * @param compressedCache if given, the data is restored from it if it is
+     * there, and removed from it, instead of being loaded from the data source
+     * @param diskCache if given, the data is read from it if it is there,
+     * otherwise the data loaded from the data source is written to it
+     * @param sharedCache if given, the data is read from it if it is there,
+     * otherwise the data is copied to it and used from there, so the processes
+     * on the node share one copy
      * @throws CacheLoadException when the data cache does not have the data for cache id
      */
-    LIVRE_API DataObject( const CacheId& cacheId, DataSource& dataSource );
+    LIVRE_API DataObject( const CacheId& cacheId, DataSource& dataSource,
+                          CompressedDataCache* compressedCache = nullptr,
+                          DiskCache* diskCache = nullptr,
+                          SharedMemoryCache* sharedCache = nullptr );
 
     LIVRE_API ~DataObject();
 
     /** @return A pointer to the data or 0 if no data is loaded. */
     LIVRE_API const void* getDataPtr() const;
 
+    /** @return The size of the data in bytes. */
+    LIVRE_API size_t getDataSize() const;
+
     /** @copydoc livre::CacheObject::getSize */
     LIVRE_API size_t getSize() const final;
 
@@ -0,0 +1,170 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/lib/cache/DatasetCaches.h>
+#include <livre/lib/cache/CompressedDataObject.h>
+#include <livre/lib/cache/DataObject.h>
+#include <livre/lib/cache/HistogramObject.h>
+
+#include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheTrace.h>
+#include <livre/core/cache/DiskCache.h>
+#include <livre/core/cache/MemoryBudget.h>
+#include <livre/core/cache/SharedMemoryCache.h>
+#include <livre/core/data/DataSource.h>
+#include <livre/core/render/RenderInputs.h>
+#include <livre/core/settings/RenderSettings.h>
+
+#include <lunchbox/debug.h>
+
+#include <map>
+#include <sstream>
+
+namespace livre
+{
+namespace
+{
+std::map< std::string, std::unique_ptr< DatasetCaches >> datasetCaches;
+boost::mutex datasetCachesMutex;
+std::unique_ptr< MemoryBudget > memoryBudget; // Destroyed before the caches
+}
+
+DatasetCaches::DatasetCaches()
+{}
+
+DatasetCaches::~DatasetCaches()
+{}
+
+DatasetCaches& DatasetCaches::get( const RenderInputs& renderInputs,
+                                   const std::string& datasetId,
+                                   const size_t nShards )
+{
+    ScopedLock lock( datasetCachesMutex );
+    std::unique_ptr< DatasetCaches >& caches = datasetCaches[ datasetId ];
+    if( caches )
+        return *caches;
+
+    caches.reset( new DatasetCaches );
+    const RendererParameters& vrParams = renderInputs.vrParameters;
+    caches->dataCache.reset( new DataCache( "Data Cache",
+                                            vrParams.getMaxCPUCacheMemoryMB() * LB_1MB,
+                                            nShards,
+                                            CachePolicyType( vrParams.getDataCachePolicy( ))));
+    pinLevels( *caches->dataCache, vrParams.getPinnedLevels(),
+               vrParams.getPinnedCPUCacheMemoryMB() * LB_1MB );
+
+    // The accesses of the data cache are recorded for livreCacheReplay
+    const std::string& cacheTraceDir = vrParams.getCacheTraceDirectoryString();
+    if( !cacheTraceDir.empty( ))
+    {
+        try
+        {
+            caches->dataCacheTrace.reset( new CacheTrace( cacheTraceDir + "/" + datasetId +
+                                                          ".trace" ));
+            caches->dataCache->setTrace( caches->dataCacheTrace.get( ));
+        }
+        catch( const std::runtime_error& error )
+        {
+            LBWARN << "Cache trace disabled: " << error.what() << std::endl;
+        }
+    }
+
+    // The data evicted from the data cache is kept compressed
+    const size_t compressedMemBytes = vrParams.getCompressedCPUCacheMemoryMB() * LB_1MB;
+    if( compressedMemBytes > 0 )
+    {
+        caches->compressedDataCache.reset( new CompressedDataCache( "Compressed Data Cache",
+                                                                    compressedMemBytes,
+                                                                    nShards ));
+        CompressedDataCache* compressedDataCache = caches->compressedDataCache.get();
+        caches->dataCache->registerNotifyEvicted(
+            [compressedDataCache]( const ConstDataObjectPtr& data )
+                { compressedDataCache->load( data->getId(), *data ); });
+    }
+
+    // The data read from the data source is kept on a local disk
+    const std::string& diskCacheDir = vrParams.getDiskCacheDirectoryString();
+    if( !diskCacheDir.empty( ))
+        caches->diskCache.reset( new DiskCache( diskCacheDir, datasetId,
+                                                vrParams.getMaxDiskCacheMemoryMB() * LB_1MB ));
+
+    // The data is shared with the other livre processes of the node
+    const size_t sharedMemBytes = vrParams.getSharedCPUCacheMemoryMB() * LB_1MB;
+    if( sharedMemBytes > 0 )
+    {
+        const VolumeInformation& info = renderInputs.dataSource.getVolumeInfo();
+        const size_t blockSize = size_t( info.maximumBlockSize.product( )) *
+                                 info.compCount * info.getBytesPerVoxel();
+        try
+        {
+            caches->sharedMemoryCache.reset( new SharedMemoryCache( datasetId, blockSize,
+                                                                    sharedMemBytes ));
+        }
+        catch( const std::runtime_error& error )
+        {
+            LBWARN << "Shared memory cache disabled: " << error.what() << std::endl;
+        }
+    }
+
+    caches->histogramCache.reset( new HistogramCache( "Histogram Cache",
+                                                      32 * LB_1MB, // 32 MB
+                                                      1,
+                                                      CachePolicyType( vrParams.getHistogramCachePolicy( ))));
+
+    if( !memoryBudget )
+    {
+        // One budget for the CPU caches of all the data sets, the memory
+        // is lent to the caches with the most costly misses
+        size_t maxMemBytes = caches->dataCache->getStatistics().getMaximumMemory() +
+                             caches->histogramCache->getStatistics().getMaximumMemory();
+        if( caches->compressedDataCache )
+            maxMemBytes += caches->compressedDataCache->getStatistics().getMaximumMemory();
+
+        const size_t minMemBytes = vrParams.getAdaptiveCPUCacheMemory() ? maxMemBytes / 8
+                                                                        : maxMemBytes;
+        memoryBudget.reset( new MemoryBudget( minMemBytes, maxMemBytes ));
+    }
+
+    // Follow the available memory, and evict in the background before
+    // the budget is reached
+    if( vrParams.getAdaptiveCPUCacheMemory( ))
+        caches->dataCache->setWatermarks( 0.9f, 0.8f );
+
+    const size_t maxDatasetMemBytes = vrParams.getMaxDatasetCacheMemoryMB() * LB_1MB;
+    memoryBudget->addCache( *caches->dataCache,
+                            vrParams.getMinDatasetCacheMemoryMB() * LB_1MB,
+                            maxDatasetMemBytes > 0 ? maxDatasetMemBytes
+                                                   : std::numeric_limits< size_t >::max( ));
+    memoryBudget->addCache( *caches->histogramCache );
+    if( caches->compressedDataCache )
+        memoryBudget->addCache( *caches->compressedDataCache );
+
+    // Share the budget with the previous data sets before loading
+    memoryBudget->update();
+    return *caches;
+}
+
+std::string DatasetCaches::getDatasetId( const DataSource& dataSource )
+{
+    std::ostringstream uri;
+    uri << dataSource.getURI();
+    return DiskCache::getDatasetId( uri.str(), dataSource.getVolumeInfo( ));
+}
+
+}
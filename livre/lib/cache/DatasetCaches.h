@@ -0,0 +1,96 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _DatasetCaches_h_
+#define _DatasetCaches_h_
+
+#include <livre/lib/api.h>
+#include <livre/lib/types.h>
+
+#include <livre/core/data/NodeId.h>
+
+namespace livre
+{
+
+/**
+ * The CPU caches of a data set, shared by the renderers of all the render
+ * pipelines. The caches are created with the renderer parameters of the
+ * first renderer of the data set, and live until the process exits.
+ *
+ * The caches of all the data sets share one memory budget, which follows the
+ * data sets on screen within their quotas.
+ */
+struct DatasetCaches
+{
+    LIVRE_API ~DatasetCaches();
+
+    /**
+     * Gets the caches of a data set, and creates them the first time. The
+     * new caches share the memory budget with the caches of the previous
+     * data sets before they load.
+     * @param renderInputs the data source and the renderer parameters.
+     * @param datasetId the identity of the data set, \see getDatasetId.
+     * @param nShards the number of independently locked shards of the data
+     * and compressed data caches.
+     * @return the caches of the data set
+     */
+    LIVRE_API static DatasetCaches& get( const RenderInputs& renderInputs,
+                                         const std::string& datasetId,
+                                         size_t nShards );
+
+    /**
+     * @param dataSource the data source.
+     * @return the identity of the data set, from its URI and block layout
+     */
+    LIVRE_API static std::string getDatasetId( const DataSource& dataSource );
+
+    // The optional caches and trace are destroyed after the data cache
+    std::unique_ptr< SharedMemoryCache > sharedMemoryCache;
+    std::unique_ptr< DiskCache > diskCache;
+    std::unique_ptr< CompressedDataCache > compressedDataCache;
+    std::unique_ptr< CacheTrace > dataCacheTrace;
+    std::unique_ptr< DataCache > dataCache;
+    std::unique_ptr< HistogramCache > histogramCache;
+
+private:
+
+    DatasetCaches();
+};
+
+/**
+ * Pins the coarse levels of a cache, which are the fallback of the missing
+ * finer ones.
+ * @param cache the cache of the data set.
+ * @param nLevels the number of levels to pin, none if 0.
+ * @param maxMemBytes the maximum memory of the pinned objects.
+ */
+template< class CacheT >
+void pinLevels( CacheT& cache, const uint32_t nLevels, const size_t maxMemBytes )
+{
+    if( nLevels == 0 )
+        return;
+
+    cache.setMaximumPinnedMemory( maxMemBytes );
+    cache.pinIf( [nLevels]( const CacheId& cacheId )
+                 { return NodeId( cacheId ).getLevel() < nLevels; });
+}
+
+}
+
+#endif // _DatasetCaches_h_
@@ -145,7 +145,7 @@ public:
         if( compCount > 1 )
             LBTHROW( std::runtime_error( "Multiple channels are not supported "));
 
-        ConstDataObjectPtr data = dataCache.get( cacheId );
+        ConstDataObjectPtr data = dataCache.peek( cacheId );
 
         if( !data )
             return false;
@@ -68,7 +68,7 @@ struct TextureObject::Impl
                const DataSource& dataSource,
                const TexturePool& texturePool )
     {
-        ConstDataObjectPtr data = dataCache.get( cacheId );
+        ConstDataObjectPtr data = dataCache.peek( cacheId );
         if( !data )
             return false;
 
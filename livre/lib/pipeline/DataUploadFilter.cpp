@@ -29,31 +29,63 @@ namespace livre
 
 struct DataUploadFilter::Impl
 {
-    Impl( DataCache& dataCache )
+    Impl( DataCache& dataCache, CompressedDataCache* compressedCache,
+          DiskCache* diskCache, SharedMemoryCache* sharedCache,
+          const DataInfos& inputDataInfos, const DataInfos& outputDataInfos )
         : _dataCache( dataCache )
+        , _compressedCache( compressedCache )
+        , _diskCache( diskCache )
+        , _sharedCache( sharedCache )
+        , _renderInputsPort( getPortId( inputDataInfos, "RenderInputs" ))
+        , _nodeIdsPort( getPortId( inputDataInfos, "NodeIds" ))
+        , _dataCacheObjectsPort( getPortId( outputDataInfos, "DataCacheObjects" ))
     {}
 
     void execute( const FutureMap& input, PromiseMap& output ) const
     {
-        ConstCacheObjects cacheObjects;
-        const RenderInputs renderInputs = input.get< RenderInputs >( "RenderInputs" )[ 0 ];
-        for( const auto& nodeIds: input.getFutures( "NodeIds" ))
+        const auto& renderInputs = input.getFuture( _renderInputsPort ).get< RenderInputs >();
+
+        CacheIds cacheIds;
+        for( const auto& nodeIds: input.getFutures( _nodeIdsPort ))
             for( const auto& nodeId: nodeIds.get< NodeIds >( ))
+                cacheIds.push_back( nodeId.getId( ));
+
+        // The objects loaded by other threads are collected once they are
+        // ready, so this thread does not wait for them
+        const Futures futures = _dataCache.loadMany( cacheIds,
+                                                     renderInputs.dataSource,
+                                                     _compressedCache,
+                                                     _diskCache,
+                                                     _sharedCache );
+        output.setWhenReady( _dataCacheObjectsPort, futures, [futures]
+        {
+            ConstCacheObjects cacheObjects;
+            for( const auto& future: futures )
             {
-                const auto& cacheObj = _dataCache.load( nodeId.getId(), renderInputs.dataSource );
+                const auto& cacheObj = future.get< ConstDataObjectPtr >();
                 if( cacheObj )
                     cacheObjects.push_back( cacheObj );
-
-
             }
-        output.set( "DataCacheObjects", cacheObjects );
+            return makePortData( std::move( cacheObjects ));
+        });
     }
 
     DataCache& _dataCache;
+    CompressedDataCache* const _compressedCache;
+    DiskCache* const _diskCache;
+    SharedMemoryCache* const _sharedCache;
+    const PortId _renderInputsPort;
+    const PortId _nodeIdsPort;
+    const PortId _dataCacheObjectsPort;
 };
 
-DataUploadFilter::DataUploadFilter( DataCache& dataCache )
-    : _impl( new DataUploadFilter::Impl( dataCache ))
+DataUploadFilter::DataUploadFilter( DataCache& dataCache,
+                                    CompressedDataCache* compressedCache,
+                                    DiskCache* diskCache,
+                                    SharedMemoryCache* sharedCache )
+    : _impl( new DataUploadFilter::Impl( dataCache, compressedCache, diskCache,
+                                         sharedCache, getInputDataInfos(),
+                                         getOutputDataInfos( )))
 {
 }
 
@@ -35,8 +35,18 @@ class DataUploadFilter : public Filter
 {
 public:
 
-    /** Constructor */
-    DataUploadFilter( DataCache& dataCache );
+    /**
+     * Constructor
+     * @param dataCache data cache
+     * @param compressedCache optional cache of the compressed data evicted
+     * from the data cache
+     * @param diskCache optional local disk cache of the data source
+     * @param sharedCache optional shared memory cache of the processes on the node
+     */
+    DataUploadFilter( DataCache& dataCache,
+                      CompressedDataCache* compressedCache = nullptr,
+                      DiskCache* diskCache = nullptr,
+                      SharedMemoryCache* sharedCache = nullptr );
     ~DataUploadFilter();
 
     /** @copydoc Filter::execute */
@@ -32,31 +32,38 @@ namespace livre
 struct RenderFilter::Impl
 {
     Impl( const DataSource& dataSource,
-          Renderer& renderer )
+          Renderer& renderer,
+          const DataInfos& inputDataInfos )
         : _dataSource( dataSource )
         , _renderer( renderer )
+        , _cacheObjectsPort( getPortId( inputDataInfos, "CacheObjects" ))
+        , _renderInputsPort( getPortId( inputDataInfos, "RenderInputs" ))
+        , _renderStagesPort( getPortId( inputDataInfos, "RenderStages" ))
     {}
 
     void execute( const FutureMap& input, PromiseMap&) const
     {
         ConstCacheObjects renderBricks;
-        for( const auto& cacheObjects: input.getFutures( "CacheObjects" ))
+        for( const auto& cacheObjects: input.getFutures( _cacheObjectsPort ))
              for( const auto& cacheObject: cacheObjects.get< ConstCacheObjects >( ))
                 renderBricks.push_back( cacheObject );
 
-        const auto renderInputs = input.get< RenderInputs >( "RenderInputs" )[ 0 ];
-        const auto renderStages = input.get< uint32_t >( "RenderStages" )[ 0 ];
+        const auto& renderInputs = input.getFuture( _renderInputsPort ).get< RenderInputs >();
+        const auto renderStages = input.getFuture( _renderStagesPort ).get< uint32_t >();
 
         _renderer.render( renderInputs, renderBricks, renderStages );
     }
 
     const DataSource& _dataSource;
     Renderer& _renderer;
+    const PortId _cacheObjectsPort;
+    const PortId _renderInputsPort;
+    const PortId _renderStagesPort;
 };
 
 RenderFilter::RenderFilter( const DataSource& dataSource,
                             Renderer& renderer )
-    : _impl( new RenderFilter::Impl( dataSource, renderer ))
+    : _impl( new RenderFilter::Impl( dataSource, renderer, getInputDataInfos( )))
 {}
 
 RenderFilter::~RenderFilter()
@@ -20,8 +20,9 @@
 template< class CacheObjectT >
 struct RenderingSetGenerator
 {
+    // The lookups of the frame use one snapshot of the cache
     explicit RenderingSetGenerator( const Cache< CacheObjectT >& cache )
-        : _cache( cache )
+        : _snapshot( cache.getSnapshot( ))
     {}
 
     bool hasParentInMap( const NodeId& childRenderNode,
@@ -42,7 +43,7 @@ struct RenderingSetGenerator
         while( current.isValid( ))
         {
             const NodeId& currentNodeId = current;
-            const ConstCacheObjectPtr data = _cache.get( currentNodeId.getId( ));
+            const ConstCacheObjectPtr data = _snapshot->get( currentNodeId.getId( ));
             if( data )
             {
                 cacheMap[ currentNodeId.getId() ] = data;
@@ -94,7 +95,7 @@ struct RenderingSetGenerator
         return cacheObjects;
     }
 
-    const Cache< CacheObjectT >& _cache;
+    const std::shared_ptr< const CacheSnapshot< CacheObjectT >> _snapshot;
 };
 
 template< class CacheObjectT >
@@ -111,8 +112,9 @@ struct RenderingSetGeneratorFilter< CacheObjectT >::Impl
         ConstCacheObjects cacheObjects;
         size_t nVisible = 0;
         RenderStatistics cumulativeAvailability;
-        for( const auto& visibles: input.get< NodeIds >( "VisibleNodes" ))
+        for( const auto& future: input.getFutures( "VisibleNodes" ))
         {
+            const NodeIds& visibles = future.get< NodeIds >();
             RenderStatistics avaliability;
             const ConstCacheObjects& objs = renderSetGenerator.generateRenderingSet( visibles,
                                                                                      avaliability );
@@ -121,16 +123,15 @@ struct RenderingSetGeneratorFilter< CacheObjectT >::Impl
             cumulativeAvailability += avaliability;
         }
 
-        output.set( "CacheObjects", cacheObjects );
-        output.set( "RenderingDone", cacheObjects.size() == nVisible );
-        output.set( "RenderStatistics", cumulativeAvailability );
-
         NodeIds ids;
         ids.reserve( cacheObjects.size( ));
         for( const auto& cacheObject: cacheObjects )
             ids.emplace_back( cacheObject->getId( ));
 
-        output.set( "NodeIds", ids );
+        output.set( "RenderingDone", cacheObjects.size() == nVisible );
+        output.set( "CacheObjects", std::move( cacheObjects ));
+        output.set( "RenderStatistics", cumulativeAvailability );
+        output.set( "NodeIds", std::move( ids ));
     }
 
     const Cache< CacheObjectT >& _cache;
@@ -34,41 +34,58 @@ public:
 
     Impl( const DataCache& dataCache,
           TextureCache& textureCache,
-          TexturePool& texturePool )
+          TexturePool& texturePool,
+          const DataInfos& inputDataInfos,
+          const DataInfos& outputDataInfos )
         : _dataCache( dataCache )
         , _textureCache( textureCache )
         , _texturePool( texturePool )
+        , _renderInputsPort( getPortId( inputDataInfos, "RenderInputs" ))
+        , _dataCacheObjectsPort( getPortId( inputDataInfos, "DataCacheObjects" ))
+        , _textureCacheObjectsPort( getPortId( outputDataInfos, "TextureCacheObjects" ))
     {}
 
     void execute( const FutureMap& input, PromiseMap& output ) const
     {
-        ConstCacheObjects cacheObjects;
-        const RenderInputs renderInputs = input.get< RenderInputs >( "RenderInputs" )[ 0 ];
-        for( const auto& dataCacheObjects: input.getFutures( "DataCacheObjects" ))
+        const auto& renderInputs = input.getFuture( _renderInputsPort ).get< RenderInputs >();
+
+        CacheIds cacheIds;
+        for( const auto& dataCacheObjects: input.getFutures( _dataCacheObjectsPort ))
             for( const auto& dataCacheObject: dataCacheObjects.get< ConstCacheObjects >( ))
+                cacheIds.push_back( dataCacheObject->getId( ));
+
+        // The objects loaded by other threads are collected once they are
+        // ready, so this thread does not wait for them
+        const Futures futures = _textureCache.loadMany( cacheIds,
+                                                        _dataCache,
+                                                        renderInputs.dataSource,
+                                                        _texturePool );
+        output.setWhenReady( _textureCacheObjectsPort, futures, [futures]
+        {
+            ConstCacheObjects cacheObjects;
+            for( const auto& future: futures )
             {
-                const auto& cacheObj =
-                        _textureCache.load( dataCacheObject->getId(),
-                                            _dataCache,
-                                            renderInputs.dataSource,
-                                            _texturePool );
+                const auto& cacheObj = future.get< ConstTextureObjectPtr >();
                 if( cacheObj )
                     cacheObjects.push_back( cacheObj );
-
-
             }
-        output.set( "TextureCacheObjects", cacheObjects );
+            return makePortData( std::move( cacheObjects ));
+        });
     }
 
     const DataCache& _dataCache;
     TextureCache& _textureCache;
     TexturePool& _texturePool;
+    const PortId _renderInputsPort;
+    const PortId _dataCacheObjectsPort;
+    const PortId _textureCacheObjectsPort;
 };
 
 TextureUploadFilter::TextureUploadFilter( const DataCache& dataCache,
                                           TextureCache& textureCache,
                                           TexturePool& texturePool )
-    : _impl( new TextureUploadFilter::Impl( dataCache, textureCache, texturePool ))
+    : _impl( new TextureUploadFilter::Impl( dataCache, textureCache, texturePool,
+                                            getInputDataInfos(), getOutputDataInfos( )))
 {
 }
 
@@ -69,7 +69,7 @@ struct VisibleSetGeneratorFilter::Impl
                             visitor,
                             frame );
 
-        output.set( "VisibleNodes", visitor.getVisibles( ));
+        output.set( "VisibleNodes", visitor.takeVisibles( ));
         output.set( "Params", params );
     }
 
@@ -26,6 +26,7 @@
 namespace livre
 {
 
+class CompressedDataObject;
 class DataObject;
 class HistogramObject;
 class GLRaycastPipeline;
@@ -33,12 +34,14 @@ class RenderSettings;
 class TextureObject;
 class TexturePool;
 
+typedef Cache< CompressedDataObject > CompressedDataCache;
 typedef Cache< DataObject > DataCache;
 typedef Cache< HistogramObject > HistogramCache;
 typedef Cache< TextureObject > TextureCache;
 
 struct ApplicationParameters;
 
+typedef std::shared_ptr< const CompressedDataObject > ConstCompressedDataObjectPtr;
 typedef std::shared_ptr< const DataObject > ConstDataObjectPtr;
 typedef std::shared_ptr< const TextureObject > ConstTextureObjectPtr;
 typedef std::shared_ptr< const HistogramObject > ConstHistogramObjectPtr;
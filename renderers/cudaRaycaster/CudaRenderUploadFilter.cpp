@@ -46,12 +46,18 @@ public:
           CudaTextureCache& cudaCache,
           CudaTexturePool& texturePool,
           size_t nUploadThreads,
-          Executor& executor )
+          Executor& executor,
+          CompressedDataCache* compressedCache,
+          DiskCache* diskCache,
+          SharedMemoryCache* sharedCache )
         : _dataCache( dataCache )
         , _cudaCache( cudaCache )
         , _texturePool( texturePool )
         , _nUploadThreads( nUploadThreads )
         , _executor( executor )
+        , _compressedCache( compressedCache )
+        , _diskCache( diskCache )
+        , _sharedCache( sharedCache )
     {}
 
     void execute( const FutureMap& input, PromiseMap& output ) const
@@ -60,21 +66,33 @@ public:
         ConstCacheObjects cacheObjects; // Lock
         NodeIds notAvailable;
         const auto& renderInputs = futureMap.get< RenderInputs >( "RenderInputs" );
-        for( const auto& nodeId: futureMap.get< NodeIds >( "NodeIds" ))
+        const auto& nodeIds = futureMap.get< NodeIds >( "NodeIds" );
+
+        CacheIds visibles;
+        visibles.reserve( nodeIds.size( ));
+        for( const auto& nodeId: nodeIds )
+            visibles.push_back( nodeId.getId( ));
+        _cudaCache.setVisibles( visibles );
+        _dataCache.setVisibles( visibles );
+
+        const Futures futures = _cudaCache.loadMany( visibles,
+                                                     _dataCache,
+                                                     renderInputs.dataSource,
+                                                     _texturePool );
+        NodeIds::const_iterator nodeId = nodeIds.begin();
+        for( const auto& future: futures )
         {
-            const auto& cacheObj = _cudaCache.load( nodeId.getId(),
-                                                    _dataCache,
-                                                    renderInputs.dataSource,
-                                                    _texturePool );
+            const auto& cacheObj = future.get< ConstCudaTextureObjectPtr >();
             if( cacheObj )
                 cacheObjects.push_back( cacheObj );
             else
-                notAvailable.push_back( nodeId );
+                notAvailable.push_back( *nodeId );
+            ++nodeId;
         }
 
         if( notAvailable.empty( ))
         {
-             output.set( "CudaTextureCacheObjects", cacheObjects );
+             output.set( "CudaTextureCacheObjects", std::move( cacheObjects ));
              return;
         }
 
@@ -84,7 +102,11 @@ public:
                                                                               _dataCache,
                                                                               _cudaCache,
                                                                               _texturePool );
-        textureUploader.getPromise( "RenderInputs" ).set( renderInputs );
+        // The render inputs of the frame are shared by the uploaders
+        const PortDataPtr renderInputsData = futureMap.getFuture( "RenderInputs" ).getData();
+        textureUploader.getPromise( "RenderInputs" ).setData( renderInputsData );
+        textureUploader.setPriority( PRIORITY_RENDER );
+        textureUploader.setFrame( renderInputs.frameInfo.frameId );
         for( size_t i = 0; i < _nUploadThreads; ++i )
         {
             if( i * perThreadSize >= notAvailable.size( ))
@@ -100,10 +122,16 @@ public:
                                       begin + perThreadSize );
             std::stringstream str;
             str << "DataUploader" << i;
-            PipeFilter dataUploader = pipeline.add< DataUploadFilter >( str.str(), _dataCache );
+            PipeFilter dataUploader = pipeline.add< DataUploadFilter >( str.str(),
+                                                                        _dataCache,
+                                                                        _compressedCache,
+                                                                        _diskCache,
+                                                                        _sharedCache );
             dataUploader.connect( "DataCacheObjects", textureUploader, "DataCacheObjects" );
-            dataUploader.getPromise( "RenderInputs" ).set( renderInputs );
-            dataUploader.getPromise( "NodeIds" ).set( partialData );
+            dataUploader.getPromise( "RenderInputs" ).setData( renderInputsData );
+            dataUploader.getPromise( "NodeIds" ).set( std::move( partialData ));
+            dataUploader.setPriority( PRIORITY_RENDER );
+            dataUploader.setFrame( renderInputs.frameInfo.frameId );
         }
 
         pipeline.schedule( _executor );
@@ -114,7 +142,7 @@ public:
                              textureCacheObjects.begin(),
                              textureCacheObjects.end( ));
 
-        output.set( "CudaTextureCacheObjects", cacheObjects );
+        output.set( "CudaTextureCacheObjects", std::move( cacheObjects ));
     }
 
     DataCache& _dataCache;
@@ -122,18 +150,27 @@ public:
     CudaTexturePool& _texturePool;
     const size_t _nUploadThreads;
     Executor& _executor;
+    CompressedDataCache* const _compressedCache;
+    DiskCache* const _diskCache;
+    SharedMemoryCache* const _sharedCache;
 };
 
 CudaRenderUploadFilter::CudaRenderUploadFilter( DataCache& dataCache,
                                                 CudaTextureCache& cudaCache,
                                                 CudaTexturePool& texturePool,
                                                 size_t nUploadThreads,
-                                                Executor& executor )
+                                                Executor& executor,
+                                                CompressedDataCache* compressedCache,
+                                                DiskCache* diskCache,
+                                                SharedMemoryCache* sharedCache )
     : _impl( new CudaRenderUploadFilter::Impl( dataCache,
                                                cudaCache,
                                                texturePool,
                                                nUploadThreads,
-                                               executor ))
+                                               executor,
+                                               compressedCache,
+                                               diskCache,
+                                               sharedCache ))
 {
 }
 
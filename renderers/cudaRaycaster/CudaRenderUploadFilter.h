@@ -45,12 +45,19 @@ public:
      * @param texturePool pool for textures
      * @param nUploadThreads mumber of data upload thread
      * @param executor that runs the upload operations
+     * @param compressedCache optional cache of the compressed data evicted
+     * from the data cache
+     * @param diskCache optional local disk cache of the data source
+     * @param sharedCache optional shared memory cache of the processes on the node
      */
     CudaRenderUploadFilter( DataCache& dataCache,
                             CudaTextureCache& cudaCache,
                             CudaTexturePool& texturePool,
                             size_t nUploadThreads,
-                            Executor& executor );
+                            Executor& executor,
+                            CompressedDataCache* compressedCache = nullptr,
+                            DiskCache* diskCache = nullptr,
+                            SharedMemoryCache* sharedCache = nullptr );
     ~CudaRenderUploadFilter();
 
     /** @copydoc Filter::execute */
@@ -60,7 +60,7 @@ struct CudaTextureObject::Impl
 
     bool load( const CacheId& cacheId, const DataCache& dataCache, const DataSource& dataSource )
     {
-        ConstDataObjectPtr data = dataCache.get( cacheId );
+        ConstDataObjectPtr data = dataCache.peek( cacheId );
         if( !data )
             return false;
 
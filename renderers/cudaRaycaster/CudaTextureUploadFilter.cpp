@@ -34,40 +34,53 @@ public:
 
     Impl( const DataCache& dataCache,
           CudaTextureCache& cudaCache,
-          CudaTexturePool& texturePool )
+          CudaTexturePool& texturePool,
+          const DataInfos& inputDataInfos,
+          const DataInfos& outputDataInfos )
         : _dataCache( dataCache )
         , _cudaCache( cudaCache )
         , _texturePool( texturePool )
+        , _renderInputsPort( getPortId( inputDataInfos, "RenderInputs" ))
+        , _dataCacheObjectsPort( getPortId( inputDataInfos, "DataCacheObjects" ))
+        , _cudaTextureCacheObjectsPort( getPortId( outputDataInfos,
+                                                   "CudaTextureCacheObjects" ))
     {}
 
     void execute( const FutureMap& input, PromiseMap& output ) const
     {
         ConstCacheObjects cacheObjects;
-        const RenderInputs renderInputs = input.get< RenderInputs >( "RenderInputs" )[ 0 ];
-        for( const auto& dataCacheObjects: input.getFutures( "DataCacheObjects" ))
+        const auto& renderInputs = input.getFuture( _renderInputsPort ).get< RenderInputs >();
+        CacheIds cacheIds;
+        for( const auto& dataCacheObjects: input.getFutures( _dataCacheObjectsPort ))
             for( const auto& dataCacheObject: dataCacheObjects.get< ConstCacheObjects >( ))
-            {
-                const auto& cacheObj = _cudaCache.load( dataCacheObject->getId(),
-                                                        _dataCache,
-                                                        renderInputs.dataSource,
-                                                        _texturePool );
-                if( cacheObj )
-                    cacheObjects.push_back( cacheObj );
+                cacheIds.push_back( dataCacheObject->getId( ));
 
-
-            }
-        output.set( "CudaTextureCacheObjects", cacheObjects );
+        const Futures futures = _cudaCache.loadMany( cacheIds,
+                                                     _dataCache,
+                                                     renderInputs.dataSource,
+                                                     _texturePool );
+        for( const auto& future: futures )
+        {
+            const auto& cacheObj = future.get< ConstCudaTextureObjectPtr >();
+            if( cacheObj )
+                cacheObjects.push_back( cacheObj );
+        }
+        output.set( _cudaTextureCacheObjectsPort, std::move( cacheObjects ));
     }
 
     const DataCache& _dataCache;
     CudaTextureCache& _cudaCache;
     CudaTexturePool& _texturePool;
+    const PortId _renderInputsPort;
+    const PortId _dataCacheObjectsPort;
+    const PortId _cudaTextureCacheObjectsPort;
 };
 
 CudaTextureUploadFilter::CudaTextureUploadFilter( const DataCache& dataCache,
                                                   CudaTextureCache& cudaCache,
                                                   CudaTexturePool& texturePool )
-    : _impl( new CudaTextureUploadFilter::Impl( dataCache, cudaCache, texturePool ))
+    : _impl( new CudaTextureUploadFilter::Impl( dataCache, cudaCache, texturePool,
+                                                getInputDataInfos(), getOutputDataInfos( )))
 {
 }
 
@@ -25,12 +25,19 @@
 #include <livre/lib/pipeline/DataUploadFilter.h>
 #include <livre/lib/pipeline/RenderFilter.h>
 #include <livre/lib/pipeline/HistogramFilter.h>
+#include <livre/lib/cache/CompressedDataObject.h>
+#include <livre/lib/cache/DatasetCaches.h>
+#include <livre/lib/cache/DataObject.h>
 #include <livre/lib/cache/TextureObject.h>
 
 #include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheTrace.h>
+#include <livre/core/cache/DiskCache.h>
+#include <livre/core/cache/SharedMemoryCache.h>
 #include <livre/core/pipeline/SimpleExecutor.h>
 #include <livre/core/pipeline/Pipeline.h>
 #include <livre/core/data/DataSource.h>
+#include <livre/core/data/NodeId.h>
 #include <livre/core/render/RenderInputs.h>
 #include <livre/core/render/TexturePool.h>
 #include <livre/core/render/Renderer.h>
@@ -43,6 +50,9 @@
 #include <boost/progress.hpp>
 #include <boost/thread/tss.hpp>
 
+#include <deque>
+#include <map>
+
 #include <livre/core/version.h>
 
 extern "C"
@@ -59,12 +69,215 @@ const size_t nRenderThreads = 1;
 const size_t nUploadThreads = 4;
 const size_t nComputeThreads = 2;
 const size_t nAsyncUploadThreads = 1;
+const size_t nCacheShards = 4 * nUploadThreads; // Upload threads rarely share a lock
 PluginRegisterer< GLRaycastPipeline, const std::string& > registerer;
 
+// A render thread renders one data set
 boost::thread_specific_ptr< TextureCache > textureCache;
 boost::thread_specific_ptr< TexturePool > texturePool;
-std::unique_ptr< DataCache > dataCache;
-std::unique_ptr< HistogramCache > histogramCache;
+
+// The frames a render thread may have in flight, i.e. uploading in the
+// background while the next frames are rendered
+const size_t maxFrames = 3;
+
+// Sets an input of a filter of the channel, which is created for every frame,
+// with the data of a frame filter. The frame filters are reset for the next
+// frames, so the filters of the channel are not connected to them.
+void forward( const PipeFilter& src, const PortId srcPort, PipeFilter& dst, const PortId dstPort )
+{
+    const Future future = src.getFuture( srcPort );
+    Promise promise = dst.getPromise( dstPort );
+    future.onReady( [future, promise]() mutable { promise.setData( future.getData( )); });
+}
+
+// The port ids of the filters of the channel, which are the same every frame
+struct ChannelPorts
+{
+    explicit ChannelPorts( const PipeFilterMap& filters )
+        : histogram( filters.find( "SendHistogramFilter" )->second.getInputPortId( "Histogram" ))
+        , histogramViewport( filters.find( "SendHistogramFilter" )->second.getInputPortId(
+                                 "RelativeViewport" ))
+        , histogramId( filters.find( "SendHistogramFilter" )->second.getInputPortId( "Id" ))
+        , visibleNodes( filters.find( "PreRenderFilter" )->second.getInputPortId( "VisibleNodes" ))
+        , frustum( filters.find( "PreRenderFilter" )->second.getInputPortId( "Frustum" ))
+        , renderingDone( filters.find( "RedrawFilter" )->second.getInputPortId( "RenderingDone" ))
+    {}
+
+    const PortId histogram;
+    const PortId histogramViewport;
+    const PortId histogramId;
+    const PortId visibleNodes;
+    const PortId frustum;
+    const PortId renderingDone;
+};
+
+// The filters of a frame, which are built once per render thread and reset
+// for the next frames. A frame is reused once the filters of its pipeline
+// executed.
+struct Frame
+{
+    Frame( DatasetCaches& caches_, DataSource& dataSource_, Renderer& renderer_ )
+        : caches( caches_ )
+        , dataSource( dataSource_ )
+        , renderer( renderer_ )
+        , visibleSetGenerator( pipeline.add< VisibleSetGeneratorFilter >( "VisibleSetGenerator",
+                                                                          dataSource ))
+        , histogramFilter( pipeline.add< HistogramFilter >( "HistogramFilter",
+                                                            *caches.histogramCache,
+                                                            *caches.dataCache,
+                                                            dataSource ))
+        , frustumPort( visibleSetGenerator.getInputPortId( "Frustum" ))
+        , framePort( visibleSetGenerator.getInputPortId( "Frame" ))
+        , dataRangePort( visibleSetGenerator.getInputPortId( "DataRange" ))
+        , paramsPort( visibleSetGenerator.getInputPortId( "Params" ))
+        , viewportPort( visibleSetGenerator.getInputPortId( "Viewport" ))
+        , clipPlanesPort( visibleSetGenerator.getInputPortId( "ClipPlanes" ))
+        , visibleNodesPort( visibleSetGenerator.getOutputPortId( "VisibleNodes" ))
+        , histogramFrustumPort( histogramFilter.getInputPortId( "Frustum" ))
+        , histogramViewportPort( histogramFilter.getInputPortId( "RelativeViewport" ))
+        , histogramRangePort( histogramFilter.getInputPortId( "DataSourceRange" ))
+        , histogramPort( histogramFilter.getOutputPortId( "Histogram" ))
+    {}
+
+    bool isExecuted() const
+    {
+        for( const Future& future: pipeline.getPostconditions( ))
+        {
+            if( !future.isReady( ))
+                return false;
+        }
+        return true;
+    }
+
+    void wait() const
+    {
+        for( const Future& future: pipeline.getPostconditions( ))
+            future.wait();
+    }
+
+    const DatasetCaches& caches;
+    const DataSource& dataSource;
+    const Renderer& renderer;
+    Pipeline pipeline; // All the filters of the frame
+    PipeFilter visibleSetGenerator;
+    PipeFilter histogramFilter;
+    const PortId frustumPort;
+    const PortId framePort;
+    const PortId dataRangePort;
+    const PortId paramsPort;
+    const PortId viewportPort;
+    const PortId clipPlanesPort;
+    const PortId visibleNodesPort;
+    const PortId histogramFrustumPort;
+    const PortId histogramViewportPort;
+    const PortId histogramRangePort;
+    const PortId histogramPort;
+};
+
+// Renders the textures loaded so far, while the missing ones are uploaded
+struct AsyncFrame : public Frame
+{
+    AsyncFrame( DatasetCaches& caches_, DataSource& dataSource, Renderer& renderer,
+                Executor& uploadExecutor )
+        : Frame( caches_, dataSource, renderer )
+        , renderingSetGenerator( pipeline.add< RenderingSetGeneratorFilter< TextureObject >>(
+                                     "RenderingSetGenerator", *textureCache ))
+        , renderUploader( pipeline.add< GLRenderUploadFilter >( "RenderUploader",
+                                                                *caches.dataCache,
+                                                                *textureCache,
+                                                                *texturePool,
+                                                                nUploadThreads,
+                                                                uploadExecutor,
+                                                                caches.compressedDataCache.get(),
+                                                                caches.diskCache.get(),
+                                                                caches.sharedMemoryCache.get( )))
+        , renderFilter( pipeline.add< RenderFilter >( "RenderFilter", dataSource, renderer ))
+        , renderingDonePort( renderingSetGenerator.getOutputPortId( "RenderingDone" ))
+        , statisticsPort( renderingSetGenerator.getOutputPortId( "RenderStatistics" ))
+        , uploaderInputsPort( renderUploader.getInputPortId( "RenderInputs" ))
+        , renderInputsPort( renderFilter.getInputPortId( "RenderInputs" ))
+        , renderStagesPort( renderFilter.getInputPortId( "RenderStages" ))
+    {
+        visibleSetGenerator.connect( "VisibleNodes", renderingSetGenerator, "VisibleNodes" );
+        visibleSetGenerator.connect( "VisibleNodes", renderUploader, "NodeIds" );
+        renderingSetGenerator.connect( "CacheObjects", renderFilter, "CacheObjects" );
+        renderingSetGenerator.connect( "NodeIds", histogramFilter, "NodeIds" );
+    }
+
+    PipeFilter renderingSetGenerator;
+    PipeFilter renderUploader;
+    PipeFilter renderFilter;
+    const PortId renderingDonePort;
+    const PortId statisticsPort;
+    const PortId uploaderInputsPort;
+    const PortId renderInputsPort;
+    const PortId renderStagesPort;
+};
+
+// Renders once all the visible textures are uploaded, in passes if they do
+// not fit in the texture cache. The filters of a pass are reset for the next
+// pass, they are done once it is rendered.
+struct SyncFrame : public Frame
+{
+    SyncFrame( DatasetCaches& caches_, DataSource& dataSource, Renderer& renderer,
+               Executor& uploadExecutor )
+        : Frame( caches_, dataSource, renderer )
+        , renderUploader( pipeline.add< GLRenderUploadFilter, false >( "RenderUploader",
+                                                                       *caches.dataCache,
+                                                                       *textureCache,
+                                                                       *texturePool,
+                                                                       nUploadThreads,
+                                                                       uploadExecutor,
+                                                                       caches.compressedDataCache.get(),
+                                                                       caches.diskCache.get(),
+                                                                       caches.sharedMemoryCache.get( )))
+        , renderFilter( pipeline.add< RenderFilter, false >( "RenderFilter", dataSource, renderer ))
+        , histogramNodesPort( histogramFilter.getInputPortId( "NodeIds" ))
+        , uploaderInputsPort( renderUploader.getInputPortId( "RenderInputs" ))
+        , uploaderNodesPort( renderUploader.getInputPortId( "NodeIds" ))
+        , renderInputsPort( renderFilter.getInputPortId( "RenderInputs" ))
+        , renderStagesPort( renderFilter.getInputPortId( "RenderStages" ))
+    {
+        renderUploader.connect( "TextureCacheObjects", renderFilter, "CacheObjects" );
+    }
+
+    PipeFilter renderUploader;
+    PipeFilter renderFilter;
+    const PortId histogramNodesPort;
+    const PortId uploaderInputsPort;
+    const PortId uploaderNodesPort;
+    const PortId renderInputsPort;
+    const PortId renderStagesPort;
+};
+
+// Takes the oldest frame once it is executed, or builds another one while
+// there are few frames in flight. The frame is given back once all its
+// filters are scheduled, so a frame which failed to render is not waited for.
+template< class FrameT >
+std::unique_ptr< FrameT > takeFrame( std::deque< std::unique_ptr< FrameT >>& frames,
+                                     DatasetCaches& caches, DataSource& dataSource,
+                                     Renderer& renderer, Executor& uploadExecutor )
+{
+    // The frames of another data set or renderer are not reused
+    if( !frames.empty() && ( &frames.front()->caches != &caches ||
+                             &frames.front()->dataSource != &dataSource ||
+                             &frames.front()->renderer != &renderer ))
+    {
+        for( const auto& frame: frames )
+            frame->wait();
+        frames.clear();
+    }
+
+    if( frames.empty() || ( frames.size() < maxFrames && !frames.front()->isExecuted( )))
+        return std::unique_ptr< FrameT >( new FrameT( caches, dataSource, renderer,
+                                                      uploadExecutor ));
+
+    std::unique_ptr< FrameT > frame = std::move( frames.front( ));
+    frames.pop_front();
+    frame->wait();
+    frame->pipeline.reset();
+    return frame;
+}
 }
 
 struct GLRaycastPipeline::Impl
@@ -77,16 +290,57 @@ struct GLRaycastPipeline::Impl
     {
     }
 
-    void setupVisibleGeneratorFilter( PipeFilter& visibleSetGenerator,
-                                      const RenderInputs& renderInputs ) const
+    ~Impl()
+    {
+        // The filters of the frames in flight use the renderer and the caches
+        for( const auto& frame: _syncFrames )
+            frame->wait();
+        for( const auto& frame: _asyncFrames )
+            frame->wait();
+    }
+
+    // Sets the inputs of the frame filters and of the channel filters which
+    // are the same in both rendering modes
+    void setupFrame( Frame& frame, const RenderInputs& renderInputs )
     {
-        visibleSetGenerator.getPromise( "Frustum" ).set( renderInputs.frameInfo.frustum );
-        visibleSetGenerator.getPromise( "Frame" ).set( renderInputs.frameInfo.timeStep );
-        visibleSetGenerator.getPromise( "DataRange" ).set( renderInputs.renderDataRange );
-        visibleSetGenerator.getPromise( "Params" ).set( renderInputs.vrParameters );
-        visibleSetGenerator.getPromise( "Viewport" ).set( renderInputs.pixelViewPort );
-        visibleSetGenerator.getPromise( "ClipPlanes" ).set(
+        if( !_channelPorts )
+            _channelPorts.reset( new ChannelPorts( renderInputs.filters ));
+
+        PipeFilter& visibleSetGenerator = frame.visibleSetGenerator;
+        visibleSetGenerator.getPromise( frame.frustumPort ).set( renderInputs.frameInfo.frustum );
+        visibleSetGenerator.getPromise( frame.framePort ).set( renderInputs.frameInfo.timeStep );
+        visibleSetGenerator.getPromise( frame.dataRangePort ).set( renderInputs.renderDataRange );
+        visibleSetGenerator.getPromise( frame.paramsPort ).set( renderInputs.vrParameters );
+        visibleSetGenerator.getPromise( frame.viewportPort ).set( renderInputs.pixelViewPort );
+        visibleSetGenerator.getPromise( frame.clipPlanesPort ).set(
                     renderInputs.renderSettings.getClipPlanes( ));
+
+        PipeFilter& histogramFilter = frame.histogramFilter;
+        histogramFilter.getPromise( frame.histogramFrustumPort ).set( renderInputs.frameInfo.frustum );
+        histogramFilter.getPromise( frame.histogramViewportPort ).set( renderInputs.viewport );
+        histogramFilter.getPromise( frame.histogramRangePort ).set( renderInputs.dataSourceRange );
+
+        PipeFilter sendHistogramFilter = renderInputs.filters.find( "SendHistogramFilter" )->second;
+        PipeFilter preRenderFilter = renderInputs.filters.find( "PreRenderFilter" )->second;
+        forward( histogramFilter, frame.histogramPort, sendHistogramFilter, _channelPorts->histogram );
+        sendHistogramFilter.getPromise( _channelPorts->histogramViewport ).set( renderInputs.viewport );
+        sendHistogramFilter.getPromise( _channelPorts->histogramId ).set( renderInputs.frameInfo.frameId );
+        forward( visibleSetGenerator, frame.visibleNodesPort, preRenderFilter,
+                 _channelPorts->visibleNodes );
+        preRenderFilter.getPromise( _channelPorts->frustum ).set( renderInputs.frameInfo.frustum );
+
+        setPriority( histogramFilter, PRIORITY_BACKGROUND, renderInputs );
+        setPriority( sendHistogramFilter, PRIORITY_BACKGROUND, renderInputs );
+    }
+
+    // The filters of a frame run before all others once a newer frame is
+    // scheduled, as takeFrame() waits for the oldest frame
+    void setPriority( PipeFilter& filter,
+                      const ExecutablePriority priority,
+                      const RenderInputs& renderInputs ) const
+    {
+        filter.setPriority( priority );
+        filter.setFrame( renderInputs.frameInfo.frameId );
     }
 
     // Sort helper function for sorting the textures with their distances to viewpoint
@@ -114,21 +368,24 @@ struct GLRaycastPipeline::Impl
 
     void renderSync( RenderStatistics& statistics,
                      Renderer& renderer,
-                     const RenderInputs& renderInputs )
+                     const RenderInputs& renderInputs,
+                     DatasetCaches& caches )
     {
+        std::unique_ptr< SyncFrame > framePtr = takeFrame( _syncFrames, caches,
+                                                           renderInputs.dataSource, renderer,
+                                                           _uploadExecutor );
+        SyncFrame& frame = *framePtr;
+        setupFrame( frame, renderInputs );
 
+        // The render inputs are shared by the filters of the frame
+        const PortDataPtr renderInputsData = makePortData( renderInputs );
         PipeFilter sendHistogramFilter = renderInputs.filters.find( "SendHistogramFilter" )->second;
         PipeFilter preRenderFilter = renderInputs.filters.find( "PreRenderFilter" )->second;
-        PipeFilterT< VisibleSetGeneratorFilter > visibleSetGenerator( "VisibleSetGenerator",
-                                                                      renderInputs.dataSource );
-        setupVisibleGeneratorFilter( visibleSetGenerator, renderInputs );
-        visibleSetGenerator.connect( "VisibleNodes", preRenderFilter, "VisibleNodes" );
-        preRenderFilter.getPromise( "Frustum" ).set( renderInputs.frameInfo.frustum );
-        visibleSetGenerator.execute();
+        frame.visibleSetGenerator.execute();
         preRenderFilter.execute();
 
-        const livre::UniqueFutureMap portFutures( visibleSetGenerator.getPostconditions( ));
-        NodeIds nodeIdsCopy = portFutures.get< NodeIds >( "VisibleNodes" );
+        const Future visibleNodes = frame.visibleSetGenerator.getFuture( frame.visibleNodesPort );
+        NodeIds nodeIdsCopy = visibleNodes.get< NodeIds >();
         DistanceOperator distanceOp( renderInputs.dataSource, renderInputs.frameInfo.frustum );
         std::sort( nodeIdsCopy.begin(), nodeIdsCopy.end(), distanceOp );
 
@@ -160,135 +417,91 @@ struct GLRaycastPipeline::Impl
 
             const uint32_t startIndex = i * maxNodesPerPass;
             const uint32_t endIndex = ( i + 1 ) * maxNodesPerPass;
-            const NodeIds nodesPerPass( nodeIdsCopy.begin() + startIndex,
-                                        endIndex > nodeIdsCopy.size() ? nodeIdsCopy.end() :
-                                        nodeIdsCopy.begin() + endIndex );
-
-            createAndExecuteSyncPass( nodesPerPass,
-                                      renderInputs,
-                                      renderer,
-                                      renderStages );
+            NodeIds nodesPerPass( nodeIdsCopy.begin() + startIndex,
+                                  endIndex > nodeIdsCopy.size() ? nodeIdsCopy.end() :
+                                  nodeIdsCopy.begin() + endIndex );
+
+            executeSyncPass( frame,
+                             std::move( nodesPerPass ),
+                             renderInputs,
+                             renderInputsData,
+                             renderStages );
             if( numberOfPasses > 1 )
                 ++(*showProgress);
         }
 
-        PipeFilterT< HistogramFilter > histogramFilter( "HistogramFilter",
-                                                        *histogramCache,
-                                                        *dataCache,
-                                                        renderInputs.dataSource );
-        histogramFilter.getPromise( "Frustum" ).set( renderInputs.frameInfo.frustum );
-        histogramFilter.connect( "Histogram", sendHistogramFilter, "Histogram" );
-        histogramFilter.getPromise( "RelativeViewport" ).set( renderInputs.viewport );
-        histogramFilter.getPromise( "DataSourceRange" ).set( renderInputs.dataSourceRange );
-        histogramFilter.getPromise( "NodeIds" ).set( nodeIdsCopy );
-
-        sendHistogramFilter.getPromise( "RelativeViewport" ).set( renderInputs.viewport );
-        sendHistogramFilter.getPromise( "Id" ).set( renderInputs.frameInfo.frameId );
-
-        histogramFilter.schedule( _computeExecutor );
+        frame.histogramFilter.getPromise( frame.histogramNodesPort ).set( std::move( nodeIdsCopy ));
+        frame.histogramFilter.schedule( _computeExecutor );
         sendHistogramFilter.schedule( _computeExecutor );
 
-        const UniqueFutureMap futures( visibleSetGenerator.getPostconditions( ));
-        statistics.nAvailable = futures.get< NodeIds >( "VisibleNodes" ).size();
+        statistics.nAvailable = visibleNodes.get< NodeIds >().size();
         statistics.nNotAvailable = 0;
         statistics.nRenderAvailable = statistics.nAvailable;
+        _syncFrames.push_back( std::move( framePtr ));
     }
 
-    void createAndExecuteSyncPass( NodeIds nodeIds,
-                                   const RenderInputs& renderInputs,
-                                   Renderer& renderer,
-                                   const uint32_t renderStages )
+    void executeSyncPass( SyncFrame& frame,
+                          NodeIds nodeIds,
+                          const RenderInputs& renderInputs,
+                          const PortDataPtr& renderInputsData,
+                          const uint32_t renderStages )
     {
+        // The previous pass is rendered, so its filters are done
+        PipeFilter& renderFilter = frame.renderFilter;
+        PipeFilter& renderUploader = frame.renderUploader;
+        renderFilter.reset();
+        renderUploader.reset();
+
+        renderFilter.getPromise( frame.renderInputsPort ).setData( renderInputsData );
+        renderFilter.getPromise( frame.renderStagesPort ).set( renderStages );
+        renderUploader.getPromise( frame.uploaderInputsPort ).setData( renderInputsData );
+        renderUploader.getPromise( frame.uploaderNodesPort ).set( std::move( nodeIds ));
+        setPriority( renderUploader, PRIORITY_RENDER, renderInputs );
 
-        Pipeline renderPipeline;
-
-        PipeFilterT< RenderFilter > renderFilter( "RenderFilter",
-                                                  renderInputs.dataSource,
-                                                  renderer );
-        renderFilter.getPromise( "RenderInputs" ).set( renderInputs );
-        renderFilter.getPromise( "RenderStages" ).set( renderStages );
-
-        PipeFilterT< GLRenderUploadFilter > renderUploader( "RenderUploader",
-                                                            *dataCache,
-                                                            *textureCache,
-                                                            *texturePool,
-                                                            nUploadThreads,
-                                                            _uploadExecutor );
-
-        renderUploader.getPromise( "RenderInputs" ).set( renderInputs );
-        renderUploader.getPromise( "NodeIds" ).set( nodeIds );
-        renderUploader.connect( "TextureCacheObjects", renderFilter, "CacheObjects" );
-
-        renderPipeline.schedule( _renderExecutor );
         renderUploader.schedule( _uploadExecutor );
         renderFilter.execute();
     }
 
-
     void renderAsync( RenderStatistics& statistics,
                       Renderer& renderer,
-                      const RenderInputs& renderInputs )
+                      const RenderInputs& renderInputs,
+                      DatasetCaches& caches )
     {
+        std::unique_ptr< AsyncFrame > framePtr = takeFrame( _asyncFrames, caches,
+                                                            renderInputs.dataSource, renderer,
+                                                            _uploadExecutor );
+        AsyncFrame& frame = *framePtr;
+        setupFrame( frame, renderInputs );
+
+        // The render inputs are shared by the filters of the frame
+        const PortDataPtr renderInputsData = makePortData( renderInputs );
         PipeFilter sendHistogramFilter = renderInputs.filters.find( "SendHistogramFilter" )->second;
         PipeFilter preRenderFilter = renderInputs.filters.find( "PreRenderFilter" )->second;
         PipeFilter redrawFilter = renderInputs.filters.find( "RedrawFilter" )->second;
-        PipeFilterT< HistogramFilter > histogramFilter( "HistogramFilter",
-                                                        *histogramCache,
-                                                        *dataCache,
-                                                        renderInputs.dataSource );
-        histogramFilter.getPromise( "Frustum" ).set( renderInputs.frameInfo.frustum );
-        histogramFilter.connect( "Histogram", sendHistogramFilter, "Histogram" );
-        histogramFilter.getPromise( "RelativeViewport" ).set( renderInputs.viewport );
-        histogramFilter.getPromise( "DataSourceRange" ).set( renderInputs.dataSourceRange );
-        sendHistogramFilter.getPromise( "RelativeViewport" ).set( renderInputs.viewport );
-        sendHistogramFilter.getPromise( "Id" ).set( renderInputs.frameInfo.frameId );
-        preRenderFilter.getPromise( "Frustum" ).set( renderInputs.frameInfo.frustum );
-
-        Pipeline renderPipeline;
-        Pipeline uploadPipeline;
-
-        PipeFilterT< RenderFilter > renderFilter( "RenderFilter",
-                                                  renderInputs.dataSource,
-                                                  renderer );
-
-        PipeFilter visibleSetGenerator =
-                renderPipeline.add< VisibleSetGeneratorFilter >(
-                    "VisibleSetGenerator", renderInputs.dataSource );
-        setupVisibleGeneratorFilter( visibleSetGenerator, renderInputs );
-
-        PipeFilter renderingSetGenerator =
-                renderPipeline.add< RenderingSetGeneratorFilter< TextureObject >>(
-                    "RenderingSetGenerator", *textureCache );
-
-        visibleSetGenerator.connect( "VisibleNodes", renderingSetGenerator, "VisibleNodes" );
-        renderingSetGenerator.connect( "CacheObjects", renderFilter, "CacheObjects" );
-        renderingSetGenerator.connect( "NodeIds", histogramFilter, "NodeIds" );
-        renderingSetGenerator.connect( "RenderingDone", redrawFilter, "RenderingDone" );
-        visibleSetGenerator.connect( "VisibleNodes", preRenderFilter, "VisibleNodes" );
-
-        PipeFilterT< GLRenderUploadFilter > renderUploader( "RenderUploader",
-                                                           *dataCache,
-                                                           *textureCache,
-                                                           *texturePool,
-                                                           nUploadThreads,
-                                                           _uploadExecutor );
+        forward( frame.renderingSetGenerator, frame.renderingDonePort,
+                 redrawFilter, _channelPorts->renderingDone );
 
-        renderUploader.getPromise( "RenderInputs" ).set( renderInputs );
-        visibleSetGenerator.connect( "VisibleNodes", renderUploader, "NodeIds" );
+        frame.renderUploader.getPromise( frame.uploaderInputsPort ).setData( renderInputsData );
+        frame.renderFilter.getPromise( frame.renderInputsPort ).setData( renderInputsData );
+        frame.renderFilter.getPromise( frame.renderStagesPort ).set( RENDER_ALL );
 
-        renderFilter.getPromise( "RenderInputs" ).set( renderInputs );
-        renderFilter.getPromise( "RenderStages" ).set( RENDER_ALL );
+        setPriority( frame.visibleSetGenerator, PRIORITY_RENDER, renderInputs );
+        setPriority( frame.renderingSetGenerator, PRIORITY_RENDER, renderInputs );
+        setPriority( frame.renderUploader, PRIORITY_RENDER, renderInputs );
+        setPriority( redrawFilter, PRIORITY_RENDER, renderInputs );
 
         redrawFilter.schedule( _renderExecutor );
-        renderPipeline.schedule( _renderExecutor );
-        renderUploader.schedule( _asyncUploadExecutor );
+        frame.visibleSetGenerator.schedule( _renderExecutor );
+        frame.renderingSetGenerator.schedule( _renderExecutor );
+        frame.renderUploader.schedule( _asyncUploadExecutor );
         sendHistogramFilter.schedule( _computeExecutor );
-        histogramFilter.schedule( _computeExecutor );
+        frame.histogramFilter.schedule( _computeExecutor );
         preRenderFilter.execute();
-        renderFilter.execute();
+        frame.renderFilter.execute();
 
-        const UniqueFutureMap futures( renderingSetGenerator.getPostconditions( ));
-        statistics = futures.get< RenderStatistics >( "RenderStatistics" );
+        const Future futureStatistics = frame.renderingSetGenerator.getFuture( frame.statisticsPort );
+        statistics = futureStatistics.get< RenderStatistics >();
+        _asyncFrames.push_back( std::move( framePtr ));
     }
 
     void initTextureCache( const RenderInputs& renderInputs )
@@ -296,22 +509,13 @@ struct GLRaycastPipeline::Impl
         if( textureCache.get( ))
             return;
 
-        ScopedLock lock( _initMutex );
-        if( textureCache.get( ))
-            return;
-
         const RendererParameters& vrParams = renderInputs.vrParameters;
         const size_t gpuMem = vrParams.getMaxGPUCacheMemoryMB() * LB_1MB;
-        textureCache.reset( new TextureCache( "TextureCache", gpuMem ));
+        textureCache.reset( new TextureCache( "TextureCache", gpuMem, nCacheShards,
+                                              CachePolicyType( vrParams.getTextureCachePolicy( ))));
+        pinLevels( *textureCache, vrParams.getPinnedLevels(),
+                   vrParams.getPinnedGPUCacheMemoryMB() * LB_1MB );
         texturePool.reset( new TexturePool( renderInputs.dataSource ));
-
-        if( !dataCache )
-            dataCache.reset( new DataCache( "Data Cache",
-                                            vrParams.getMaxCPUCacheMemoryMB() * LB_1MB ));
-
-        if( !histogramCache )
-            histogramCache.reset( new HistogramCache( "Histogram Cache",
-                                                      32 * LB_1MB )); // 32 MB
     }
 
     void render( RenderStatistics& statistics,
@@ -319,17 +523,51 @@ struct GLRaycastPipeline::Impl
                  const RenderInputs& renderInputs )
     {
         initTextureCache( renderInputs );
+        const std::string& datasetId = DatasetCaches::getDatasetId( renderInputs.dataSource );
+        DatasetCaches& caches = DatasetCaches::get( renderInputs, datasetId, nCacheShards );
+        if( caches.dataCacheTrace )
+            caches.dataCacheTrace->setFrame( renderInputs.frameInfo.frameId );
         if( renderInputs.vrParameters.getSynchronousMode( ))
-            renderSync( statistics, renderer, renderInputs );
+            renderSync( statistics, renderer, renderInputs, caches );
         else
-            renderAsync( statistics, renderer, renderInputs );
+            renderAsync( statistics, renderer, renderInputs, caches );
+        updateCacheStatistics( statistics, caches, datasetId );
+    }
+
+    void updateCacheStatistics( RenderStatistics& statistics,
+                                const DatasetCaches& caches,
+                                const std::string& datasetId )
+    {
+        std::vector< CacheStatisticsSnapshot > snapshots =
+        {
+            caches.dataCache->getStatistics().getSnapshot(),
+            textureCache->getStatistics().getSnapshot(),
+            caches.histogramCache->getStatistics().getSnapshot()
+        };
+        if( caches.compressedDataCache )
+            snapshots.push_back( caches.compressedDataCache->getStatistics().getSnapshot( ));
+        if( caches.diskCache )
+            snapshots.push_back( caches.diskCache->getStatistics().getSnapshot( ));
+        if( caches.sharedMemoryCache )
+            snapshots.push_back( caches.sharedMemoryCache->getStatistics().getSnapshot( ));
+
+        // The caches are shared, so the difference also includes the activity
+        // of the other renderers since the previous frame of this one
+        std::vector< CacheStatisticsSnapshot >& previousSnapshots = _cacheSnapshots[ datasetId ];
+        previousSnapshots.resize( snapshots.size( ));
+        for( size_t i = 0; i < snapshots.size(); ++i )
+            statistics.cacheStatistics.push_back( snapshots[ i ] - previousSnapshots[ i ]);
+        previousSnapshots = snapshots;
     }
 
     SimpleExecutor _renderExecutor;
     SimpleExecutor _computeExecutor;
     SimpleExecutor _uploadExecutor;
     SimpleExecutor _asyncUploadExecutor;
-    boost::mutex _initMutex;
+    std::map< std::string, std::vector< CacheStatisticsSnapshot >> _cacheSnapshots;
+    std::unique_ptr< const ChannelPorts > _channelPorts;
+    std::deque< std::unique_ptr< SyncFrame >> _syncFrames;
+    std::deque< std::unique_ptr< AsyncFrame >> _asyncFrames;
 };
 
 GLRaycastPipeline::GLRaycastPipeline( const std::string& name )
@@ -44,12 +44,18 @@ public:
           TextureCache& textureCache,
           TexturePool& texturePool,
           size_t nUploadThreads,
-          Executor& executor )
+          Executor& executor,
+          CompressedDataCache* compressedCache,
+          DiskCache* diskCache,
+          SharedMemoryCache* sharedCache )
         : _dataCache( dataCache )
         , _textureCache( textureCache )
         , _texturePool( texturePool )
         , _nUploadThreads( nUploadThreads )
         , _executor( executor )
+        , _compressedCache( compressedCache )
+        , _diskCache( diskCache )
+        , _sharedCache( sharedCache )
     {}
 
     void execute( const FutureMap& input, PromiseMap& output ) const
@@ -58,21 +64,33 @@ public:
         ConstCacheObjects cacheObjects; // Lock
         NodeIds notAvailable;
         const auto& renderInputs = futureMap.get< RenderInputs >( "RenderInputs" );
-        for( const auto& nodeId: futureMap.get< NodeIds >( "NodeIds" ))
+        const auto& nodeIds = futureMap.get< NodeIds >( "NodeIds" );
+
+        CacheIds visibles;
+        visibles.reserve( nodeIds.size( ));
+        for( const auto& nodeId: nodeIds )
+            visibles.push_back( nodeId.getId( ));
+        _textureCache.setVisibles( visibles );
+        _dataCache.setVisibles( visibles );
+
+        const Futures futures = _textureCache.loadMany( visibles,
+                                                        _dataCache,
+                                                        renderInputs.dataSource,
+                                                        _texturePool );
+        NodeIds::const_iterator nodeId = nodeIds.begin();
+        for( const auto& future: futures )
         {
-            const auto& cacheObj = _textureCache.load( nodeId.getId(),
-                                                       _dataCache,
-                                                       renderInputs.dataSource,
-                                                       _texturePool );
+            const auto& cacheObj = future.get< ConstTextureObjectPtr >();
             if( cacheObj )
                 cacheObjects.push_back( cacheObj );
             else
-                notAvailable.push_back( nodeId );
+                notAvailable.push_back( *nodeId );
+            ++nodeId;
         }
 
         if( notAvailable.empty( ))
         {
-             output.set( "TextureCacheObjects", cacheObjects );
+             output.set( "TextureCacheObjects", std::move( cacheObjects ));
              return;
         }
 
@@ -82,7 +100,11 @@ public:
                                                                           _dataCache,
                                                                           _textureCache,
                                                                           _texturePool );
-        textureUploader.getPromise( "RenderInputs" ).set( renderInputs );
+        // The render inputs of the frame are shared by the uploaders
+        const PortDataPtr renderInputsData = futureMap.getFuture( "RenderInputs" ).getData();
+        textureUploader.getPromise( "RenderInputs" ).setData( renderInputsData );
+        textureUploader.setPriority( PRIORITY_RENDER );
+        textureUploader.setFrame( renderInputs.frameInfo.frameId );
         for( size_t i = 0; i < _nUploadThreads; ++i )
         {
             if( i * perThreadSize >= notAvailable.size( ))
@@ -98,10 +120,16 @@ public:
                                       begin + perThreadSize );
             std::stringstream str;
             str << "DataUploader" << i;
-            PipeFilter dataUploader = pipeline.add< DataUploadFilter >( str.str( ), _dataCache );
+            PipeFilter dataUploader = pipeline.add< DataUploadFilter >( str.str( ),
+                                                                        _dataCache,
+                                                                        _compressedCache,
+                                                                        _diskCache,
+                                                                        _sharedCache );
             dataUploader.connect( "DataCacheObjects", textureUploader, "DataCacheObjects" );
-            dataUploader.getPromise( "RenderInputs" ).set( renderInputs );
-            dataUploader.getPromise( "NodeIds" ).set( partialData );
+            dataUploader.getPromise( "RenderInputs" ).setData( renderInputsData );
+            dataUploader.getPromise( "NodeIds" ).set( std::move( partialData ));
+            dataUploader.setPriority( PRIORITY_RENDER );
+            dataUploader.setFrame( renderInputs.frameInfo.frameId );
         }
 
         pipeline.schedule( _executor );
@@ -113,7 +141,7 @@ public:
                              textureCacheObjects.end( ));
 
         glFinish();
-        output.set( "TextureCacheObjects", cacheObjects );
+        output.set( "TextureCacheObjects", std::move( cacheObjects ));
     }
 
     DataCache& _dataCache;
@@ -121,18 +149,27 @@ public:
     TexturePool& _texturePool;
     const size_t _nUploadThreads;
     Executor& _executor;
+    CompressedDataCache* const _compressedCache;
+    DiskCache* const _diskCache;
+    SharedMemoryCache* const _sharedCache;
 };
 
 GLRenderUploadFilter::GLRenderUploadFilter( DataCache& dataCache,
                                             TextureCache& textureCache,
                                             TexturePool& texturePool,
                                             size_t nUploadThreads,
-                                            Executor& executor )
+                                            Executor& executor,
+                                            CompressedDataCache* compressedCache,
+                                            DiskCache* diskCache,
+                                            SharedMemoryCache* sharedCache )
     : _impl( new GLRenderUploadFilter::Impl( dataCache,
                                              textureCache,
                                              texturePool,
                                              nUploadThreads,
-                                             executor ))
+                                             executor,
+                                             compressedCache,
+                                             diskCache,
+                                             sharedCache ))
 {
 }
 
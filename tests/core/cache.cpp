@@ -26,6 +26,46 @@
 #include <livre/core/cache/Cache.h>
 #include <livre/core/cache/CacheStatistics.h>
 
+#include <boost/thread/thread.hpp>
+
+#include <thread>
+
+namespace
+{
+std::atomic< size_t > nConstructions( 0 );
+
+class SlowCacheObject : public livre::CacheObject
+{
+public:
+
+    SlowCacheObject( const livre::CacheId& cacheId, const size_t delayMs )
+        : livre::CacheObject( cacheId )
+    {
+        ++nConstructions;
+        std::this_thread::sleep_for( std::chrono::milliseconds( delayMs ));
+    }
+
+    size_t getSize( ) const final { return test::OBJECT_SIZE; }
+};
+
+typedef std::shared_ptr< const SlowCacheObject > ConstSlowCacheObjectPtr;
+
+// Cannot be loaded for the odd ids
+class OddFailingCacheObject : public livre::CacheObject
+{
+public:
+
+    explicit OddFailingCacheObject( const livre::CacheId& cacheId )
+        : livre::CacheObject( cacheId )
+    {
+        if( cacheId % 2 )
+            LBTHROW( livre::CacheLoadException( cacheId, "Odd id" ));
+    }
+
+    size_t getSize( ) const final { return test::OBJECT_SIZE; }
+};
+}
+
 BOOST_AUTO_TEST_CASE( testCache )
 {
     const size_t maxMemBytes = 2048u;
@@ -74,3 +114,390 @@ BOOST_AUTO_TEST_CASE( testCache )
     BOOST_CHECK_EQUAL( cache.getCount(), 0 );
     BOOST_CHECK_EQUAL( cache.getStatistics().getUsedMemory(), 0 );
 }
+
+BOOST_AUTO_TEST_CASE( testCacheLRUOrder )
+{
+    // Room for two objects, the third load evicts the least recently used one
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 2 * test::OBJECT_SIZE + 1 );
+
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.load( 2 ));
+    BOOST_CHECK( cache.load( 1 )); // 1 becomes the most recently used
+    BOOST_CHECK( cache.load( 3 ));
+
+    BOOST_CHECK_EQUAL( cache.getCount(), 2 );
+    BOOST_CHECK( cache.get( 1 ));
+    BOOST_CHECK( !cache.get( 2 ));
+    BOOST_CHECK( cache.get( 3 ));
+
+    // Referenced objects are skipped and the next least recently used is evicted
+    livre::ConstCacheObjectPtr referenced = cache.get( 1 );
+    BOOST_CHECK( cache.load( 4 ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 2 );
+    BOOST_CHECK( cache.get( 1 ));
+    BOOST_CHECK( !cache.get( 3 ));
+    BOOST_CHECK( cache.get( 4 ));
+}
+
+BOOST_AUTO_TEST_CASE( testCacheLFUPolicy )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 3 * test::OBJECT_SIZE + 1,
+                                                  1, livre::CP_LFU );
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.load( 2 ));
+    BOOST_CHECK( cache.load( 2 ));
+    BOOST_CHECK( cache.load( 3 ));
+
+    // 3 is the least frequently used, although 1 is the least recently used
+    BOOST_CHECK( cache.load( 4 ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 3 );
+    BOOST_CHECK( cache.get( 1 ));
+    BOOST_CHECK( cache.get( 2 ));
+    BOOST_CHECK( !cache.get( 3 ));
+    BOOST_CHECK( cache.get( 4 ));
+}
+
+BOOST_AUTO_TEST_CASE( testCache2QPolicy )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 4 * test::OBJECT_SIZE + 1,
+                                                  1, livre::CP_2Q );
+    for( livre::CacheId id = 1; id <= 6; ++id )
+        BOOST_CHECK( cache.load( id ));
+
+    // 1 and 2 are evicted first, reloading them soon marks them as frequently used
+    BOOST_CHECK( !cache.get( 1 ));
+    BOOST_CHECK( !cache.get( 2 ));
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.load( 2 ));
+
+    // A scan through objects which are used only once does not evict them
+    for( livre::CacheId id = 100; id < 110; ++id )
+        BOOST_CHECK( cache.load( id ));
+
+    BOOST_CHECK_EQUAL( cache.getCount(), 4 );
+    BOOST_CHECK( cache.get( 1 ));
+    BOOST_CHECK( cache.get( 2 ));
+    BOOST_CHECK( cache.get( 109 ));
+}
+
+BOOST_AUTO_TEST_CASE( testCacheVisiblePolicy )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 2 * test::OBJECT_SIZE + 1,
+                                                  1, livre::CP_VISIBLE );
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.load( 2 ));
+    cache.setVisibles( { 1 } );
+
+    // 1 is the least recently used, but it is visible
+    BOOST_CHECK( cache.load( 3 ));
+    BOOST_CHECK( cache.get( 1 ));
+    BOOST_CHECK( !cache.get( 2 ));
+    BOOST_CHECK( cache.get( 3 ));
+
+    // Without visible objects, the policy falls back to LRU
+    cache.setVisibles( livre::CacheIds( ));
+    BOOST_CHECK( cache.load( 4 ));
+    BOOST_CHECK( cache.get( 1 ));
+    BOOST_CHECK( !cache.get( 3 ));
+    BOOST_CHECK( cache.get( 4 ));
+}
+
+BOOST_AUTO_TEST_CASE( testCachePolicyNames )
+{
+    for( const auto& name: { "lru", "lfu", "2q", "visible" })
+        BOOST_CHECK_EQUAL( livre::getCachePolicyName( livre::getCachePolicyType( name )), name );
+
+    BOOST_CHECK_EQUAL( livre::getCachePolicyType( "2q" ), livre::CP_2Q );
+    BOOST_CHECK_THROW( livre::getCachePolicyType( "fifo" ), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( testCacheStatistics )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 2 * test::OBJECT_SIZE + 1 );
+    const livre::CacheStatistics& statistics = cache.getStatistics();
+    const livre::CacheStatisticsSnapshot start = statistics.getSnapshot();
+
+    BOOST_CHECK( !cache.get( 1 )); // miss
+    BOOST_CHECK( cache.load( 1 )); // miss
+    BOOST_CHECK( cache.load( 1 )); // hit
+    BOOST_CHECK( cache.get( 1 )); // hit
+    BOOST_CHECK( cache.load( 2 )); // miss
+    BOOST_CHECK( cache.load( 3 )); // miss, evicts 1
+    BOOST_CHECK( cache.peek( 3 )); // not counted
+    BOOST_CHECK( !cache.peek( 1 )); // not counted
+
+    BOOST_CHECK_EQUAL( statistics.getHits(), 2 );
+    BOOST_CHECK_EQUAL( statistics.getMisses(), 4 );
+    BOOST_CHECK_EQUAL( statistics.getEvictions(), 1 );
+
+    const livre::CacheStatisticsSnapshot frame = statistics.getSnapshot() - start;
+    BOOST_CHECK_EQUAL( frame.hits, 2 );
+    BOOST_CHECK_EQUAL( frame.misses, 4 );
+    BOOST_CHECK_EQUAL( frame.evictions, 1 );
+    BOOST_CHECK_EQUAL( frame.getHitRatio(), 1.f / 3.f );
+    BOOST_CHECK_EQUAL( frame.getLoadCount(), 3 );
+    BOOST_CHECK_EQUAL( frame.loadedBytes, 3 * test::OBJECT_SIZE );
+    BOOST_CHECK_EQUAL( frame.blockCount, 2 );
+    BOOST_CHECK_GT( frame.getLoadedBytesPerSecond(), 0.0 );
+    BOOST_CHECK_GT( frame.getLoadTimePercentile( 50.f ), 0.0 );
+    BOOST_CHECK_LE( frame.getLoadTimePercentile( 50.f ), frame.getLoadTimePercentile( 99.f ));
+
+    // The next frame only has the new activity
+    const livre::CacheStatisticsSnapshot previous = statistics.getSnapshot();
+    BOOST_CHECK( cache.load( 3 ));
+    const livre::CacheStatisticsSnapshot next = statistics.getSnapshot() - previous;
+    BOOST_CHECK_EQUAL( next.hits, 1 );
+    BOOST_CHECK_EQUAL( next.misses, 0 );
+    BOOST_CHECK_EQUAL( next.getLoadCount(), 0 );
+    BOOST_CHECK_EQUAL( next.getLoadTimePercentile( 99.f ), 0.0 );
+}
+
+BOOST_AUTO_TEST_CASE( testCacheLoadAsync )
+{
+    livre::Cache< SlowCacheObject > cache( "Test Cache", 4 * test::OBJECT_SIZE + 1 );
+
+    // The first request loads the object in the calling thread
+    boost::thread loader( [&cache] { cache.loadAsync( 1, 200 ); } );
+    while( !cache.getStatistics().getMisses( ))
+        std::this_thread::yield();
+
+    // Concurrent requests do not wait for the load, and share its result
+    const livre::Future future = cache.loadAsync( 1, 0 );
+    BOOST_CHECK( !future.isReady( ));
+    const ConstSlowCacheObjectPtr obj = future.get< ConstSlowCacheObjectPtr >();
+    BOOST_CHECK( obj );
+    BOOST_CHECK_EQUAL( cache.load( 1, 0 ), obj );
+    loader.join();
+
+    BOOST_CHECK_EQUAL( nConstructions, 1 );
+    BOOST_CHECK_EQUAL( cache.getCount(), 1 );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getMisses(), 2 );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getHits(), 1 );
+
+    // Loaded objects are returned with a ready future
+    BOOST_CHECK( cache.loadAsync( 1, 0 ).isReady( ));
+    BOOST_CHECK( !cache.loadAsync( livre::INVALID_CACHE_ID, 0 ).get< ConstSlowCacheObjectPtr >( ));
+}
+
+BOOST_AUTO_TEST_CASE( testCacheNotifyEvicted )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 2 * test::OBJECT_SIZE + 1, 4 );
+    livre::CacheIds evicted;
+    cache.registerNotifyEvicted(
+        [&]( const std::shared_ptr< const test::ValidCacheObject >& obj )
+        {
+            // The cache is not locked, so it can be used from the callback
+            BOOST_CHECK( !cache.get( obj->getId( )));
+            evicted.push_back( obj->getId( ));
+        });
+
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.load( 2 ));
+    BOOST_CHECK( evicted.empty( ));
+    BOOST_CHECK( cache.load( 3 ));
+    BOOST_CHECK_EQUAL( evicted.size(), 1 );
+    BOOST_CHECK_EQUAL( evicted.front(), 1 );
+
+    // Explicit unloads and purges are not evictions
+    BOOST_CHECK( cache.unload( 2 ));
+    cache.purge();
+    BOOST_CHECK_EQUAL( evicted.size(), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( testCachePinning )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 2 * test::OBJECT_SIZE + 1, 4 );
+    cache.setMaximumPinnedMemory( 2 * test::OBJECT_SIZE );
+    const livre::CacheStatistics& statistics = cache.getStatistics();
+
+    BOOST_CHECK( !cache.pin( 1 ));
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.pin( 1 ));
+    BOOST_CHECK( !cache.unload( 1 ));
+    BOOST_CHECK_EQUAL( statistics.getPinnedMemory(), test::OBJECT_SIZE );
+    BOOST_CHECK_EQUAL( statistics.getUsedMemory(), 0 );
+
+    // The pinned object is neither evicted nor counted in the maximum memory
+    for( livre::CacheId id = 2; id < 10; ++id )
+        BOOST_CHECK( cache.load( id ));
+    BOOST_CHECK( cache.get( 1 ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 3 );
+
+    // The objects loaded later are pinned within the pinned memory
+    cache.pinIf( []( const livre::CacheId& cacheId ) { return cacheId >= 100; });
+    BOOST_CHECK( cache.load( 100 ));
+    BOOST_CHECK( cache.load( 101 ));
+    BOOST_CHECK_EQUAL( statistics.getPinnedMemory(), 2 * test::OBJECT_SIZE );
+    BOOST_CHECK( !cache.pin( 101 ));
+    for( livre::CacheId id = 10; id < 20; ++id )
+        BOOST_CHECK( cache.load( id ));
+    BOOST_CHECK( cache.get( 100 ));
+    BOOST_CHECK( !cache.get( 101 ));
+
+    // Unpinned objects are evicted again
+    BOOST_CHECK( cache.unpin( 1 ));
+    BOOST_CHECK( !cache.unpin( 1 ));
+    BOOST_CHECK_EQUAL( statistics.getPinnedMemory(), test::OBJECT_SIZE );
+    for( livre::CacheId id = 20; id < 30; ++id )
+        BOOST_CHECK( cache.load( id ));
+    BOOST_CHECK( !cache.get( 1 ));
+
+    cache.purge( 100 );
+    BOOST_CHECK_EQUAL( statistics.getPinnedMemory(), 0 );
+    BOOST_CHECK_EQUAL( cache.getCount(), 2 );
+}
+
+BOOST_AUTO_TEST_CASE( testCacheLoadMany )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 6 * test::OBJECT_SIZE );
+    livre::CacheIds evicted;
+    cache.registerNotifyEvicted(
+        [&]( const std::shared_ptr< const test::ValidCacheObject >& obj )
+            { evicted.push_back( obj->getId( )); });
+
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.load( 2 ));
+    BOOST_CHECK( cache.load( 3 ));
+    BOOST_CHECK( cache.load( 4 ));
+
+    // The futures are in the order of the ids
+    const livre::CacheIds cacheIds = { 4, 5, livre::INVALID_CACHE_ID, 6, 7 };
+    const livre::Futures futures = cache.loadMany( cacheIds );
+    BOOST_REQUIRE_EQUAL( futures.size(), cacheIds.size( ));
+    livre::Futures::const_iterator future = futures.begin();
+    for( const livre::CacheId& cacheId: cacheIds )
+    {
+        BOOST_CHECK( future->isReady( ));
+        const auto obj = ( future++ )->get< test::ConstValidCacheObjectPtr >();
+        if( cacheId == livre::INVALID_CACHE_ID )
+            BOOST_CHECK( !obj );
+        else
+            BOOST_CHECK_EQUAL( obj->getId(), cacheId );
+    }
+
+    // Space for the three objects is made once they are loaded, the object
+    // found in the cache is not evicted
+    BOOST_CHECK_EQUAL( evicted.size(), 2 );
+    BOOST_CHECK_EQUAL( cache.getCount(), 5 );
+    BOOST_CHECK( !cache.get( 1 ));
+    BOOST_CHECK( !cache.get( 2 ));
+    BOOST_CHECK_EQUAL( cache.getStatistics().getHits(), 1 );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getMisses(), 9 );
+    BOOST_CHECK( cache.get( 4 ));
+}
+
+BOOST_AUTO_TEST_CASE( testCacheLoadManyKeepsHits )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 4 * test::OBJECT_SIZE + 1 );
+    livre::CacheIds evicted;
+    cache.registerNotifyEvicted(
+        [&]( const std::shared_ptr< const test::ValidCacheObject >& obj )
+            { evicted.push_back( obj->getId( )); });
+
+    for( livre::CacheId id = 1; id <= 4; ++id )
+        BOOST_CHECK( cache.load( id ));
+
+    // The loaded objects need more than the free memory, the requested objects
+    // found in the cache are only referenced by their futures but are kept
+    const livre::CacheIds cacheIds = { 1, 2, 3, 5, 6 };
+    const livre::Futures futures = cache.loadMany( cacheIds );
+    livre::Futures::const_iterator future = futures.begin();
+    for( const livre::CacheId& cacheId: cacheIds )
+    {
+        const auto obj = ( future++ )->get< test::ConstValidCacheObjectPtr >();
+        BOOST_REQUIRE( obj );
+        BOOST_CHECK_EQUAL( obj->getId(), cacheId );
+    }
+    BOOST_CHECK( evicted == livre::CacheIds( 1, 4 ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 5 );
+}
+
+BOOST_AUTO_TEST_CASE( testCacheKeepsRequested )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 2 * test::OBJECT_SIZE + 1 );
+
+    // The requested objects are kept while their futures are held, i.e. until
+    // a filter collects them, even if nothing else references them
+    livre::Futures futures = cache.loadMany( { 1, 2 });
+    BOOST_CHECK( !cache.unload( 1 ));
+    for( livre::CacheId id = 3; id < 6; ++id )
+        BOOST_CHECK( cache.load( id ));
+    BOOST_CHECK( cache.peek( 1 ));
+    BOOST_CHECK( cache.peek( 2 ));
+
+    // Once released, they are evicted again
+    futures.clear();
+    BOOST_CHECK( cache.unload( 1 ));
+    BOOST_CHECK( cache.load( 6 ));
+    BOOST_CHECK( cache.load( 7 ));
+    BOOST_CHECK( !cache.peek( 2 ));
+}
+
+BOOST_AUTO_TEST_CASE( testCacheLoadManyFailures )
+{
+    livre::Cache< OddFailingCacheObject > cache( "Test Cache", 2 * test::OBJECT_SIZE + 1 );
+    BOOST_CHECK( cache.load( 2 ));
+    BOOST_CHECK( cache.load( 4 ));
+
+    // The objects which cannot be loaded do not evict the loaded ones
+    const livre::Futures futures = cache.loadMany( { 1, 3, 5 });
+    for( const livre::Future& future: futures )
+        BOOST_CHECK( !future.get< std::shared_ptr< const OddFailingCacheObject >>( ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 2 );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getUsedMemory(), 2 * test::OBJECT_SIZE );
+}
+
+BOOST_AUTO_TEST_CASE( testCacheSnapshot )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 2 * test::OBJECT_SIZE + 1 );
+    BOOST_CHECK( cache.load( 1 ));
+    BOOST_CHECK( cache.load( 2 ));
+
+    typedef std::shared_ptr< const livre::CacheSnapshot< test::ValidCacheObject >> SnapshotPtr;
+    const SnapshotPtr snapshot = cache.getSnapshot();
+    BOOST_CHECK_EQUAL( snapshot->getCount(), 2 );
+    BOOST_CHECK_EQUAL( snapshot->get( 1 )->getId(), 1 );
+    BOOST_CHECK( snapshot->get( 2 ));
+    BOOST_CHECK( !snapshot->get( 3 ));
+    BOOST_CHECK( !snapshot->get( livre::INVALID_CACHE_ID ));
+
+    // The snapshot is shared until the cache changes
+    BOOST_CHECK_EQUAL( cache.getSnapshot(), snapshot );
+
+    // The snapshot does not keep the evicted objects, nor sees the new ones
+    BOOST_CHECK( cache.load( 3 ));
+    BOOST_CHECK( !snapshot->get( 1 ));
+    BOOST_CHECK( !snapshot->get( 3 ));
+
+    const SnapshotPtr current = cache.getSnapshot();
+    BOOST_CHECK_NE( current, snapshot );
+    BOOST_CHECK_GT( current->getVersion(), snapshot->getVersion( ));
+    BOOST_CHECK( !current->get( 1 ));
+    BOOST_CHECK( current->get( 3 ));
+
+    for( livre::CacheId id = 10; id < 1000; ++id )
+        BOOST_CHECK( cache.load( id ));
+    cache.setMaximumMemory( 1000 * test::OBJECT_SIZE );
+    for( livre::CacheId id = 10; id < 1000; ++id )
+        BOOST_CHECK( cache.load( id ));
+    BOOST_CHECK_EQUAL( cache.getSnapshot()->getCount(), cache.getCount( ));
+    BOOST_CHECK( cache.getSnapshot()->get( 999 ));
+
+    // The snapshot of the concurrent loads is built once they are done
+    boost::thread_group writers;
+    for( livre::CacheId first = 1000; first < 1400; first += 100 )
+        writers.create_thread( [&cache, first]
+        {
+            for( livre::CacheId id = first; id < first + 100; ++id )
+                cache.load( id );
+        });
+    writers.join_all();
+    BOOST_CHECK_EQUAL( cache.getSnapshot()->getCount(), cache.getCount( ));
+    BOOST_CHECK( cache.getSnapshot()->get( 1399 ));
+    BOOST_CHECK_EQUAL( cache.getSnapshot(), cache.getSnapshot( ));
+
+    cache.purge();
+    BOOST_CHECK_EQUAL( cache.getSnapshot()->getCount(), 0 );
+}
@@ -0,0 +1,99 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE CacheContention
+
+#include <boost/test/unit_test.hpp>
+
+#include "cache/ValidCacheObject.h"
+
+#include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheStatistics.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <random>
+
+namespace
+{
+const size_t nObjects = 64; // Cache capacity in objects
+const size_t nIds = 2 * nObjects; // Half of the requests miss
+const size_t nLoadsPerThread = 2000;
+const size_t nShards = 16;
+
+typedef livre::Cache< test::ValidCacheObject > TestCache;
+
+void loadObjects( TestCache& cache, const size_t seed )
+{
+    std::mt19937 generator( seed );
+    std::uniform_int_distribution< livre::CacheId > distribution( 0, nIds - 1 );
+    for( size_t i = 0; i < nLoadsPerThread; ++i )
+        BOOST_REQUIRE( cache.load( distribution( generator )));
+}
+
+void runLoads( TestCache& cache, const size_t nThreads )
+{
+    boost::thread_group threads;
+    for( size_t i = 0; i < nThreads; ++i )
+        threads.create_thread( boost::bind( &loadObjects, boost::ref( cache ), i ));
+    threads.join_all();
+}
+}
+
+BOOST_AUTO_TEST_CASE( testCacheContention )
+{
+    // Loads concurrently in a single locked and a sharded cache
+    for( const size_t nThreads: { size_t( 1 ), size_t( 4 )})
+    {
+        for( const size_t shards: { size_t( 1 ), nShards })
+        {
+            TestCache cache( "Contention Cache", nObjects * test::OBJECT_SIZE, shards );
+            runLoads( cache, nThreads );
+
+            // Memory accounting stays consistent under concurrent eviction.
+            // Each thread may hold one more object than the budget allows.
+            const livre::CacheStatistics& statistics = cache.getStatistics();
+            BOOST_CHECK_EQUAL( statistics.getUsedMemory(),
+                               cache.getCount() * test::OBJECT_SIZE );
+            BOOST_CHECK_EQUAL( statistics.getBlockCount(), cache.getCount( ));
+            BOOST_CHECK_LE( cache.getCount(), nObjects + nThreads );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( testShardedCache )
+{
+    TestCache cache( "Sharded Cache", 2 * test::OBJECT_SIZE + 1, nShards );
+
+    for( livre::CacheId id = 0; id < 100; ++id )
+        BOOST_CHECK( cache.load( id ));
+
+    // The memory budget is global, not per shard. The recency order is only
+    // kept per shard, so the last loaded object is the only one guaranteed
+    // to stay in the cache.
+    BOOST_CHECK_EQUAL( cache.getCount(), 2 );
+    BOOST_CHECK( cache.get( 99 ));
+
+    BOOST_CHECK( cache.unload( 99 ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 1 );
+
+    cache.purge();
+    BOOST_CHECK_EQUAL( cache.getCount(), 0 );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getUsedMemory(), 0 );
+}
@@ -0,0 +1,145 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE CacheTrace
+
+#include <boost/test/unit_test.hpp>
+
+#include "cache/ValidCacheObject.h"
+
+#include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheSimulator.h>
+#include <livre/core/cache/CacheTrace.h>
+
+#include <boost/filesystem.hpp>
+
+namespace
+{
+// Removes the trace file when the test ends
+struct TraceFile
+{
+    TraceFile()
+        : filename( ( boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path( "%%%%-%%%%.trace" )).string( ))
+    {}
+
+    ~TraceFile()
+    {
+        boost::filesystem::remove( filename );
+    }
+
+    const std::string filename;
+};
+
+livre::CacheAccess access( const uint32_t frame, const livre::CacheId cacheId,
+                           const size_t size, const bool hit )
+{
+    const livre::CacheAccess cacheAccess = { frame, cacheId, size, hit };
+    return cacheAccess;
+}
+}
+
+BOOST_AUTO_TEST_CASE( testCacheTrace )
+{
+    const TraceFile traceFile;
+    {
+        livre::CacheTrace trace( traceFile.filename );
+        trace.notifyAccess( 1, 100, false );
+        trace.setFrame( 2 );
+        BOOST_CHECK_EQUAL( trace.getFrame(), 2 );
+        trace.notifyAccess( 1, 100, true );
+        trace.notifyAccess( 2, 200, false );
+    }
+
+    const livre::CacheAccesses accesses = livre::CacheTrace::read( traceFile.filename );
+    BOOST_REQUIRE_EQUAL( accesses.size(), 3 );
+    BOOST_CHECK_EQUAL( accesses[ 0 ].frame, 0 );
+    BOOST_CHECK_EQUAL( accesses[ 0 ].cacheId, 1 );
+    BOOST_CHECK_EQUAL( accesses[ 0 ].size, 100 );
+    BOOST_CHECK( !accesses[ 0 ].hit );
+    BOOST_CHECK_EQUAL( accesses[ 1 ].frame, 2 );
+    BOOST_CHECK( accesses[ 1 ].hit );
+    BOOST_CHECK_EQUAL( accesses[ 2 ].cacheId, 2 );
+    BOOST_CHECK_EQUAL( accesses[ 2 ].size, 200 );
+
+    BOOST_CHECK_THROW( livre::CacheTrace::read( traceFile.filename + ".missing" ),
+                       std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( testCacheTraceRecording )
+{
+    const TraceFile traceFile;
+    {
+        livre::CacheTrace trace( traceFile.filename );
+        livre::Cache< test::ValidCacheObject > cache( "Test Cache", 10 * test::OBJECT_SIZE );
+        cache.setTrace( &trace );
+
+        trace.setFrame( 1 );
+        cache.load( 1 );
+        cache.load( 2 );
+        trace.setFrame( 2 );
+        cache.load( 1 );
+        cache.loadAsync( 3 ).get< test::ConstValidCacheObjectPtr >();
+        cache.loadMany( { 2, 4 });
+        cache.get( 1 ); // Lookups are not traced
+    }
+
+    const livre::CacheAccesses accesses = livre::CacheTrace::read( traceFile.filename );
+    BOOST_REQUIRE_EQUAL( accesses.size(), 6 );
+    const bool hits[] = { false, false, true, false, true, false };
+    const livre::CacheId cacheIds[] = { 1, 2, 1, 3, 2, 4 };
+    for( size_t i = 0; i < accesses.size(); ++i )
+    {
+        BOOST_CHECK_EQUAL( accesses[ i ].frame, i < 2 ? 1 : 2 );
+        BOOST_CHECK_EQUAL( accesses[ i ].cacheId, cacheIds[ i ]);
+        BOOST_CHECK_EQUAL( accesses[ i ].size, test::OBJECT_SIZE );
+        BOOST_CHECK_EQUAL( accesses[ i ].hit, hits[ i ]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( testSimulateCache )
+{
+    const livre::CacheAccesses accesses = { access( 0, 1, 100, false ),
+                                            access( 0, 2, 100, false ),
+                                            access( 1, 3, 100, false ),
+                                            access( 1, 1, 100, true )};
+
+    // Everything fits
+    livre::CacheSimulation simulation = livre::simulateCache( accesses, livre::CP_LRU, 1000 );
+    BOOST_CHECK_EQUAL( simulation.hits, 1 );
+    BOOST_CHECK_EQUAL( simulation.misses, 3 );
+    BOOST_CHECK_EQUAL( simulation.evictions, 0 );
+    BOOST_CHECK_EQUAL( simulation.loadedBytes, 300 );
+    BOOST_CHECK_CLOSE( simulation.getHitRatio(), 0.25f, 0.001f );
+
+    // The least recently used object 1 is evicted before it is used again
+    simulation = livre::simulateCache( accesses, livre::CP_LRU, 250 );
+    BOOST_CHECK_EQUAL( simulation.hits, 0 );
+    BOOST_CHECK_EQUAL( simulation.misses, 4 );
+    BOOST_CHECK_EQUAL( simulation.evictions, 2 );
+    BOOST_CHECK_EQUAL( simulation.loadedBytes, 400 );
+
+    // The visible object 1 of the next frame is evicted last
+    simulation = livre::simulateCache( accesses, livre::CP_VISIBLE, 250 );
+    BOOST_CHECK_EQUAL( simulation.hits, 1 );
+    BOOST_CHECK_EQUAL( simulation.misses, 3 );
+
+    BOOST_CHECK_EQUAL( livre::simulateCache( livre::CacheAccesses(), livre::CP_2Q,
+                                             1000 ).getHitRatio(), 0.f );
+}
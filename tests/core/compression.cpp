@@ -0,0 +1,86 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE Compression
+
+#include <livre/core/util/Compression.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+namespace
+{
+void checkRoundTrip( const std::vector< uint8_t >& data )
+{
+    const std::vector< uint8_t > compressed = livre::compressLZ4( data.data(), data.size( ));
+    BOOST_CHECK_LE( compressed.size(), data.size() + data.size() / 255 + 16 );
+
+    std::vector< uint8_t > decompressed( data.size( ));
+    BOOST_CHECK( livre::decompressLZ4( compressed.data(), compressed.size(),
+                                       decompressed.data(), decompressed.size( )));
+    BOOST_CHECK( decompressed == data );
+}
+}
+
+BOOST_AUTO_TEST_CASE( testRoundTrip )
+{
+    std::mt19937 random( 42 );
+    for( const size_t size: { 0, 1, 12, 13, 100, 65536, 300000 })
+    {
+        std::vector< uint8_t > data( size );
+        for( uint8_t& value: data )
+            value = uint8_t( random( ));
+        checkRoundTrip( data ); // Incompressible
+
+        for( size_t i = 0; i < size; ++i )
+            data[ i ] = uint8_t(( i / 64 ) % 7 );
+        checkRoundTrip( data ); // Runs and repetitions
+    }
+}
+
+BOOST_AUTO_TEST_CASE( testCompressionRatio )
+{
+    // Volume bricks are mostly smooth or empty
+    std::vector< uint8_t > data( 32 * 32 * 32 );
+    for( size_t i = 0; i < data.size(); ++i )
+        data[ i ] = i < data.size() / 2 ? 0 : uint8_t( i / 1024 );
+
+    const std::vector< uint8_t > compressed = livre::compressLZ4( data.data(), data.size( ));
+    BOOST_CHECK_LT( compressed.size(), data.size() / 20 );
+}
+
+BOOST_AUTO_TEST_CASE( testCorruptData )
+{
+    std::vector< uint8_t > data( 4096 );
+    for( size_t i = 0; i < data.size(); ++i )
+        data[ i ] = uint8_t( i % 13 );
+    const std::vector< uint8_t > compressed = livre::compressLZ4( data.data(), data.size( ));
+
+    std::vector< uint8_t > decompressed( data.size( ));
+    BOOST_CHECK( !livre::decompressLZ4( compressed.data(), compressed.size() - 1,
+                                        decompressed.data(), decompressed.size( )));
+    BOOST_CHECK( !livre::decompressLZ4( compressed.data(), compressed.size(),
+                                        decompressed.data(), decompressed.size() - 1 ));
+
+    // An offset before the start of the output
+    const uint8_t invalidOffset[] = { 0x10, 'a', 0xff, 0x00 };
+    BOOST_CHECK( !livre::decompressLZ4( invalidOffset, sizeof( invalidOffset ),
+                                        decompressed.data(), decompressed.size( )));
+}
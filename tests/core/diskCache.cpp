@@ -0,0 +1,207 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE DiskCache
+
+#include <boost/test/unit_test.hpp>
+
+#include <livre/core/cache/DiskCache.h>
+#include <livre/core/data/MemoryUnit.h>
+#include <livre/core/data/VolumeInformation.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+namespace
+{
+const size_t BLOCK_SIZE = 1024;
+const size_t FILE_SIZE = BLOCK_SIZE + 32; // With the header
+const std::string DATASET_ID = "dataset";
+
+struct TestDir
+{
+    TestDir()
+        : path( boost::filesystem::temp_directory_path() /
+                boost::filesystem::unique_path( ))
+    {}
+
+    ~TestDir()
+    {
+        boost::filesystem::remove_all( path );
+    }
+
+    const boost::filesystem::path path;
+};
+
+livre::AllocMemoryUnitPtr createBlock( const uint8_t value )
+{
+    return livre::AllocMemoryUnitPtr(
+        new livre::AllocMemoryUnit( std::vector< uint8_t >( BLOCK_SIZE, value )));
+}
+
+bool hasBlock( livre::DiskCache& cache, const livre::CacheId cacheId )
+{
+    const livre::ConstMemoryUnitPtr data = cache.load( cacheId );
+    if( !data || data->getMemSize() != BLOCK_SIZE )
+        return false;
+
+    const uint8_t* ptr = data->getData< uint8_t >();
+    return std::all_of( ptr, ptr + BLOCK_SIZE,
+                        [cacheId]( const uint8_t value ) { return value == cacheId; });
+}
+}
+
+BOOST_AUTO_TEST_CASE( testDiskCache )
+{
+    const TestDir dir;
+    livre::DiskCache cache( dir.path.string(), DATASET_ID, 3 * FILE_SIZE );
+
+    BOOST_CHECK( !cache.load( 1 ));
+    BOOST_CHECK( cache.store( 1, *createBlock( 1 )));
+    BOOST_CHECK( cache.store( 2, *createBlock( 2 )));
+    BOOST_CHECK( cache.store( 2, *createBlock( 2 ))); // Already stored
+    BOOST_CHECK_EQUAL( cache.getCount(), 2 );
+    BOOST_CHECK( hasBlock( cache, 1 ));
+    BOOST_CHECK( hasBlock( cache, 2 ));
+
+    // The least recently used block is removed
+    const livre::ConstMemoryUnitPtr mapped = cache.load( 1 );
+    BOOST_CHECK( cache.store( 3, *createBlock( 3 )));
+    BOOST_CHECK( cache.store( 4, *createBlock( 4 )));
+    BOOST_CHECK_EQUAL( cache.getCount(), 3 );
+    BOOST_CHECK( !cache.load( 2 ));
+    BOOST_CHECK_EQUAL( cache.getStatistics().getUsedMemory(), 3 * FILE_SIZE );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getEvictions(), 1 );
+
+    // Blocks larger than the cache are not stored
+    const livre::AllocMemoryUnit large( std::vector< uint8_t >( 4 * BLOCK_SIZE ));
+    BOOST_CHECK( !cache.store( 5, large ));
+    BOOST_CHECK_EQUAL( mapped->getData< uint8_t >()[ 0 ], 1 );
+}
+
+BOOST_AUTO_TEST_CASE( testDiskCacheRestart )
+{
+    const TestDir dir;
+    {
+        livre::DiskCache cache( dir.path.string(), DATASET_ID, 3 * FILE_SIZE );
+        for( livre::CacheId cacheId = 1; cacheId <= 3; ++cacheId )
+            BOOST_CHECK( cache.store( cacheId, *createBlock( uint8_t( cacheId ))));
+        BOOST_CHECK( hasBlock( cache, 1 ));
+    }
+
+    // The restarted cache has the blocks, in the same least recently used order
+    livre::DiskCache cache( dir.path.string(), DATASET_ID, 3 * FILE_SIZE );
+    BOOST_CHECK_EQUAL( cache.getCount(), 3 );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getUsedMemory(), 3 * FILE_SIZE );
+    BOOST_CHECK( cache.store( 4, *createBlock( 4 )));
+    BOOST_CHECK( !cache.load( 2 ));
+    BOOST_CHECK( hasBlock( cache, 1 ));
+    BOOST_CHECK( hasBlock( cache, 3 ));
+    BOOST_CHECK( hasBlock( cache, 4 ));
+
+    // Other data sets are in other directories
+    livre::DiskCache other( dir.path.string(), "other", 3 * FILE_SIZE );
+    BOOST_CHECK_EQUAL( other.getCount(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( testDiskCacheRebuildIndex )
+{
+    const TestDir dir;
+    std::string directory;
+    {
+        livre::DiskCache cache( dir.path.string(), DATASET_ID, 3 * FILE_SIZE );
+        directory = cache.getDirectory();
+        for( livre::CacheId cacheId = 1; cacheId <= 2; ++cacheId )
+            BOOST_CHECK( cache.store( cacheId, *createBlock( uint8_t( cacheId ))));
+    }
+
+    // A crash leaves no index and partially written blocks
+    boost::filesystem::remove( boost::filesystem::path( directory ) / "index" );
+    std::ofstream( directory + "/0000000000000003.brick.tmp" ) << "partial";
+
+    livre::DiskCache cache( dir.path.string(), DATASET_ID, 3 * FILE_SIZE );
+    BOOST_CHECK_EQUAL( cache.getCount(), 2 );
+    BOOST_CHECK( hasBlock( cache, 1 ));
+    BOOST_CHECK( hasBlock( cache, 2 ));
+    BOOST_CHECK( !boost::filesystem::exists( directory + "/0000000000000003.brick.tmp" ));
+}
+
+BOOST_AUTO_TEST_CASE( testDiskCacheCorruptedBlocks )
+{
+    const TestDir dir;
+    {
+        livre::DiskCache cache( dir.path.string(), DATASET_ID, 3 * FILE_SIZE );
+        for( livre::CacheId cacheId = 1; cacheId <= 3; ++cacheId )
+            BOOST_CHECK( cache.store( cacheId, *createBlock( uint8_t( cacheId ))));
+    }
+
+    // A block of a previous process changed in place does not match its
+    // checksum
+    livre::DiskCache cache( dir.path.string(), DATASET_ID, 3 * FILE_SIZE );
+    const std::string block1 = cache.getDirectory() + "/0000000000000001.brick";
+    {
+        std::fstream file( block1.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+        file.seekp( FILE_SIZE - 1 );
+        file.put( 0 );
+    }
+    BOOST_CHECK( !cache.load( 1 ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 2 );
+    BOOST_CHECK( !boost::filesystem::exists( block1 ));
+
+    // The blocks are checksummed on their first load only, then only their
+    // header and length are checked
+    const std::string block3 = cache.getDirectory() + "/0000000000000003.brick";
+    BOOST_CHECK( cache.load( 3 ));
+    {
+        std::fstream file( block3.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+        file.seekp( FILE_SIZE - 1 );
+        file.put( 0 );
+    }
+    BOOST_CHECK( cache.load( 3 ));
+
+    // A truncated block does not match its length
+    boost::filesystem::resize_file( cache.getDirectory() + "/0000000000000002.brick",
+                                    BLOCK_SIZE );
+    BOOST_CHECK( !cache.load( 2 ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( testDatasetId )
+{
+    livre::VolumeInformation info;
+    const std::string id = livre::DiskCache::getDatasetId( "raw:///data/volume.raw", info );
+    BOOST_CHECK_EQUAL( id, livre::DiskCache::getDatasetId( "raw:///data/volume.raw", info ));
+    BOOST_CHECK_NE( id, livre::DiskCache::getDatasetId( "raw:///data/other.raw", info ));
+
+    info.compCount = 3;
+    BOOST_CHECK_NE( id, livre::DiskCache::getDatasetId( "raw:///data/volume.raw", info ));
+
+    // The data set changes with its file
+    const TestDir dir;
+    boost::filesystem::create_directory( dir.path );
+    const std::string filename = ( dir.path / "volume.raw" ).string();
+    std::ofstream( filename.c_str( )) << "volume";
+    const std::string uri = "raw://" + filename;
+    const std::string fileId = livre::DiskCache::getDatasetId( uri, info );
+    BOOST_CHECK_EQUAL( fileId, livre::DiskCache::getDatasetId( uri, info ));
+
+    std::ofstream( filename.c_str( )) << "larger volume";
+    BOOST_CHECK_NE( fileId, livre::DiskCache::getDatasetId( uri, info ));
+}
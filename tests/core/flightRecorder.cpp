@@ -0,0 +1,129 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE FlightRecorder
+
+#include <livre/core/render/FlightRecorder.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+// Removes the dumps when the test ends
+struct DumpDirectory
+{
+    DumpDirectory()
+        : path( boost::filesystem::temp_directory_path() /
+                boost::filesystem::unique_path( "%%%%-%%%%" ))
+    {
+        boost::filesystem::create_directory( path );
+    }
+
+    ~DumpDirectory()
+    {
+        boost::filesystem::remove_all( path );
+    }
+
+    const boost::filesystem::path path;
+};
+
+livre::RenderStatistics getStatistics( const size_t nAvailable, const size_t loadedBytes )
+{
+    livre::RenderStatistics statistics;
+    statistics.nAvailable = nAvailable;
+    statistics.cacheStatistics.resize( 1 );
+    statistics.cacheStatistics[ 0 ].name = "TextureCache";
+    statistics.cacheStatistics[ 0 ].loadedBytes = loadedBytes;
+    return statistics;
+}
+
+// @return the name of the dump of the frame, empty if it was not dumped
+std::string renderFrame( livre::FlightRecorder& recorder, const uint32_t frame,
+                         const uint32_t latency )
+{
+    // Synthetic times, one frame per 100 ms
+    static const uint64_t startTime = livre::PipelineTrace::getTime();
+    const uint64_t frameStart = startTime + frame * 100000;
+    const uint64_t frameEnd = frameStart + latency * 1000;
+    recorder.startFrame( frame, frameStart );
+    livre::PipelineTrace::notifyExecution( "RenderFilter", frame, 0, frameStart, frameEnd );
+    return recorder.finishFrame( getStatistics( frame, 1000 * frame ), frameEnd );
+}
+}
+
+BOOST_AUTO_TEST_CASE( testFlightRecorder )
+{
+    const DumpDirectory directory;
+    const std::string prefix = ( directory.path / "slow-frame-" ).string();
+
+    BOOST_CHECK_THROW( livre::FlightRecorder( prefix, 0, 20 ), std::runtime_error );
+    {
+        livre::FlightRecorder recorder( prefix, 3, 20 );
+        // The executions are recorded without a trace
+        BOOST_CHECK( livre::PipelineTrace::isEnabled( ));
+
+        BOOST_CHECK( renderFrame( recorder, 1, 0 ).empty( ));
+        BOOST_CHECK( renderFrame( recorder, 2, 0 ).empty( ));
+        BOOST_CHECK( renderFrame( recorder, 3, 0 ).empty( ));
+        BOOST_CHECK( renderFrame( recorder, 4, 19 ).empty( )); // Below the threshold
+
+        // The latest frames are kept
+        const livre::FrameRecords frames = recorder.getFrames();
+        BOOST_REQUIRE_EQUAL( frames.size(), 3 );
+        for( size_t i = 0; i < frames.size(); ++i )
+        {
+            BOOST_CHECK_EQUAL( frames[ i ].frame, i + 2 );
+            BOOST_CHECK_EQUAL( frames[ i ].statistics.nAvailable, i + 2 );
+            BOOST_CHECK_LE( frames[ i ].startTime, frames[ i ].endTime );
+        }
+        BOOST_CHECK_EQUAL( frames[ 2 ].endTime - frames[ 2 ].startTime, 19000 );
+
+        // A slow frame dumps the latest frames, the next slow frames only once
+        // they are all replaced
+        const std::string filename = renderFrame( recorder, 5, 20 );
+        BOOST_CHECK_EQUAL( filename, prefix + "5.json" );
+        BOOST_CHECK( renderFrame( recorder, 6, 25 ).empty( ));
+        BOOST_CHECK( renderFrame( recorder, 7, 0 ).empty( ));
+        BOOST_CHECK_EQUAL( renderFrame( recorder, 8, 25 ), prefix + "8.json" );
+
+        // The dumps are written in the background
+        recorder.wait();
+        std::ifstream file( filename.c_str( ));
+        std::stringstream json;
+        json << file.rdbuf();
+        BOOST_CHECK_EQUAL( json.str().find( "{\"traceEvents\":[" ), 0 );
+        BOOST_CHECK( json.str().find( "\"name\":\"frame\"" ) != std::string::npos );
+        BOOST_CHECK( json.str().find( "\"name\":\"RenderFilter\"" ) != std::string::npos );
+        BOOST_CHECK( json.str().find( "{\"frame\":3,\"ts\"" ) != std::string::npos );
+        BOOST_CHECK( json.str().find( "{\"frame\":5,\"ts\"" ) != std::string::npos );
+        BOOST_CHECK( json.str().find( "{\"frame\":2,\"ts\"" ) == std::string::npos );
+        BOOST_CHECK( json.str().find( "\"loadedBytes\":5000" ) != std::string::npos );
+    }
+    BOOST_CHECK( !livre::PipelineTrace::isEnabled( ));
+
+    // A dump which cannot be written does not fail the frame
+    livre::FlightRecorder recorder( "/nonexistent/slow-frame-", 1, 20 );
+    BOOST_CHECK_EQUAL( renderFrame( recorder, 1, 25 ), "/nonexistent/slow-frame-1.json" );
+    recorder.wait();
+    BOOST_CHECK( !boost::filesystem::exists( "/nonexistent/slow-frame-1.json" ));
+}
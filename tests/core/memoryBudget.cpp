@@ -0,0 +1,244 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE MemoryBudget
+
+#include <boost/test/unit_test.hpp>
+
+#include "cache/ValidCacheObject.h"
+
+#include <livre/core/cache/Cache.h>
+#include <livre/core/cache/MemoryBudget.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+namespace
+{
+const size_t MB = 1024 * 1024;
+
+struct TestDir
+{
+    TestDir()
+        : path( boost::filesystem::temp_directory_path() /
+                boost::filesystem::unique_path( ))
+    {
+        boost::filesystem::create_directories( path );
+        write( "meminfo", "MemTotal:       16777216 kB\n"
+                          "MemFree:         1048576 kB\n"
+                          "MemAvailable:    8388608 kB\n" );
+    }
+
+    ~TestDir()
+    {
+        boost::filesystem::remove_all( path );
+    }
+
+    void write( const std::string& file, const std::string& content ) const
+    {
+        std::ofstream stream(( path / file ).string( ));
+        stream << content;
+    }
+
+    std::string get( const std::string& file = std::string( )) const
+    {
+        return ( path / file ).string();
+    }
+
+    const boost::filesystem::path path;
+};
+}
+
+BOOST_AUTO_TEST_CASE( testReadMemoryInfo )
+{
+    const TestDir dir;
+
+    // Without cgroup limit the system memory is used
+    dir.write( "memory.max", "max\n" );
+    dir.write( "memory.current", "1073741824\n" );
+    livre::MemoryInfo info = livre::readMemoryInfo( dir.get(), dir.get( "meminfo" ));
+    BOOST_CHECK_EQUAL( info.limit, 16384 * MB );
+    BOOST_CHECK_EQUAL( info.used, 8192 * MB );
+    BOOST_CHECK_EQUAL( info.available, 8192 * MB );
+
+    // The cgroup limit applies, the inactive page cache is not used memory
+    dir.write( "memory.max", "4294967296\n" );
+    dir.write( "memory.stat", "anon 1073741824\ninactive_file 536870912\n" );
+    info = livre::readMemoryInfo( dir.get(), dir.get( "meminfo" ));
+    BOOST_CHECK_EQUAL( info.limit, 4096 * MB );
+    BOOST_CHECK_EQUAL( info.used, 512 * MB );
+    BOOST_CHECK_EQUAL( info.available, 3584 * MB );
+
+    // The system memory is also a limit inside the cgroup
+    dir.write( "memory.max", "68719476736\n" );
+    info = livre::readMemoryInfo( dir.get(), dir.get( "meminfo" ));
+    BOOST_CHECK_EQUAL( info.available, 8192 * MB );
+}
+
+BOOST_AUTO_TEST_CASE( testComputeBudget )
+{
+    const livre::MemoryBudget budget( 256 * MB, 2048 * MB, 0.25f );
+
+    livre::MemoryInfo info;
+    info.limit = 4096 * MB;
+    info.available = 1024 * MB;
+
+    // Used cache memory + available memory - reserve
+    BOOST_CHECK_EQUAL( budget.computeBudget( info, 1024 * MB ),
+                       1024 * MB + 1024 * MB - 1024 * MB );
+
+    // Shrinks to the minimum when another tenant uses the memory
+    info.available = 0;
+    BOOST_CHECK_EQUAL( budget.computeBudget( info, 128 * MB ), 256 * MB );
+
+    // Grows up to the maximum
+    info.available = 3072 * MB;
+    BOOST_CHECK_EQUAL( budget.computeBudget( info, 1024 * MB ), 2048 * MB );
+}
+
+BOOST_AUTO_TEST_CASE( testCacheWatermarks )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 10 * test::OBJECT_SIZE );
+    BOOST_CHECK_THROW( cache.setWatermarks( 0.5f, 0.8f ), std::runtime_error );
+    cache.setWatermarks( 0.8f, 0.5f );
+
+    for( livre::CacheId id = 0; id < 8; ++id )
+        BOOST_CHECK( cache.load( id ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 8 );
+
+    // The background eviction starts at the high watermark
+    cache.evict();
+    BOOST_CHECK_EQUAL( cache.getCount(), 4 );
+    cache.evict();
+    BOOST_CHECK_EQUAL( cache.getCount(), 4 );
+
+    // Shrinking the budget evicts down to the low watermark of the new budget
+    cache.setMaximumMemory( 4 * test::OBJECT_SIZE );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getMaximumMemory(), 4 * test::OBJECT_SIZE );
+    cache.evict();
+    BOOST_CHECK_EQUAL( cache.getCount(), 1 );
+
+    // The loads only evict at the maximum memory, down to the low watermark
+    for( livre::CacheId id = 10; id < 13; ++id )
+        BOOST_CHECK( cache.load( id ));
+    BOOST_CHECK_EQUAL( cache.getCount(), 1 );
+    BOOST_CHECK( cache.get( 12 ));
+}
+
+BOOST_AUTO_TEST_CASE( testMemoryBudgetUpdate )
+{
+    livre::Cache< test::ValidCacheObject > cache( "Test Cache", 10 * test::OBJECT_SIZE );
+    for( livre::CacheId id = 0; id < 8; ++id )
+        BOOST_CHECK( cache.load( id ));
+
+    // A fixed budget, independent of the memory of the test machine
+    livre::MemoryBudget budget( 4 * test::OBJECT_SIZE, 4 * test::OBJECT_SIZE );
+    budget.addCache( cache );
+    budget.update();
+
+    BOOST_CHECK_EQUAL( budget.getBudget(), 4 * test::OBJECT_SIZE );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getMaximumMemory(), 4 * test::OBJECT_SIZE );
+    BOOST_CHECK_LT( cache.getCount(), 4 );
+
+    // The caches are only updated when they or their misses changed
+    cache.setMaximumMemory( 10 * test::OBJECT_SIZE );
+    budget.update();
+    BOOST_CHECK_EQUAL( cache.getStatistics().getMaximumMemory(), 10 * test::OBJECT_SIZE );
+
+    BOOST_CHECK( cache.load( 8 ));
+    budget.update();
+    BOOST_CHECK_EQUAL( cache.getStatistics().getMaximumMemory(), 4 * test::OBJECT_SIZE );
+}
+
+BOOST_AUTO_TEST_CASE( testComputeShares )
+{
+    const livre::MemoryBudget budget( 0, 1000 * MB, 0.1f, 100, 0.5f );
+
+    // Without misses the whole budget is shared by weight
+    std::vector< size_t > shares =
+        budget.computeShares( 1000 * MB, {{ 300 * MB, 0.0 }, { 100 * MB, 0.0 }});
+    BOOST_CHECK_EQUAL( shares[ 0 ], 750 * MB );
+    BOOST_CHECK_EQUAL( shares[ 1 ], 250 * MB );
+
+    // The lent half of the budget follows the miss cost
+    shares = budget.computeShares( 1000 * MB, {{ 300 * MB, 0.0 }, { 100 * MB, 1000.0 }});
+    BOOST_CHECK_EQUAL( shares[ 0 ], 375 * MB );
+    BOOST_CHECK_EQUAL( shares[ 1 ], 625 * MB );
+
+    shares = budget.computeShares( 1000 * MB, {{ 300 * MB, 3000.0 }, { 100 * MB, 1000.0 }});
+    BOOST_CHECK_EQUAL( shares[ 0 ], 750 * MB );
+    BOOST_CHECK_EQUAL( shares[ 1 ], 250 * MB );
+}
+
+BOOST_AUTO_TEST_CASE( testComputeSharesQuotas )
+{
+    const livre::MemoryBudget budget( 0, 1000 * MB, 0.1f, 100, 0.5f );
+
+    // The memory above the maximum quota goes to the other caches
+    std::vector< size_t > shares = budget.computeShares(
+        1000 * MB, {{ 100 * MB, 0.0 }, { 100 * MB, 1000.0, 0, 500 * MB },
+                    { 300 * MB, 0.0 }});
+    BOOST_CHECK_EQUAL( shares[ 0 ], 125 * MB );
+    BOOST_CHECK_EQUAL( shares[ 1 ], 500 * MB );
+    BOOST_CHECK_EQUAL( shares[ 2 ], 375 * MB );
+
+    // The minimum quota is kept while the misses are on another cache
+    shares = budget.computeShares(
+        1000 * MB, {{ 100 * MB, 1000.0 }, { 100 * MB, 0.0, 400 * MB }});
+    BOOST_CHECK_EQUAL( shares[ 0 ], 600 * MB );
+    BOOST_CHECK_EQUAL( shares[ 1 ], 400 * MB );
+
+    // Without quotas the memory follows the misses
+    shares = budget.computeShares( 1000 * MB, {{ 100 * MB, 1000.0 }, { 100 * MB, 0.0 }});
+    BOOST_CHECK_EQUAL( shares[ 0 ], 750 * MB );
+    BOOST_CHECK_EQUAL( shares[ 1 ], 250 * MB );
+}
+
+BOOST_AUTO_TEST_CASE( testMemoryBudgetRemoveCache )
+{
+    livre::Cache< test::ValidCacheObject > first( "First Cache", 10 * test::OBJECT_SIZE );
+    livre::MemoryBudget budget( 8 * test::OBJECT_SIZE, 8 * test::OBJECT_SIZE );
+    {
+        livre::Cache< test::ValidCacheObject > second( "Second Cache", 10 * test::OBJECT_SIZE );
+        budget.addCache( first );
+        budget.addCache( second );
+        budget.update();
+        BOOST_CHECK_EQUAL( first.getStatistics().getMaximumMemory(), 4 * test::OBJECT_SIZE );
+        BOOST_CHECK_EQUAL( second.getStatistics().getMaximumMemory(), 4 * test::OBJECT_SIZE );
+        budget.removeCache( second );
+    }
+
+    budget.update();
+    BOOST_CHECK_EQUAL( first.getStatistics().getMaximumMemory(), 8 * test::OBJECT_SIZE );
+}
+
+BOOST_AUTO_TEST_CASE( testMemoryBudgetQuotas )
+{
+    livre::Cache< test::ValidCacheObject > first( "First Cache", 10 * test::OBJECT_SIZE );
+    livre::Cache< test::ValidCacheObject > second( "Second Cache", 10 * test::OBJECT_SIZE );
+    livre::MemoryBudget budget( 8 * test::OBJECT_SIZE, 8 * test::OBJECT_SIZE );
+    budget.addCache( first, 0, 2 * test::OBJECT_SIZE );
+    budget.addCache( second );
+    budget.update();
+    BOOST_CHECK_EQUAL( first.getStatistics().getMaximumMemory(), 2 * test::OBJECT_SIZE );
+    BOOST_CHECK_EQUAL( second.getStatistics().getMaximumMemory(), 6 * test::OBJECT_SIZE );
+    budget.removeCache( first );
+    budget.removeCache( second );
+}
@@ -0,0 +1,91 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE MemoryUnit
+
+#include <boost/test/unit_test.hpp>
+
+#include <livre/core/data/MemoryUnit.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+const size_t PAGE_SIZE = ::sysconf( _SC_PAGESIZE );
+const size_t N_PAGES = 8;
+
+// The pages of an anonymous mapping are only resident once they are used
+struct Mapping
+{
+    Mapping()
+        : ptr( static_cast< uint8_t* >( ::mmap( 0, N_PAGES * PAGE_SIZE,
+                                                PROT_READ | PROT_WRITE,
+                                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 )))
+    {}
+
+    ~Mapping()
+    {
+        ::munmap( ptr, N_PAGES * PAGE_SIZE );
+    }
+
+    uint8_t* const ptr;
+};
+}
+
+BOOST_AUTO_TEST_CASE( testAllocSize )
+{
+    const livre::AllocMemoryUnit alloc( 1024 );
+    BOOST_CHECK_EQUAL( static_cast< const livre::MemoryUnit& >( alloc ).getAllocSize(),
+                       1024 );
+
+    const std::vector< uint8_t > data( 1024 );
+    const livre::ConstMemoryUnit constUnit( data.data(), data.size( ));
+    BOOST_CHECK_EQUAL( static_cast< const livre::MemoryUnit& >( constUnit ).getAllocSize(),
+                       0 );
+}
+
+BOOST_AUTO_TEST_CASE( testMappedAllocSize )
+{
+    const Mapping mapping;
+    BOOST_REQUIRE( mapping.ptr != MAP_FAILED );
+
+    const livre::MappedMemoryUnit unit( mapping.ptr, N_PAGES * PAGE_SIZE );
+    const livre::MemoryUnit& memoryUnit = unit;
+    BOOST_CHECK_EQUAL( memoryUnit.getMemSize(), N_PAGES * PAGE_SIZE );
+    BOOST_CHECK_EQUAL( memoryUnit.getAllocSize(), 0 );
+
+    mapping.ptr[ 0 ] = 1;
+    mapping.ptr[ 2 * PAGE_SIZE ] = 1;
+    BOOST_CHECK_EQUAL( memoryUnit.getAllocSize(), 2 * PAGE_SIZE );
+
+    unit.prefetch();
+    BOOST_CHECK_EQUAL( memoryUnit.getAllocSize(), N_PAGES * PAGE_SIZE );
+}
+
+BOOST_AUTO_TEST_CASE( testMappedAllocSizeUnaligned )
+{
+    const Mapping mapping;
+    BOOST_REQUIRE( mapping.ptr != MAP_FAILED );
+
+    // The resident size is not larger than the data
+    const livre::MappedMemoryUnit unit( mapping.ptr + 16, 64 );
+    unit.prefetch();
+    BOOST_CHECK_EQUAL( static_cast< const livre::MemoryUnit& >( unit ).getAllocSize(), 64 );
+}
@@ -0,0 +1,136 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE SharedMemoryCache
+
+#include <boost/test/unit_test.hpp>
+
+#include <livre/core/cache/SharedMemoryCache.h>
+#include <livre/core/data/MemoryUnit.h>
+
+#include <unistd.h>
+
+namespace
+{
+const size_t BLOCK_SIZE = 1024;
+
+// One segment per test process, removed when the test ends
+struct TestSegment
+{
+    TestSegment()
+        : datasetId( "test-" + std::to_string( ::getpid( )))
+    {
+        livre::SharedMemoryCache::remove( datasetId );
+    }
+
+    ~TestSegment()
+    {
+        livre::SharedMemoryCache::remove( datasetId );
+    }
+
+    const std::string datasetId;
+};
+
+livre::AllocMemoryUnitPtr createBlock( const uint8_t value )
+{
+    return livre::AllocMemoryUnitPtr(
+        new livre::AllocMemoryUnit( std::vector< uint8_t >( BLOCK_SIZE, value )));
+}
+
+bool hasBlock( livre::SharedMemoryCache& cache, const livre::CacheId cacheId )
+{
+    const livre::ConstMemoryUnitPtr data = cache.load( cacheId );
+    if( !data || data->getMemSize() != BLOCK_SIZE )
+        return false;
+
+    const uint8_t* ptr = data->getData< uint8_t >();
+    return std::all_of( ptr, ptr + BLOCK_SIZE,
+                        [cacheId]( const uint8_t value ) { return value == cacheId; });
+}
+}
+
+BOOST_AUTO_TEST_CASE( testSharedMemoryCache )
+{
+    const TestSegment segment;
+    livre::SharedMemoryCache cache( segment.datasetId, BLOCK_SIZE, 4 * BLOCK_SIZE );
+
+    BOOST_CHECK( !cache.load( 1 ));
+    BOOST_CHECK( cache.store( 1, *createBlock( 1 )));
+    BOOST_CHECK( cache.store( 2, *createBlock( 2 )));
+    BOOST_CHECK( cache.store( 2, *createBlock( 2 ))); // Already stored
+    BOOST_CHECK_EQUAL( cache.getCount(), 2 );
+    BOOST_CHECK( hasBlock( cache, 1 ));
+    BOOST_CHECK( hasBlock( cache, 2 ));
+    BOOST_CHECK_EQUAL( cache.getStatistics().getHits(), 2 );
+
+    // The loaded blocks account for their slot
+    BOOST_CHECK_EQUAL( cache.load( 1 )->getAllocSize(), BLOCK_SIZE );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getMisses(), 1 );
+
+    // Blocks larger than a slot are not stored
+    const livre::AllocMemoryUnit large( std::vector< uint8_t >( 2 * BLOCK_SIZE ));
+    BOOST_CHECK( !cache.store( 3, large ));
+}
+
+BOOST_AUTO_TEST_CASE( testSharedMemoryCacheEviction )
+{
+    const TestSegment segment;
+    livre::SharedMemoryCache cache( segment.datasetId, BLOCK_SIZE, 4 * BLOCK_SIZE );
+
+    // The referenced blocks are not evicted
+    std::vector< livre::ConstMemoryUnitPtr > referenced;
+    for( livre::CacheId cacheId = 1; cacheId <= 4; ++cacheId )
+    {
+        BOOST_CHECK( cache.store( cacheId, *createBlock( uint8_t( cacheId ))));
+        referenced.push_back( cache.load( cacheId ));
+    }
+    BOOST_CHECK( !cache.store( 5, *createBlock( 5 )));
+
+    // The least recently used unreferenced block is evicted
+    referenced.clear();
+    BOOST_CHECK( hasBlock( cache, 1 ));
+    BOOST_CHECK( cache.store( 5, *createBlock( 5 )));
+    BOOST_CHECK_EQUAL( cache.getCount(), 4 );
+    BOOST_CHECK_EQUAL( cache.getStatistics().getEvictions(), 1 );
+    BOOST_CHECK( hasBlock( cache, 1 ));
+    BOOST_CHECK( !cache.load( 2 ));
+    BOOST_CHECK( hasBlock( cache, 5 ));
+}
+
+BOOST_AUTO_TEST_CASE( testSharedMemoryCacheSharing )
+{
+    const TestSegment segment;
+    livre::ConstMemoryUnitPtr data;
+    {
+        livre::SharedMemoryCache cache( segment.datasetId, BLOCK_SIZE, 4 * BLOCK_SIZE );
+        BOOST_CHECK( cache.store( 1, *createBlock( 1 )));
+        data = cache.load( 1 );
+    }
+
+    // The segment is kept, and the loaded blocks stay valid
+    BOOST_CHECK_EQUAL( data->getData< uint8_t >()[ 0 ], 1 );
+    livre::SharedMemoryCache other( segment.datasetId, BLOCK_SIZE, 4 * BLOCK_SIZE );
+    BOOST_CHECK_EQUAL( other.getCount(), 1 );
+    BOOST_CHECK( hasBlock( other, 1 ));
+
+    // The segment of another layout is not reused
+    BOOST_CHECK_THROW( livre::SharedMemoryCache( segment.datasetId, 2 * BLOCK_SIZE,
+                                                 4 * BLOCK_SIZE ),
+                       std::runtime_error );
+}
@@ -19,6 +19,7 @@
  */
 
 #include <livre/core/cache/Cache.h>
+#include <livre/lib/cache/CompressedDataObject.h>
 #include <livre/lib/cache/DataObject.h>
 #include <livre/lib/cache/HistogramObject.h>
 
@@ -128,3 +129,52 @@ BOOST_AUTO_TEST_CASE( testCache )
     BOOST_CHECK_EQUAL( binAcc[ size_t( hist.getMaxIndex( )) ], 1u << 25 );
     BOOST_CHECK_EQUAL( hist.getSum(), 1u << 25 );
 }
+
+BOOST_AUTO_TEST_CASE( testCompressedDataCache )
+{
+    std::stringstream volumeName;
+    volumeName << "mem://#" << VOXEL_SIZE_X << "," << VOXEL_SIZE_Y << ","
+               << VOXEL_SIZE_Z << "," << BLOCK_SIZE;
+
+    const servus::URI uri( volumeName.str( ));
+    livre::DataSource source( uri );
+
+    const livre::NodeId parentNodeId( 0, livre::Vector3f( 0, 0, 0 ), 0 );
+    const livre::NodeIds children = parentNodeId.getChildren();
+    const livre::CacheId firstId = children[ 0 ].getId();
+    const livre::CacheId secondId = children[ 1 ].getId();
+
+    // Every load evicts the unreferenced objects to the compressed cache
+    livre::CompressedDataCache compressedCache( "CompressedDataCache", 1024 * 1024 * 1024 );
+    livre::DataCache dataCache( "DataCache", 1 );
+    dataCache.registerNotifyEvicted(
+        [&compressedCache]( const livre::ConstDataObjectPtr& data )
+        {
+            compressedCache.load( data->getId(), *data );
+        });
+
+    livre::ConstDataObjectPtr data = dataCache.load( firstId, source, &compressedCache );
+    BOOST_REQUIRE( data );
+    const uint8_t* ptr = static_cast< const uint8_t* >( data->getDataPtr( ));
+    const std::vector< uint8_t > original( ptr, ptr + data->getDataSize( ));
+    data.reset();
+
+    BOOST_CHECK( dataCache.load( secondId, source, &compressedCache ));
+    BOOST_CHECK_EQUAL( compressedCache.getCount(), 1 );
+
+    // The memory data source has constant blocks
+    const livre::CacheStatistics& statistics = compressedCache.getStatistics();
+    BOOST_CHECK_GT( statistics.getUsedMemory(), 0 );
+    BOOST_CHECK_LT( statistics.getUsedMemory() * 4, original.size( ));
+
+    // The data is restored from the compressed cache, which only keeps the
+    // data which is not in the data cache
+    data = dataCache.load( firstId, source, &compressedCache );
+    BOOST_REQUIRE( data );
+    BOOST_CHECK_EQUAL( data->getDataSize(), original.size( ));
+    ptr = static_cast< const uint8_t* >( data->getDataPtr( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( ptr, ptr + data->getDataSize(),
+                                   original.begin(), original.end( ));
+    BOOST_CHECK_EQUAL( statistics.getHits(), 1 );
+    BOOST_CHECK_EQUAL( compressedCache.getCount(), 1 ); // The second one is evicted
+}
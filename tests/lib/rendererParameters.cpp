@@ -20,6 +20,7 @@
 #define BOOST_TEST_MODULE RendererParameters
 #include <boost/test/unit_test.hpp>
 
+#include <livre/core/cache/CachePolicy.h>
 #include <livre/core/configuration/RendererParameters.h>
 
 BOOST_AUTO_TEST_CASE(defaultValues)
@@ -31,6 +32,23 @@ BOOST_AUTO_TEST_CASE(defaultValues)
     BOOST_CHECK( !params.getSynchronousMode( ));
     BOOST_CHECK_EQUAL( params.getSamplesPerRay(), 0 );
     BOOST_CHECK_EQUAL( params.getSamplesPerPixel(), 1 );
+    BOOST_CHECK_EQUAL( params.getDataCachePolicy(), livre::CP_LRU );
+    BOOST_CHECK_EQUAL( params.getTextureCachePolicy(), livre::CP_LRU );
+    BOOST_CHECK_EQUAL( params.getHistogramCachePolicy(), livre::CP_LRU );
+    BOOST_CHECK( !params.getAdaptiveCPUCacheMemory( ));
+    BOOST_CHECK_EQUAL( params.getCompressedCPUCacheMemoryMB(), 0u );
+    BOOST_CHECK( params.getDiskCacheDirectoryString().empty( ));
+    BOOST_CHECK_EQUAL( params.getMaxDiskCacheMemoryMB(), 16384u );
+    BOOST_CHECK_EQUAL( params.getPinnedLevels(), 0u );
+    BOOST_CHECK_EQUAL( params.getPinnedCPUCacheMemoryMB(), 256u );
+    BOOST_CHECK_EQUAL( params.getMinDatasetCacheMemoryMB(), 0u );
+    BOOST_CHECK_EQUAL( params.getMaxDatasetCacheMemoryMB(), 0u );
+    BOOST_CHECK_EQUAL( params.getSharedCPUCacheMemoryMB(), 0u );
+    BOOST_CHECK( params.getCacheTraceDirectoryString().empty( ));
+    BOOST_CHECK( params.getPipelineTraceDirectoryString().empty( ));
+    BOOST_CHECK( params.getSlowFrameDirectoryString().empty( ));
+    BOOST_CHECK_EQUAL( params.getSlowFrameLatencyMS(), 100u );
+    BOOST_CHECK_EQUAL( params.getSlowFrameHistory(), 64u );
 
 #ifdef __i386__
     BOOST_CHECK_EQUAL( params.getSSE(), 8.0f );
@@ -63,10 +81,22 @@ BOOST_AUTO_TEST_CASE(initFromArgv)
     const char* app = boost::unit_test::framework::master_test_suite().argv[0];
     const char* argv[] = { app, "--sse", "1.4", "--synchronous",
                            "--gpu-cache-mem", "12345",
-                           "--cpu-cache-mem", "54321",
+                           "--cpu-cache-mem", "54321", "--adaptive-cpu-cache-mem",
+                           "--compressed-cpu-cache-mem", "2048",
+                           "--disk-cache-dir", "/tmp/livre", "--disk-cache-mem", "4096",
+                           "--pinned-levels", "3", "--pinned-gpu-cache-mem", "512",
+                           "--min-dataset-cache-mem", "1024",
+                           "--max-dataset-cache-mem", "6144",
+                           "--shared-cpu-cache-mem", "8192",
+                           "--cache-trace-dir", "/tmp/traces",
+                           "--pipeline-trace-dir", "/tmp/pipeline-traces",
+                           "--slow-frame-dir", "/tmp/slow-frames",
+                           "--slow-frame-latency", "250", "--slow-frame-history", "16",
                            "--min-lod", "2", "--max-lod", "6",
                            "--samples-per-ray", "42",
-                           "--samples-per-pixel", "4" };
+                           "--samples-per-pixel", "4",
+                           "--data-cache-policy", "2q",
+                           "--texture-cache-policy", "visible" };
     const int argc = sizeof(argv)/sizeof(char*);
 
     livre::RendererParameters params;
@@ -80,4 +110,21 @@ BOOST_AUTO_TEST_CASE(initFromArgv)
     BOOST_CHECK_EQUAL( params.getSSE(), 1.4f );
     BOOST_CHECK_EQUAL( params.getMaxGPUCacheMemoryMB(), 12345u );
     BOOST_CHECK_EQUAL( params.getMaxCPUCacheMemoryMB(), 54321u );
+    BOOST_CHECK( params.getAdaptiveCPUCacheMemory( ));
+    BOOST_CHECK_EQUAL( params.getCompressedCPUCacheMemoryMB(), 2048u );
+    BOOST_CHECK_EQUAL( params.getDiskCacheDirectoryString(), "/tmp/livre" );
+    BOOST_CHECK_EQUAL( params.getMaxDiskCacheMemoryMB(), 4096u );
+    BOOST_CHECK_EQUAL( params.getPinnedLevels(), 3u );
+    BOOST_CHECK_EQUAL( params.getPinnedGPUCacheMemoryMB(), 512u );
+    BOOST_CHECK_EQUAL( params.getMinDatasetCacheMemoryMB(), 1024u );
+    BOOST_CHECK_EQUAL( params.getMaxDatasetCacheMemoryMB(), 6144u );
+    BOOST_CHECK_EQUAL( params.getSharedCPUCacheMemoryMB(), 8192u );
+    BOOST_CHECK_EQUAL( params.getCacheTraceDirectoryString(), "/tmp/traces" );
+    BOOST_CHECK_EQUAL( params.getPipelineTraceDirectoryString(), "/tmp/pipeline-traces" );
+    BOOST_CHECK_EQUAL( params.getSlowFrameDirectoryString(), "/tmp/slow-frames" );
+    BOOST_CHECK_EQUAL( params.getSlowFrameLatencyMS(), 250u );
+    BOOST_CHECK_EQUAL( params.getSlowFrameHistory(), 16u );
+    BOOST_CHECK_EQUAL( params.getDataCachePolicy(), livre::CP_2Q );
+    BOOST_CHECK_EQUAL( params.getTextureCachePolicy(), livre::CP_VISIBLE );
+    BOOST_CHECK_EQUAL( params.getHistogramCachePolicy(), livre::CP_LRU );
 }
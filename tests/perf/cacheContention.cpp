@@ -0,0 +1,84 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE CacheContentionPerf
+
+#include <boost/test/unit_test.hpp>
+
+#include "../core/cache/ValidCacheObject.h"
+
+#include <livre/core/cache/Cache.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace
+{
+const size_t nObjects = 512; // Cache capacity in objects
+const size_t nIds = 2 * nObjects; // Half of the requests miss
+const size_t nLoadsPerThread = 50000;
+const size_t nShards = 16;
+
+typedef livre::Cache< test::ValidCacheObject > TestCache;
+
+void loadObjects( TestCache& cache, const size_t seed )
+{
+    std::mt19937 generator( seed );
+    std::uniform_int_distribution< livre::CacheId > distribution( 0, nIds - 1 );
+    for( size_t i = 0; i < nLoadsPerThread; ++i )
+        cache.load( distribution( generator ));
+}
+
+// @return the seconds to load from concurrent threads
+double runLoads( TestCache& cache, const size_t nThreads )
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    boost::thread_group threads;
+    for( size_t i = 0; i < nThreads; ++i )
+        threads.create_thread( boost::bind( &loadObjects, boost::ref( cache ), i ));
+    threads.join_all();
+
+    const std::chrono::duration< double > elapsed =
+            std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+}
+
+BOOST_AUTO_TEST_CASE( perfCacheContention )
+{
+    // Reports the load throughput of a single locked and a sharded cache for
+    // an increasing number of threads. With sharding, the throughput should
+    // scale with the number of threads up to the number of cores.
+    for( size_t nThreads = 1; nThreads <= 8; nThreads *= 2 )
+    {
+        for( const size_t shards: { size_t( 1 ), nShards })
+        {
+            TestCache cache( "Contention Cache", nObjects * test::OBJECT_SIZE, shards );
+            const double seconds = runLoads( cache, nThreads );
+
+            std::cout << "Threads: " << nThreads
+                      << " shards: " << shards
+                      << " loads/s: " << double( nThreads * nLoadsPerThread ) / seconds
+                      << std::endl;
+        }
+    }
+}
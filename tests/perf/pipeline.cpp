@@ -0,0 +1,135 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE PipelinePerf
+
+#include <livre/core/pipeline/Filter.h>
+#include <livre/core/pipeline/FutureMap.h>
+#include <livre/core/pipeline/FuturePromise.h>
+#include <livre/core/pipeline/PipeFilter.h>
+#include <livre/core/pipeline/PromiseMap.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+// Adds its inputs, which it reads with the ids of its ports
+class SumFilter : public livre::Filter
+{
+public:
+    SumFilter()
+        : _valuesPort( livre::getPortId( getInputDataInfos(), "Values" ))
+        , _sumPort( livre::getPortId( getOutputDataInfos(), "Sum" ))
+    {}
+
+    void execute( const livre::FutureMap& input, livre::PromiseMap& output ) const final
+    {
+        uint32_t sum = 0;
+        for( const uint32_t value: input.get< uint32_t >( _valuesPort ))
+            sum += value;
+
+        output.set( _sumPort, sum );
+    }
+
+    livre::DataInfos getInputDataInfos() const final
+    {
+        return {{ "Values", livre::getType< uint32_t >( )}};
+    }
+
+    livre::DataInfos getOutputDataInfos() const final
+    {
+        return {{ "Sum", livre::getType< uint32_t >( )}};
+    }
+
+private:
+    const livre::PortId _valuesPort;
+    const livre::PortId _sumPort;
+};
+
+typedef livre::PipeFilterT< SumFilter > SumPipeFilter;
+}
+
+BOOST_AUTO_TEST_CASE( perfPromiseFutureOverhead )
+{
+    // Reports the cost of a port for a frame: the reset of its promise, the
+    // set value and the futures the consumer and the executor read it with
+    const size_t nPorts = 1000;
+    const size_t nFrames = 100;
+    std::vector< livre::Promise > promises;
+    promises.reserve( nPorts );
+    for( size_t i = 0; i < nPorts; ++i )
+        promises.emplace_back( livre::DataInfo( "TextureCacheObjects",
+                                                livre::getType< uint32_t >( )));
+
+    uint32_t sum = 0;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for( size_t frame = 0; frame < nFrames; ++frame )
+    {
+        livre::Futures futures;
+        for( livre::Promise& promise: promises )
+        {
+            promise.reset();
+            const livre::Future future( promise );
+            futures.emplace_back( future, "CacheObjects" );
+            promise.set( uint32_t( frame ));
+        }
+
+        const livre::FutureMap futureMap( futures );
+        for( const livre::Future& future: futureMap.getFutures( ))
+            sum += future.get< uint32_t >();
+    }
+
+    const std::chrono::duration< double, std::nano > elapsed =
+            std::chrono::high_resolution_clock::now() - start;
+    std::cout << "Promise/future ns/port: " << elapsed.count() / double( nPorts * nFrames )
+              << " ( sum " << sum << " )" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE( perfFilterExecuteOverhead )
+{
+    // Reports the cost of the execution of a filter with a few connected
+    // inputs: the maps of its ports, the reset of its output and the filter
+    const size_t nInputs = 4;
+    const size_t nExecutions = 100000;
+    SumPipeFilter consumer( "Consumer" );
+    std::vector< livre::PipeFilter > producers;
+    for( size_t i = 0; i < nInputs; ++i )
+    {
+        producers.push_back( SumPipeFilter( "Producer" ));
+        producers.back().connect( "Sum", consumer, "Values" );
+        producers.back().getPromise( "Values" ).set( uint32_t( i ));
+        producers.back().execute();
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for( size_t i = 0; i < nExecutions; ++i )
+    {
+        consumer.reset();
+        consumer.execute();
+    }
+
+    const std::chrono::duration< double, std::nano > elapsed =
+            std::chrono::high_resolution_clock::now() - start;
+    const livre::Future sum = consumer.getFuture( consumer.getOutputPortId( "Sum" ));
+    std::cout << "Filter execute ns: " << elapsed.count() / double( nExecutions )
+              << " ( sum " << sum.get< uint32_t >() << " )" << std::endl;
+}
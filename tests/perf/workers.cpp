@@ -0,0 +1,102 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE WorkersPerf
+
+#include <livre/core/pipeline/Executable.h>
+#include <livre/core/pipeline/Workers.h>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+const size_t nTasks = 100000; // i.e. one task per brick of a few frames
+
+// Counts its executions, and schedules its children from the worker thread
+class CountExecutable : public livre::Executable
+{
+public:
+    CountExecutable( std::atomic< size_t >& count,
+                     livre::Workers* workers = nullptr,
+                     const size_t nChildren = 0 )
+        : _count( count )
+        , _workers( workers )
+        , _nChildren( nChildren )
+    {}
+
+    void execute() final
+    {
+        for( size_t i = 0; i < _nChildren; ++i )
+            _workers->schedule( livre::ExecutablePtr( new CountExecutable( _count )));
+        ++_count;
+    }
+
+    livre::Futures getPostconditions() const final { return livre::Futures(); }
+    livre::Futures getPreconditions() const final { return livre::Futures(); }
+
+    livre::ExecutablePtr clone() const final
+    {
+        return livre::ExecutablePtr( new CountExecutable( _count, _workers, _nChildren ));
+    }
+
+private:
+    std::atomic< size_t >& _count;
+    livre::Workers* _workers;
+    const size_t _nChildren;
+};
+
+// @return the nanoseconds per task to schedule and execute empty tasks
+double measureOverhead( const size_t nThreads, const size_t nRoots )
+{
+    std::atomic< size_t > count( 0 );
+    livre::Workers workers( nThreads, "Benchmark" );
+
+    // The roots are scheduled from outside of the pool, their children from
+    // the worker threads
+    const size_t nChildren = nTasks / nRoots - 1;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for( size_t i = 0; i < nRoots; ++i )
+        workers.schedule( livre::ExecutablePtr( new CountExecutable( count, &workers,
+                                                                     nChildren )));
+    while( count < nRoots * ( nChildren + 1 ))
+        boost::this_thread::yield();
+
+    const std::chrono::duration< double, std::nano > elapsed =
+            std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / double( nRoots * ( nChildren + 1 ));
+}
+}
+
+BOOST_AUTO_TEST_CASE( perfSchedulingOverhead )
+{
+    // Reports the scheduling overhead of small tasks, scheduled from outside
+    // of the pool, and from the worker threads
+    for( size_t nThreads = 1; nThreads <= 8; nThreads *= 2 )
+    {
+        std::cout << "Threads: " << nThreads
+                  << " external ns/task: " << measureOverhead( nThreads, nTasks )
+                  << " from workers ns/task: " << measureOverhead( nThreads, nThreads )
+                  << std::endl;
+    }
+}
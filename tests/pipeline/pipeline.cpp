@@ -30,6 +30,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <thread>
+
 namespace ut = boost::unit_test;
 
 const uint32_t defaultMeaningOfLife = 42;
@@ -108,6 +111,59 @@ class ConvertFilter : public livre::Filter
     }
 };
 
+// Adds its inputs, which it reads with the ids of its ports
+class SumFilter : public livre::Filter
+{
+public:
+    SumFilter()
+        : _offsetPort( livre::getPortId( getInputDataInfos(), "Offset" ))
+        , _valuesPort( livre::getPortId( getInputDataInfos(), "Values" ))
+        , _sumPort( livre::getPortId( getOutputDataInfos(), "Sum" ))
+    {}
+
+    void execute( const livre::FutureMap& input, livre::PromiseMap& output ) const final
+    {
+        uint32_t sum = input.getFuture( _offsetPort ).get< uint32_t >();
+        for( const uint32_t value: input.get< uint32_t >( _valuesPort ))
+            sum += value;
+
+        output.set( _sumPort, sum );
+    }
+
+    livre::DataInfos getInputDataInfos() const final
+    {
+        return {{ "Values", livre::getType< uint32_t >( )},
+                { "Offset", livre::getType< uint32_t >( )}};
+    }
+
+    livre::DataInfos getOutputDataInfos() const final
+    {
+        return {{ "Sum", livre::getType< uint32_t >( )}};
+    }
+
+private:
+    const livre::PortId _offsetPort;
+    const livre::PortId _valuesPort;
+    const livre::PortId _sumPort;
+};
+
+// Counts its copies, a payload which is moved in or shared
+struct LargeData
+{
+    LargeData() {}
+    LargeData( const LargeData& ) { ++nCopies; }
+    LargeData( LargeData&& ) {}
+
+    static size_t nCopies;
+};
+
+size_t LargeData::nCopies = 0;
+
+namespace livre
+{
+template<> struct IsCheapToCopy< LargeData > : std::false_type {};
+}
+
 bool check_error( const std::runtime_error& ) { return true; }
 
 BOOST_AUTO_TEST_CASE( testFilterNoInput )
@@ -180,6 +236,33 @@ BOOST_AUTO_TEST_CASE( testConnection )
     BOOST_CHECK_EQUAL( outputData.thanksForAllTheFish, 222 );
 }
 
+BOOST_AUTO_TEST_CASE( testPortIds )
+{
+    livre::PipeFilterT< SumFilter > producer( "Producer" );
+    livre::PipeFilterT< SumFilter > consumer( "Consumer" );
+
+    // The ids are the indices of the ports sorted by name
+    BOOST_CHECK_EQUAL( consumer.getInputPortId( "Offset" ), 0 );
+    BOOST_CHECK_EQUAL( consumer.getInputPortId( "Values" ), 1 );
+    BOOST_CHECK_EQUAL( consumer.getOutputPortId( "Sum" ), 0 );
+    BOOST_CHECK_THROW( consumer.getInputPortId( "Sum" ), std::runtime_error );
+    BOOST_CHECK_THROW( consumer.getPromise( 2 ), std::runtime_error );
+    BOOST_CHECK_THROW( producer.connect( 1, consumer, 1 ), std::runtime_error );
+    BOOST_CHECK_THROW( livre::getPortId( SumFilter().getInputDataInfos(), "Sum" ),
+                       std::runtime_error );
+
+    producer.connect( 0, consumer, consumer.getInputPortId( "Values" ));
+    producer.getPromise( "Offset" ).set( 1u );
+    producer.getPromise( 1 ).set( 2u );
+    consumer.getPromise( 0 ).set( 4u );
+    consumer.getPromise( "Values" ).set( 3u );
+    producer.execute();
+    consumer.execute();
+
+    const livre::UniqueFutureMap portFutures( consumer.getPostconditions( ));
+    BOOST_CHECK_EQUAL( portFutures.get< uint32_t >( "Sum" ), 10 );
+}
+
 livre::Pipeline createPipeline( const uint32_t inputValue,
                                 size_t nConvertFilter = 1 )
 {
@@ -291,6 +374,84 @@ BOOST_AUTO_TEST_CASE( testOneToManyManyToOnePipeline )
     }
 }
 
+BOOST_AUTO_TEST_CASE( testPipelineOrder )
+{
+    // The consumer is added before its producers
+    livre::Pipeline pipeline;
+    livre::PipeFilter pipeOutput = pipeline.add< TestFilter >( "Consumer" );
+    livre::PipeFilter convertPipeFilter = pipeline.add< ConvertFilter >( "Converter" );
+    livre::PipeFilter pipeInput = pipeline.add< TestFilter >( "Producer" );
+    pipeInput.connect( "TestOutputData", convertPipeFilter, "ConvertInputData" );
+    convertPipeFilter.connect( "ConvertOutputData", pipeOutput, "TestInputData" );
+
+    // The compiled pipeline is executed again with new inputs after a reset
+    for( const uint32_t inputValue: { 90u, 100u })
+    {
+        pipeline.reset();
+        pipeInput.getPromise( "TestInputData" ).set( InputData( inputValue ));
+        pipeline.execute();
+
+        BOOST_CHECK( livre::FutureMap( pipeline.getPostconditions( )).isReady( ));
+        const livre::UniqueFutureMap portFutures( pipeOutput.getPostconditions( ));
+        const OutputData& outputData = portFutures.get< OutputData >( "TestOutputData" );
+        BOOST_CHECK_EQUAL( outputData.thanksForAllTheFish, inputValue + 132 );
+    }
+}
+
+namespace
+{
+std::atomic< bool > releaseExecution( false );
+
+// Sets its output and returns once released, so it is reset while it executes
+class BlockingFilter : public livre::Filter
+{
+    void execute( const livre::FutureMap&, livre::PromiseMap& output ) const final
+    {
+        output.set( "Value", defaultMeaningOfLife );
+        while( !releaseExecution )
+            std::this_thread::yield();
+    }
+
+    livre::DataInfos getInputDataInfos() const final { return livre::DataInfos(); }
+
+    livre::DataInfos getOutputDataInfos() const final
+    {
+        return {{ "Value", livre::getType< uint32_t >( )}};
+    }
+};
+}
+
+BOOST_AUTO_TEST_CASE( testResetWhileExecuting )
+{
+    livre::PipeFilterT< BlockingFilter > filter( "Blocking" );
+    const livre::PortId valuePort = filter.getOutputPortId( "Value" );
+    const livre::Future future = filter.getFuture( valuePort );
+    {
+        livre::Workers workers( 1 );
+        workers.schedule( std::make_shared< livre::PipeFilterT< BlockingFilter >>( filter ));
+        future.wait();
+
+        // The execution completes the frame it started with, not the next one
+        filter.reset();
+        releaseExecution = true;
+    }
+    BOOST_CHECK_EQUAL( future.get< uint32_t >(), defaultMeaningOfLife );
+    BOOST_CHECK( !filter.getFuture( valuePort ).isReady( ));
+    BOOST_CHECK_THROW( filter.getFuture( 1 ), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( testPipelineCycle )
+{
+    livre::Pipeline pipeline;
+    livre::PipeFilter convertPipeFilter = pipeline.add< ConvertFilter >( "Converter" );
+    livre::PipeFilter testPipeFilter = pipeline.add< TestFilter >( "Test" );
+    convertPipeFilter.connect( "ConvertOutputData", testPipeFilter, "TestInputData" );
+    testPipeFilter.connect( "TestOutputData", convertPipeFilter, "ConvertInputData" );
+
+    BOOST_CHECK_THROW( pipeline.execute(), std::runtime_error );
+    BOOST_CHECK_THROW( pipeline.getExecutable( "Missing" ), std::runtime_error );
+}
+
 BOOST_AUTO_TEST_CASE( testPromiseFuture )
 {
     livre::Promise promise( livre::DataInfo( "Helloworld", livre::getType< uint32_t >( )));
@@ -318,6 +479,97 @@ BOOST_AUTO_TEST_CASE( testPromiseFuture )
     BOOST_CHECK_EQUAL( future3.get< uint32_t >(), 43u );
 }
 
+BOOST_AUTO_TEST_CASE( testPortDataWithoutCopy )
+{
+    livre::Promise promise1( livre::DataInfo( "Large", livre::getType< LargeData >( )));
+    livre::Promise promise2( livre::DataInfo( "Large", livre::getType< LargeData >( )));
+
+    // Moved in
+    promise1.set( LargeData( ));
+    BOOST_CHECK_EQUAL( LargeData::nCopies, 0 );
+
+    // Shared by the promises
+    promise1.reset();
+    const livre::PortDataPtr data = livre::makePortData( LargeData( ));
+    promise1.setData( data );
+    promise2.setData( data );
+    BOOST_CHECK_EQUAL( &promise1.getFuture().get< LargeData >(),
+                       &promise2.getFuture().get< LargeData >( ));
+    BOOST_CHECK_EQUAL( promise2.getFuture().getData(), data );
+    BOOST_CHECK_EQUAL( LargeData::nCopies, 0 );
+
+    livre::Promise promise3( livre::DataInfo( "Helloworld", livre::getType< uint32_t >( )));
+    BOOST_CHECK_THROW( promise3.setData( data ), std::runtime_error );
+
+    // Containers are moved in, setting a copy does not compile
+    typedef std::vector< uint32_t > Ids;
+    BOOST_CHECK( !livre::IsCheapToCopy< Ids >::value );
+    BOOST_CHECK( livre::IsCheapToCopy< uint32_t >::value );
+    livre::Promise idsPromise( livre::DataInfo( "Ids", livre::getType< Ids >( )));
+    Ids ids( 1000 );
+    const uint32_t* idsData = ids.data();
+    idsPromise.set( std::move( ids ));
+    BOOST_CHECK_EQUAL( idsPromise.getFuture().get< Ids >().data(), idsData );
+}
+
+BOOST_AUTO_TEST_CASE( testFutureOnReady )
+{
+    livre::Promise promise( livre::DataInfo( "Helloworld", livre::getType< uint32_t >( )));
+    const livre::Future future = promise.getFuture();
+
+    // Called when the promise is set, or right away once it is set
+    size_t nCalls = 0;
+    future.onReady( [&nCalls] { ++nCalls; });
+    BOOST_CHECK_EQUAL( nCalls, 0 );
+    promise.set( 42u );
+    BOOST_CHECK_EQUAL( nCalls, 1 );
+    future.onReady( [&nCalls] { ++nCalls; });
+    BOOST_CHECK_EQUAL( nCalls, 2 );
+
+    // A reset makes the waiting futures ready, the next ones wait again
+    promise.reset();
+    const livre::Future resetFuture = promise.getFuture();
+    resetFuture.onReady( [&nCalls] { ++nCalls; });
+    BOOST_CHECK_EQUAL( nCalls, 2 );
+    promise.reset();
+    BOOST_CHECK_EQUAL( nCalls, 3 );
+    BOOST_CHECK( resetFuture.isReady( ));
+}
+
+BOOST_AUTO_TEST_CASE( testSetWhenReady )
+{
+    livre::Promise promise1( livre::DataInfo( "Value1", livre::getType< uint32_t >( )));
+    livre::Promise promise2( livre::DataInfo( "Value2", livre::getType< uint32_t >( )));
+    const livre::Futures futures = { promise1.getFuture(), promise2.getFuture() };
+    promise1.set( defaultMeaningOfLife );
+
+    // The sum is set once both values are, the flush does not set it empty
+    livre::Promise sum( livre::DataInfo( "Sum", livre::getType< uint32_t >( )));
+    const livre::PromiseMap promises( livre::Promises{ sum });
+    promises.setWhenReady( 0, futures, [futures]
+    {
+        return livre::makePortData( futures.front().get< uint32_t >() +
+                                    futures.back().get< uint32_t >( ));
+    });
+    promises.flush();
+    BOOST_CHECK( !sum.getFuture().isReady( ));
+
+    promise2.set( addMoreFish );
+    BOOST_CHECK_EQUAL( sum.getFuture().get< uint32_t >(), defaultMeaningOfLife + addMoreFish );
+    BOOST_CHECK_THROW( promises.setWhenReady( 1, futures, []{ return livre::PortDataPtr(); }),
+                       std::logic_error );
+
+    // The port is flushed when its data cannot be set
+    livre::Promise failed( livre::DataInfo( "Failed", livre::getType< uint32_t >( )));
+    const livre::PromiseMap failedPromises( livre::Promises{ failed });
+    failedPromises.setWhenReady( 0, futures, []
+    {
+        return livre::makePortData( 42.0f );
+    });
+    BOOST_CHECK( failed.getFuture().isReady( ));
+    BOOST_CHECK_THROW( failed.getFuture().get< uint32_t >(), std::runtime_error );
+}
+
 BOOST_AUTO_TEST_CASE( testFutureMaps )
 {
     livre::PipeFilterT< TestFilter > pipeFilter( "Producer" );
@@ -333,3 +585,61 @@ BOOST_AUTO_TEST_CASE( testFutureMaps )
                        std::logic_error );
     const livre::FutureMap portFutures2( nonUniqueFutures );
 }
+
+BOOST_AUTO_TEST_CASE( testPromiseFutureFrames )
+{
+    // The promises are reset every frame, the futures read the value of
+    // their frame. The cost per port is reported by perf/pipeline.cpp.
+    const size_t nPorts = 10;
+    const size_t nFrames = 10;
+    std::vector< livre::Promise > promises;
+    promises.reserve( nPorts );
+    for( size_t i = 0; i < nPorts; ++i )
+        promises.emplace_back( livre::DataInfo( "TextureCacheObjects",
+                                                livre::getType< uint32_t >( )));
+
+    uint32_t sum = 0;
+    for( size_t frame = 0; frame < nFrames; ++frame )
+    {
+        livre::Futures futures;
+        for( livre::Promise& promise: promises )
+        {
+            promise.reset();
+            const livre::Future future( promise );
+            futures.emplace_back( future, "CacheObjects" );
+            promise.set( uint32_t( frame ));
+        }
+
+        const livre::FutureMap futureMap( futures );
+        for( const livre::Future& future: futureMap.getFutures( ))
+            sum += future.get< uint32_t >();
+    }
+
+    BOOST_CHECK_EQUAL( sum, nPorts * nFrames * ( nFrames - 1 ) / 2 );
+}
+
+BOOST_AUTO_TEST_CASE( testFilterReexecute )
+{
+    // A filter with a few connected inputs is reset and executed again
+    const size_t nInputs = 4;
+    const size_t nExecutions = 10;
+    livre::PipeFilterT< TestFilter > consumer( "Consumer" );
+    std::vector< livre::PipeFilter > producers;
+    for( size_t i = 0; i < nInputs; ++i )
+    {
+        producers.push_back( livre::PipeFilterT< ConvertFilter >( "Converter" ));
+        producers.back().connect( "ConvertOutputData", consumer, "TestInputData" );
+        producers.back().getPromise( "ConvertInputData" ).set( OutputData( 0 ));
+        producers.back().execute();
+    }
+
+    for( size_t i = 0; i < nExecutions; ++i )
+    {
+        consumer.reset();
+        consumer.execute();
+    }
+
+    const livre::UniqueFutureMap portFutures( consumer.getPostconditions( ));
+    BOOST_CHECK_EQUAL( portFutures.get< OutputData >( "TestOutputData" ).thanksForAllTheFish,
+                       defaultThanksForAllTheFish + nInputs * 2 * addMoreFish );
+}
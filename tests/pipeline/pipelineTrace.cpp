@@ -0,0 +1,158 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE PipelineTrace
+
+#include <livre/core/pipeline/PipeFilter.h>
+#include <livre/core/pipeline/PipelineTrace.h>
+#include <livre/core/pipeline/Filter.h>
+#include <livre/core/pipeline/FutureMap.h>
+#include <livre/core/pipeline/PromiseMap.h>
+#include <livre/core/pipeline/Workers.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+// Removes the trace file when the test ends
+struct TraceFile
+{
+    TraceFile()
+        : filename( ( boost::filesystem::temp_directory_path() /
+                      boost::filesystem::unique_path( "%%%%-%%%%.json" )).string( ))
+    {}
+
+    ~TraceFile()
+    {
+        boost::filesystem::remove( filename );
+    }
+
+    const std::string filename;
+};
+
+// Works for a millisecond
+class SleepFilter : public livre::Filter
+{
+    void execute( const livre::FutureMap&, livre::PromiseMap& output ) const final
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ));
+        output.set( "Done", true );
+    }
+
+    livre::DataInfos getInputDataInfos() const final { return livre::DataInfos(); }
+
+    livre::DataInfos getOutputDataInfos() const final
+    {
+        return {{ "Done", livre::getType< bool >( )}};
+    }
+};
+
+typedef livre::PipeFilterT< SleepFilter > SleepPipeFilter;
+
+// Executes the filters of a frame in workers, which are done once destroyed
+void executeFrame( const uint32_t frame, const size_t nFilters )
+{
+    livre::Workers workers( 2, "Test Workers" );
+    for( size_t i = 0; i < nFilters; ++i )
+    {
+        std::shared_ptr< SleepPipeFilter > filter =
+                std::make_shared< SleepPipeFilter >( "Sleep" + std::to_string( i ));
+        filter->setFrame( frame );
+        workers.schedule( filter );
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE( testPipelineTrace )
+{
+    const TraceFile traceFile;
+
+    // Nothing is recorded without a trace
+    BOOST_CHECK( !livre::PipelineTrace::isEnabled( ));
+    executeFrame( 1, 4 );
+    {
+        livre::PipelineTrace trace( traceFile.filename );
+        BOOST_CHECK( livre::PipelineTrace::isEnabled( ));
+        BOOST_CHECK_THROW( livre::PipelineTrace( traceFile.filename + ".other" ),
+                           std::runtime_error );
+
+        executeFrame( 2, 4 );
+        {
+            const livre::ScopedTrace scopedTrace( "frameDraw", 2 );
+        }
+
+        const livre::TraceEvents events = trace.getEvents();
+        BOOST_REQUIRE_EQUAL( events.size(), 5 );
+        size_t nFilters = 0;
+        for( size_t i = 0; i < events.size(); ++i )
+        {
+            const livre::TraceEvent& event = events[ i ];
+            BOOST_CHECK_EQUAL( event.frame, 2 );
+            BOOST_CHECK_LE( event.startTime, event.endTime );
+            if( i > 0 )
+                BOOST_CHECK_LE( events[ i - 1 ].startTime, event.startTime );
+
+            if( std::string( event.name ) == "frameDraw" )
+            {
+                BOOST_CHECK_EQUAL( event.scheduleTime, 0 );
+                continue;
+            }
+
+            // The filters were queued in the workers before they ran
+            ++nFilters;
+            BOOST_CHECK_EQUAL( std::string( event.name ).substr( 0, 5 ), "Sleep" );
+            BOOST_CHECK_GT( event.scheduleTime, 0 );
+            BOOST_CHECK_LE( event.scheduleTime, event.startTime );
+            BOOST_CHECK_GE( event.endTime - event.startTime, 1000 );
+        }
+        BOOST_CHECK_EQUAL( nFilters, 4 );
+    }
+    BOOST_CHECK( !livre::PipelineTrace::isEnabled( ));
+
+    std::ifstream file( traceFile.filename.c_str( ));
+    std::stringstream json;
+    json << file.rdbuf();
+    BOOST_CHECK_EQUAL( json.str().find( "{\"traceEvents\":[" ), 0 );
+    BOOST_CHECK( json.str().find( "\"name\":\"Sleep3\",\"cat\":\"filter\"" ) != std::string::npos );
+    BOOST_CHECK( json.str().find( "\"thread_name\"" ) != std::string::npos );
+    BOOST_CHECK( json.str().find( "\"frame\":2" ) != std::string::npos );
+    BOOST_CHECK( json.str().find( "\"frame\":1," ) == std::string::npos );
+
+    BOOST_CHECK_THROW( livre::PipelineTrace( "/nonexistent/pipeline.json" ),
+                       std::runtime_error );
+    BOOST_CHECK( !livre::PipelineTrace::isEnabled( ));
+}
+
+BOOST_AUTO_TEST_CASE( testWriteTraceEvents )
+{
+    livre::TraceEvent event = { "Quote\"d", 3, 0, 10, 15, 25 };
+    std::stringstream json;
+    livre::PipelineTrace::write( { event }, json );
+
+    BOOST_CHECK( json.str().find( "\"name\":\"Quote\\\"d\"" ) != std::string::npos );
+    BOOST_CHECK( json.str().find( "\"ts\":15,\"dur\":10,\"args\":{\"frame\":3,\"queueWait\":5}" )
+                 != std::string::npos );
+    BOOST_CHECK( json.str().find( "\"cat\":\"queue\",\"ph\":\"b\"" ) != std::string::npos );
+}
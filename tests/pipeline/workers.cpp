@@ -0,0 +1,337 @@
+/* Copyright (c) 2011-2016, EPFL/Blue Brain Project
+ *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE Workers
+
+#include <livre/core/pipeline/Executable.h>
+#include <livre/core/pipeline/FuturePromise.h>
+#include <livre/core/pipeline/Workers.h>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <atomic>
+
+namespace
+{
+const size_t nTasks = 1000;
+
+// Counts its executions, and schedules its children from the worker thread
+class CountExecutable : public livre::Executable
+{
+public:
+    CountExecutable( std::atomic< size_t >& count,
+                     livre::Workers* workers = nullptr,
+                     const size_t nChildren = 0 )
+        : _count( count )
+        , _workers( workers )
+        , _nChildren( nChildren )
+    {}
+
+    void execute() final
+    {
+        for( size_t i = 0; i < _nChildren; ++i )
+            _workers->schedule( livre::ExecutablePtr( new CountExecutable( _count )));
+        ++_count;
+    }
+
+    livre::Futures getPostconditions() const final { return livre::Futures(); }
+    livre::Futures getPreconditions() const final { return livre::Futures(); }
+
+    livre::ExecutablePtr clone() const final
+    {
+        return livre::ExecutablePtr( new CountExecutable( _count, _workers, _nChildren ));
+    }
+
+private:
+    std::atomic< size_t >& _count;
+    livre::Workers* _workers;
+    const size_t _nChildren;
+};
+
+// Blocks its worker thread until it is opened
+class GateExecutable : public livre::Executable
+{
+public:
+    GateExecutable( std::atomic< bool >& started, const std::atomic< bool >& open )
+        : _started( started )
+        , _open( open )
+    {}
+
+    void execute() final
+    {
+        _started = true;
+        while( !_open )
+            boost::this_thread::yield();
+    }
+
+    livre::Futures getPostconditions() const final { return livre::Futures(); }
+    livre::Futures getPreconditions() const final { return livre::Futures(); }
+
+    livre::ExecutablePtr clone() const final
+    {
+        return livre::ExecutablePtr( new GateExecutable( _started, _open ));
+    }
+
+private:
+    std::atomic< bool >& _started;
+    const std::atomic< bool >& _open;
+};
+
+// Records its index when executed
+class OrderExecutable : public livre::Executable
+{
+public:
+    OrderExecutable( const size_t index,
+                     const livre::ExecutablePriority priority,
+                     const uint32_t frame,
+                     std::vector< size_t >& order )
+        : _index( index )
+        , _priority( priority )
+        , _frame( frame )
+        , _order( order )
+    {}
+
+    void execute() final { _order.push_back( _index ); }
+
+    livre::ExecutablePriority getPriority() const final { return _priority; }
+    uint32_t getFrame() const final { return _frame; }
+
+    livre::Futures getPostconditions() const final { return livre::Futures(); }
+    livre::Futures getPreconditions() const final { return livre::Futures(); }
+
+    livre::ExecutablePtr clone() const final
+    {
+        return livre::ExecutablePtr( new OrderExecutable( _index, _priority, _frame, _order ));
+    }
+
+private:
+    const size_t _index;
+    const livre::ExecutablePriority _priority;
+    const uint32_t _frame;
+    std::vector< size_t >& _order;
+};
+
+// Records its index when executed, once the frame it waits for is waited
+// for, and sets its promise
+class FrameExecutable : public livre::Executable
+{
+public:
+    FrameExecutable( const size_t index,
+                     const livre::ExecutablePriority priority,
+                     const uint32_t frame,
+                     std::vector< size_t >& order,
+                     livre::Promise* done = nullptr,
+                     const std::atomic< bool >* waited = nullptr )
+        : _index( index )
+        , _priority( priority )
+        , _frame( frame )
+        , _order( order )
+        , _done( done )
+        , _waited( waited )
+    {}
+
+    void execute() final
+    {
+        while( _waited && !*_waited )
+            boost::this_thread::yield();
+        _order.push_back( _index );
+        if( _done )
+            _done->set( true );
+    }
+
+    livre::ExecutablePriority getPriority() const final { return _priority; }
+    uint32_t getFrame() const final { return _frame; }
+
+    livre::Futures getPostconditions() const final { return livre::Futures(); }
+    livre::Futures getPreconditions() const final { return livre::Futures(); }
+
+    livre::ExecutablePtr clone() const final
+    {
+        return livre::ExecutablePtr( new FrameExecutable( _index, _priority, _frame, _order,
+                                                          _done, _waited ));
+    }
+
+private:
+    const size_t _index;
+    const livre::ExecutablePriority _priority;
+    const uint32_t _frame;
+    std::vector< size_t >& _order;
+    livre::Promise* _done;
+    const std::atomic< bool >* _waited;
+};
+
+typedef std::vector< std::pair< livre::ExecutablePriority, uint32_t >> PrioritiesAndFrames;
+
+// @return the execution order of executables of the given priorities and
+// frames, all scheduled while the single worker thread is busy
+std::vector< size_t > getOrder( const PrioritiesAndFrames& executables )
+{
+    std::vector< size_t > order;
+    std::atomic< bool > started( false );
+    std::atomic< bool > open( false );
+    {
+        livre::Workers workers( 1, "Test Workers" );
+        workers.schedule( livre::ExecutablePtr( new GateExecutable( started, open )));
+        while( !started )
+            boost::this_thread::yield();
+
+        for( size_t i = 0; i < executables.size(); ++i )
+            workers.schedule( livre::ExecutablePtr(
+                new OrderExecutable( i, executables[ i ].first, executables[ i ].second,
+                                     order )));
+        open = true;
+    }
+    return order;
+}
+
+void waitFor( const std::atomic< size_t >& count, const size_t expected )
+{
+    while( count < expected )
+        boost::this_thread::yield();
+}
+
+// @return the number of executed tasks, once the workers are destroyed
+size_t runTasks( const size_t nThreads, const size_t nRoots )
+{
+    std::atomic< size_t > count( 0 );
+    {
+        livre::Workers workers( nThreads, "Test Workers" );
+
+        // The roots are scheduled from outside of the pool, their children
+        // from the worker threads
+        const size_t nChildren = nTasks / nRoots - 1;
+        for( size_t i = 0; i < nRoots; ++i )
+            workers.schedule( livre::ExecutablePtr( new CountExecutable( count, &workers,
+                                                                         nChildren )));
+        waitFor( count, nTasks );
+    }
+    return count;
+}
+}
+
+BOOST_AUTO_TEST_CASE( testWorkers )
+{
+    std::atomic< size_t > count( 0 );
+    {
+        livre::Workers workers( 4, "Test Workers" );
+        BOOST_CHECK_EQUAL( workers.getSize(), 4 );
+        for( size_t i = 0; i < 1000; ++i )
+            workers.schedule( livre::ExecutablePtr( new CountExecutable( count )));
+    }
+    // The scheduled work is done before the pool is destroyed
+    BOOST_CHECK_EQUAL( count, 1000 );
+}
+
+BOOST_AUTO_TEST_CASE( testWorkersStealing )
+{
+    // The work scheduled by one worker is shared by the others
+    std::atomic< size_t > count( 0 );
+    {
+        livre::Workers workers( 4, "Test Workers" );
+        workers.schedule( livre::ExecutablePtr( new CountExecutable( count, &workers, 999 )));
+        waitFor( count, 1000 );
+    }
+    BOOST_CHECK_EQUAL( count, 1000 );
+}
+
+BOOST_AUTO_TEST_CASE( testScheduling )
+{
+    // The tasks scheduled from outside of the pool and from the worker
+    // threads are all executed once
+    for( const size_t nThreads: { size_t( 1 ), size_t( 4 )})
+    {
+        BOOST_CHECK_EQUAL( runTasks( nThreads, nTasks ), nTasks );
+        BOOST_CHECK_EQUAL( runTasks( nThreads, nThreads ), nTasks );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( testWorkersPriorities )
+{
+    // The highest priority first, the newest work of a priority first
+    const std::vector< size_t > order = getOrder( { { livre::PRIORITY_BACKGROUND, 0 },
+                                                    { livre::PRIORITY_NORMAL, 0 },
+                                                    { livre::PRIORITY_RENDER, 0 },
+                                                    { livre::PRIORITY_NORMAL, 0 },
+                                                    { livre::PRIORITY_RENDER, 0 }});
+    const std::vector< size_t > expected = { 4, 2, 3, 1, 0 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( order.begin(), order.end(),
+                                   expected.begin(), expected.end( ));
+}
+
+BOOST_AUTO_TEST_CASE( testWorkersWaitedFrames )
+{
+    // The work of the frames older than the newest scheduled one runs first,
+    // whatever its priority
+    const std::vector< size_t > order = getOrder( { { livre::PRIORITY_RENDER, 1 },
+                                                    { livre::PRIORITY_RENDER, 2 },
+                                                    { livre::PRIORITY_BACKGROUND, 2 },
+                                                    { livre::PRIORITY_RENDER, 1 },
+                                                    { livre::PRIORITY_NORMAL, 0 }});
+    const std::vector< size_t > expected = { 3, 0, 1, 4, 2 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( order.begin(), order.end(),
+                                   expected.begin(), expected.end( ));
+}
+
+BOOST_AUTO_TEST_CASE( testWorkersFrameWaits )
+{
+    // The oldest frame is waited for while the newer ones are queued, as the
+    // pipelines do before they reuse it. Its background work runs before the
+    // render work of the newer frames, which blocks until the wait is over.
+    std::vector< size_t > order;
+    std::atomic< bool > started( false );
+    std::atomic< bool > open( false );
+    std::atomic< bool > waited( false );
+    livre::Promise renderDone( livre::DataInfo( "RenderDone", std::type_index( typeid( bool ))));
+    livre::Promise histogramDone( livre::DataInfo( "HistogramDone",
+                                                   std::type_index( typeid( bool ))));
+    bool frameDone = false;
+    {
+        livre::Workers workers( 1, "Test Workers" );
+        workers.schedule( livre::ExecutablePtr( new GateExecutable( started, open )));
+        while( !started )
+            boost::this_thread::yield();
+
+        workers.schedule( livre::ExecutablePtr(
+            new FrameExecutable( 0, livre::PRIORITY_RENDER, 1, order, &renderDone )));
+        workers.schedule( livre::ExecutablePtr(
+            new FrameExecutable( 1, livre::PRIORITY_BACKGROUND, 1, order, &histogramDone )));
+        workers.schedule( livre::ExecutablePtr(
+            new FrameExecutable( 2, livre::PRIORITY_RENDER, 2, order )));
+        workers.schedule( livre::ExecutablePtr(
+            new FrameExecutable( 3, livre::PRIORITY_RENDER, 3, order, nullptr, &waited )));
+        open = true;
+
+        // Waits for frame 1 with a timeout, so a wrong order fails instead
+        // of blocking the test
+        const livre::Future rendered = renderDone.getFuture();
+        const livre::Future histogram = histogramDone.getFuture();
+        for( size_t i = 0; i < 10000 && !frameDone; ++i )
+        {
+            frameDone = rendered.isReady() && histogram.isReady();
+            boost::this_thread::sleep( boost::posix_time::milliseconds( 1 ));
+        }
+        waited = true;
+    }
+    BOOST_CHECK( frameDone );
+
+    const std::vector< size_t > expected = { 0, 1, 2, 3 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( order.begin(), order.end(),
+                                   expected.begin(), expected.end( ));
+}